@@ -0,0 +1,100 @@
+/*
+
+	time one operation applied across many sets for
+	1. a loop over std::vector<TinyBitSet> calling the per-set method, 2. TinyBitSetArray's bulk version
+	a. intersection of every set with one filter mask, in place
+	b. element-wise union of two arrays, in place
+	c. set sizes, into an existing buffer
+	d. for every element, the number of sets containing it (getIntegerElements() per set vs elementCounts())
+	e. (a | b) - (c & mask) over whole arrays: bulk calls with a temporary array each, against the fused expression
+
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "../tinybitarray.h"
+
+const int MAX_ELEMS = 64;
+
+
+template <typename Fn>
+double timeIt(Fn fn) {
+	auto start = std::chrono::high_resolution_clock::now();
+	fn();
+	auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count();
+}
+
+
+int main() {
+
+	size_t N = 10000000;
+	TinyBitSetArray<MAX_ELEMS> a(N);
+	TinyBitSetArray<MAX_ELEMS> b(N);
+	for (size_t i = 0; i < N; i++) {
+		a[i] = TinyBitSet<MAX_ELEMS>((uint64_t(rand()) << 32) | uint64_t(rand()));
+		b[i] = TinyBitSet<MAX_ELEMS>((uint64_t(rand()) << 32) | uint64_t(rand()));
+	}
+	TinyBitSet<MAX_ELEMS> mask(0x00ff00ff00ff00ffull);
+	std::vector<TinyBitSet<MAX_ELEMS>> va(a.begin(), a.end());
+	std::vector<TinyBitSet<MAX_ELEMS>> vb(b.begin(), b.end());
+	std::vector<int> vsizes(N);
+
+	std::cout << "N = " << N << ", MAX_ELEMS = " << MAX_ELEMS << std::endl;
+
+	double loopMask = timeIt([&]() { for (size_t i = 0; i < N; i++) { va[i] = va[i].intersectionb(mask); } });
+	double loopUnion = timeIt([&]() { for (size_t i = 0; i < N; i++) { va[i] = va[i].unionb(vb[i]); } });
+	double loopSizes = timeIt([&]() { for (size_t i = 0; i < N; i++) { vsizes[i] = va[i].getSetSize(); } });
+	std::cout << "per-set loop: mask " << loopMask << ", union " << loopUnion << ", sizes " << loopSizes << std::endl;
+
+	std::vector<int> sizes(N);
+	double bulkMask = timeIt([&]() { a.intersectWith(mask); });
+	double bulkUnion = timeIt([&]() { a.unionWith(b); });
+	double bulkSizes = timeIt([&]() { a.getSetSizes(sizes.data()); });
+	std::cout << "TinyBitSetArray: mask " << bulkMask << ", union " << bulkUnion << ", sizes " << bulkSizes
+			  << " (same results: " << ((a[N-1] == va[N-1]) && (sizes == vsizes)) << ")" << std::endl;
+
+	std::vector<uint64_t> loopCounts(MAX_ELEMS + 1, 0);
+	double loopElems = timeIt([&]() {
+		for (size_t i = 0; i < N; i++) {
+			for (int k : va[i].getIntegerElements()) {
+				loopCounts[k]++;
+			}
+		}
+	});
+	std::vector<uint64_t> counts;
+	double bulkCounts = timeIt([&]() { counts = a.elementCounts(); });
+	double threadCounts = timeIt([&]() { counts = a.elementCounts(8); });
+	std::cout << "element counts: getIntegerElements loop " << loopElems << ", elementCounts " << bulkCounts
+			  << ", 8 threads " << threadCounts << " (same results: " << (counts == loopCounts) << ")" << std::endl;
+
+	TinyBitSetArray<MAX_ELEMS> c = b.intersectionb(TinyBitSet<MAX_ELEMS>(0x5555555555555555ull));
+	TinyBitSetArray<MAX_ELEMS> stepwise;
+	TinyBitSetArray<MAX_ELEMS> fused;
+	double stepTime = timeIt([&]() { stepwise = a.unionb(b).leftDifference(c.intersectionb(mask)); });
+	double fusedTime = timeIt([&]() { fused = (a | b) - (c & mask); });
+	bool sameExpr = true;
+	for (size_t i = 0; i < N; i++) {
+		sameExpr = sameExpr && (fused[i] == stepwise[i]);
+	}
+	std::cout << "(a | b) - (c & mask): bulk calls " << stepTime << ", expression " << fusedTime << " (same results: " << sameExpr << ")" << std::endl;
+
+	return 0;
+}
+
+
+/*
+N = 10000000, MAX_ELEMS = 64, -O2 -march=native (both sides are memory bound at this size, the per-set loop
+is close because the compiler vectorizes it too once everything is inlined into one loop)
+per-set loop: mask 0.00667509, union 0.0218347, sizes 0.0105435
+TinyBitSetArray: mask 0.00794467, union 0.0120573, sizes 0.0114148 (same results: 1)
+element counts: getIntegerElements loop 0.717591, elementCounts 0.0175561, 8 threads 0.0180532 (same results: 1)
+(the thread timing is from a single core machine)
+(a | b) - (c & mask): bulk calls 0.458327, expression 0.075461 (same results: 1)
+(the three temporaries of the bulk calls are each written and read back, and allocated, the expression reads
+a, b and c once and writes the result once)
+*/
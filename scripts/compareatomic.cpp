@@ -0,0 +1,99 @@
+/*
+
+	time a contended 64 slot claim mask, T threads each claiming a free slot and releasing it again, N times
+	1. AtomicTinyBitSet, tryPopSmallest + insert
+	2. TinyBitSet behind a std::mutex, popSmallest + insert
+
+*/
+
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../tinybitatomic.h"
+
+const int MAX_ELEMS = 64;
+
+
+float timeClaimsAtomic(int N, int T) {
+	AtomicTinyBitSet<MAX_ELEMS> slots;
+	slots.fill();
+	auto start = std::chrono::high_resolution_clock::now();
+	std::vector<std::thread> workers;
+	for (int t = 0; t < T; t++) {
+		workers.emplace_back([&slots, N]() {
+			for (int i = 0; i < N; i++) {
+				int slot = slots.tryPopSmallest();
+				if (slot != 0) {
+					slots.insert(slot);
+				}
+			}
+		});
+	}
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count();
+}
+
+
+float timeClaimsMutex(int N, int T) {
+	TinyBitSet<MAX_ELEMS> slots;
+	slots.fill();
+	std::mutex lock;
+	auto start = std::chrono::high_resolution_clock::now();
+	std::vector<std::thread> workers;
+	for (int t = 0; t < T; t++) {
+		workers.emplace_back([&slots, &lock, N]() {
+			for (int i = 0; i < N; i++) {
+				int slot;
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					slot = slots.popSmallest();
+				}
+				if (slot != 0) {
+					std::lock_guard<std::mutex> guard(lock);
+					slots.insert(slot);
+				}
+			}
+		});
+	}
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count();
+}
+
+
+int main() {
+
+	int N = 1000000;
+	int maxThreads = int(std::thread::hardware_concurrency());
+	if (maxThreads < 1) {
+		maxThreads = 1;
+	}
+
+	std::cout << "N = " << N << " claims per thread, MAX_ELEMS = " << MAX_ELEMS << ", hardware threads = " << maxThreads << std::endl;
+
+	for (int T = 1; T <= 2 * maxThreads; T *= 2) {
+		float t1 = timeClaimsAtomic(N, T);
+		float t2 = timeClaimsMutex(N, T);
+		std::cout << "threads = " << T << ", AtomicTinyBitSet: " << t1 << ", mutex + TinyBitSet: " << t2 << std::endl;
+	}
+
+	return 0;
+}
+
+
+/*
+single core machine, so this only shows the uncontended cost, rerun on a multi-core box for contention:
+
+N = 1000000 claims per thread, MAX_ELEMS = 64, hardware threads = 1
+threads = 1, AtomicTinyBitSet: 0.0239082, mutex + TinyBitSet: 0.0493037
+threads = 2, AtomicTinyBitSet: 0.0484193, mutex + TinyBitSet: 0.0964451
+*/
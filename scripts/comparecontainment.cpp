@@ -0,0 +1,101 @@
+/*
+
+	time "which stored rule masks are satisfied by this fact set" (stored subsets of a query)
+	1. a linear scan calling leftDifference(...).isempty() per rule
+	2. TinyBitContainmentIndex.subsetsOf
+	3. the batched query over threads
+	and the other direction, rules needing at least the facts of a small query (stored supersets)
+
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "../tinybitcontainment.h"
+
+const int MAX_ELEMS = 64;
+
+
+template <typename Fn>
+double timeIt(Fn fn) {
+	auto start = std::chrono::high_resolution_clock::now();
+	fn();
+	auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count();
+}
+
+
+int main() {
+
+	size_t N = 100000;
+	int Q = 1000;
+	// rules need 2 - 6 facts, fact sets hold about a third of the 64
+	std::vector<TinyBitSet<MAX_ELEMS>> rules(N);
+	for (auto &r : rules) {
+		for (int k = 2 + rand() % 5; k > 0; k--) {
+			r.insert(rand() % MAX_ELEMS + 1);
+		}
+	}
+	std::vector<TinyBitSet<MAX_ELEMS>> facts(Q);
+	for (auto &f : facts) {
+		f = TinyBitSet<MAX_ELEMS>((uint64_t(rand()) << 32) | uint64_t(rand())).intersectionb(TinyBitSet<MAX_ELEMS>((uint64_t(rand()) << 32) | uint64_t(rand())));
+	}
+
+	std::cout << "N = " << N << " rules, " << Q << " queries, MAX_ELEMS = " << MAX_ELEMS << std::endl;
+
+	size_t loopHits = 0;
+	double loop = timeIt([&]() {
+		for (auto f : facts) {
+			for (size_t i = 0; i < N; i++) {
+				loopHits += rules[i].leftDifference(f).isempty() ? 1 : 0;
+			}
+		}
+	});
+
+	TinyBitContainmentIndex<MAX_ELEMS> index;
+	for (auto const &r : rules) {
+		index.insert(r);
+	}
+	size_t hits = 0;
+	size_t batchHits = 0;
+	double indexTime = timeIt([&]() { for (auto const &f : facts) { hits += index.subsetsOf(f).size(); } });
+	double batchTime = timeIt([&]() { for (auto const &ids : index.subsetsOf(facts.data(), facts.size(), 8)) { batchHits += ids.size(); } });
+
+	std::vector<TinyBitSet<MAX_ELEMS>> small(Q);
+	for (auto &q : small) {
+		q.insert(rand() % MAX_ELEMS + 1);
+		q.insert(rand() % MAX_ELEMS + 1);
+	}
+	size_t loopSupHits = 0;
+	size_t supHits = 0;
+	double loopSup = timeIt([&]() {
+		for (auto q : small) {
+			for (size_t i = 0; i < N; i++) {
+				loopSupHits += q.leftDifference(rules[i]).isempty() ? 1 : 0;
+			}
+		}
+	});
+	double indexSup = timeIt([&]() { for (auto const &q : small) { supHits += index.supersetsOf(q).size(); } });
+
+	std::cout << "subsets, linear scan: " << loop << ", index: " << indexTime << ", batched over 8 threads: " << batchTime
+			  << " (same results: " << ((hits == loopHits) && (batchHits == loopHits)) << ")" << std::endl;
+	std::cout << "supersets, linear scan: " << loopSup << ", index: " << indexSup << " (same results: " << (supHits == loopSupHits) << ", "
+			  << double(supHits) / Q << " matches a query)" << std::endl;
+
+	return 0;
+}
+
+
+/*
+results, -O2 (no -march), one core, so the batched run only shows the thread overhead:
+N = 100000 rules, 1000 queries, MAX_ELEMS = 64
+subsets, linear scan: 0.0785042, index: 0.0394267, batched over 8 threads: 0.0511125 (same results: 1)
+supersets, linear scan: 0.0987217, index: 0.0116549 (same results: 1, 462.395 matches a query)
+with N = 1000000 the subset queries run about 3x faster than the scan (0.62 vs 0.22). a superset query of
+two elements matches 0.46% of the rules, and its shortest posting list holds about 6000 of the 100000, so
+the index reads 1 / 16 of the sets and runs 8x faster than the scan. with -march=native the scan vectorizes
+and takes 0.019 for either direction: supersets still come out 1.7x faster (0.011), subsets 2x slower (0.042)
+*/
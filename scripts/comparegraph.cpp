@@ -0,0 +1,227 @@
+/*
+
+	time the graph algorithms on many random graphs of 64 vertices, against the same algorithms written the
+	usual way over a std::vector<TinyBitSet<64>> adjacency (one vertex at a time, contains() per pair)
+	1. reachability from every vertex: queue BFS vs reachableFrom
+	2. transitive closure: Floyd-Warshall on contains vs transitiveClosure
+	3. maximum clique: plain Bron-Kerbosch over vectors vs maximumClique
+	4. colouring: first fit vs greedyColoring, and dsaturColoring
+	5. maximumClique over all graphs with mapGraphs, 1 vs 4 threads
+
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "../tinybitgraph.h"
+
+const int N = 64;
+
+using Adjacency = std::vector<TinyBitSet<N>>;
+
+
+template <typename Fn>
+double timeIt(Fn fn) {
+	auto start = std::chrono::high_resolution_clock::now();
+	fn();
+	auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count();
+}
+
+
+int reachByQueue(Adjacency const &adj, int s) {
+	std::vector<bool> seen(N + 1, false);
+	std::vector<int> queue = {s};
+	seen[s] = true;
+	for (size_t q = 0; q < queue.size(); q++) {
+		for (int v = 1; v <= N; v++) {
+			if (adj[queue[q] - 1].contains(v) && !seen[v]) {
+				seen[v] = true;
+				queue.push_back(v);
+			}
+		}
+	}
+	return int(queue.size());
+}
+
+
+Adjacency closureByContains(Adjacency adj) {
+	for (int k = 1; k <= N; k++) {
+		for (int i = 1; i <= N; i++) {
+			for (int j = 1; j <= N; j++) {
+				if (!adj[i - 1].contains(j) && adj[i - 1].contains(k) && adj[k - 1].contains(j)) {
+					adj[i - 1].insert(j);
+				}
+			}
+		}
+	}
+	return adj;
+}
+
+
+void cliqueByVectors(Adjacency const &adj, std::vector<int> &r, std::vector<int> p, std::vector<int> x, size_t &best) {
+	if (p.empty() && x.empty()) {
+		best = (r.size() > best) ? r.size() : best;
+		return;
+	}
+	while (!p.empty()) {
+		int v = p.back();
+		std::vector<int> np;
+		std::vector<int> nx;
+		for (int u : p) {
+			if (adj[v - 1].contains(u)) {
+				np.push_back(u);
+			}
+		}
+		for (int u : x) {
+			if (adj[v - 1].contains(u)) {
+				nx.push_back(u);
+			}
+		}
+		r.push_back(v);
+		cliqueByVectors(adj, r, np, nx, best);
+		r.pop_back();
+		p.pop_back();
+		x.push_back(v);
+	}
+}
+
+
+int firstFit(Adjacency const &adj) {
+	std::vector<int> color(N + 1, 0);
+	int count = 0;
+	for (int v = 1; v <= N; v++) {
+		std::vector<bool> used(N + 2, false);
+		for (int u = 1; u < v; u++) {
+			if (adj[v - 1].contains(u)) {
+				used[color[u]] = true;
+			}
+		}
+		color[v] = 1;
+		while (used[color[v]]) {
+			color[v]++;
+		}
+		count = (color[v] > count) ? color[v] : count;
+	}
+	return count;
+}
+
+
+int main() {
+
+	size_t G = 2000;
+	int percent = 20;
+	std::vector<TinyBitGraph<N>> graphs;
+	std::vector<Adjacency> adjacency;
+	for (size_t g = 0; g < G; g++) {
+		TinyBitGraph<N> graph(N);
+		for (int u = 1; u <= N; u++) {
+			for (int v = u + 1; v <= N; v++) {
+				if (rand() % 100 < percent) {
+					graph.addEdge(u, v);
+				}
+			}
+		}
+		Adjacency adj;
+		for (int v = 1; v <= N; v++) {
+			adj.push_back(graph.neighbours(v));
+		}
+		graphs.push_back(graph);
+		adjacency.push_back(adj);
+	}
+	std::cout << G << " graphs of " << N << " vertices, " << percent << "% of edges" << std::endl;
+
+	size_t byQueue = 0;
+	double queueTime = timeIt([&]() { for (size_t g = 0; g < G; g++) { for (int s = 1; s <= N; s++) { byQueue += reachByQueue(adjacency[g], s); } } });
+	size_t bySets = 0;
+	double setsTime = timeIt([&]() { for (size_t g = 0; g < G; g++) { for (int s = 1; s <= N; s++) { bySets += graphs[g].reachableFrom(s).getSetSize(); } } });
+	std::cout << "reachability, queue: " << queueTime << ", reachableFrom: " << setsTime << " (same results: " << (byQueue == bySets) << ")" << std::endl;
+
+	// the graphs are almost always connected, so the closures are directed versions with half the arcs
+	std::vector<TinyBitGraph<N>> dags;
+	std::vector<Adjacency> dagAdjacency(G, Adjacency(N));
+	for (size_t g = 0; g < G; g++) {
+		TinyBitGraph<N> dag(N);
+		for (int u = 1; u <= N; u++) {
+			for (int v : graphs[g].neighbours(u)) {
+				if (v > u + 2) {
+					dag.addArc(u, v);
+					dagAdjacency[g][u - 1].insert(v);
+				}
+			}
+		}
+		dags.push_back(dag);
+	}
+	size_t containsArcs = 0;
+	double containsTime = timeIt([&]() {
+		for (size_t g = 0; g < G; g++) {
+			for (TinyBitSet<N> const &row : closureByContains(dagAdjacency[g])) {
+				containsArcs += row.getSetSize();
+			}
+		}
+	});
+	size_t closureArcs = 0;
+	double closureTime = timeIt([&]() {
+		for (size_t g = 0; g < G; g++) {
+			TinyBitGraph<N> closure = dags[g].transitiveClosure();
+			for (int v = 1; v <= N; v++) {
+				closureArcs += closure.degree(v);
+			}
+		}
+	});
+	std::cout << "closure, contains: " << containsTime << ", transitiveClosure: " << closureTime << " (same results: " << (containsArcs == closureArcs) << ")"
+			  << std::endl;
+
+	size_t byVectors = 0;
+	double vectorsTime = timeIt([&]() {
+		for (size_t g = 0; g < G; g++) {
+			std::vector<int> r;
+			std::vector<int> p;
+			for (int v = 1; v <= N; v++) {
+				p.push_back(v);
+			}
+			size_t best = 0;
+			cliqueByVectors(adjacency[g], r, p, {}, best);
+			byVectors += best;
+		}
+	});
+	size_t pivoted = 0;
+	double pivotedTime = timeIt([&]() { for (size_t g = 0; g < G; g++) { pivoted += graphs[g].maximumClique().getSetSize(); } });
+	std::cout << "maximum clique, vectors: " << vectorsTime << ", maximumClique: " << pivotedTime << " (same results: " << (byVectors == pivoted) << ")"
+			  << std::endl;
+
+	size_t fitted = 0;
+	double fitTime = timeIt([&]() { for (size_t g = 0; g < G; g++) { fitted += firstFit(adjacency[g]); } });
+	size_t greedy = 0;
+	double greedyTime = timeIt([&]() { for (size_t g = 0; g < G; g++) { greedy += graphs[g].greedyColoring().count; } });
+	size_t dsatur = 0;
+	double dsaturTime = timeIt([&]() { for (size_t g = 0; g < G; g++) { dsatur += graphs[g].dsaturColoring().count; } });
+	std::cout << "colouring, first fit: " << fitTime << ", greedyColoring: " << greedyTime << " (same results: " << (fitted == greedy) << ")"
+			  << ", dsaturColoring: " << dsaturTime << " (" << double(dsatur) / G << " colours against " << double(greedy) / G << ")" << std::endl;
+
+	auto clique = [](TinyBitGraph<N> const &g) { return g.maximumClique().getSetSize(); };
+	std::vector<int> one;
+	double oneTime = timeIt([&]() { one = mapGraphs(graphs.data(), G, clique); });
+	std::vector<int> four;
+	double fourTime = timeIt([&]() { four = mapGraphs(graphs.data(), G, clique, 4); });
+	std::cout << "mapGraphs maximumClique, 1 thread: " << oneTime << ", 4 threads: " << fourTime << " (same results: " << (one == four) << ")" << std::endl;
+
+	return 0;
+}
+
+
+/*
+results, -O2 -march=native, one core:
+2000 graphs of 64 vertices, 20% of edges
+reachability, queue: 1.92973, reachableFrom: 0.0100871 (same results: 1)
+closure, contains: 1.17396, transitiveClosure: 0.0220931 (same results: 1)
+maximum clique, vectors: 0.36971, maximumClique: 0.0223397 (same results: 1)
+colouring, first fit: 0.0239518, greedyColoring: 0.000778713 (same results: 1), dsaturColoring: 0.0287511 (6.4765 colours against 8.19)
+mapGraphs maximumClique, 1 thread: 0.0212582, 4 threads: 0.0217279 (same results: 1)
+the queue BFS and contains() closure pay for every pair of vertices, the set versions for every vertex. the pivot
+and the size cut off prune most of the clique search. dsatur is slower than first fit but saves 1.7 colours a graph.
+with a single core the 4 threads only show their overhead, each graph is independent so they scale with the cores
+*/
@@ -0,0 +1,103 @@
+/*
+
+	time memoization lookups keyed by small sets for
+	1. TinyBitSetMap, 2. std::unordered_map<TinyBitSet, V> (std::hash), 3. std::unordered_map<uint64_t, V> on getBitInt()
+	a. insertion
+	b. lookup of present keys
+	c. lookup of absent keys
+
+	keys are random 1-4 element subsets of 1-64, the low entropy patterns typical of subset DP
+
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+#include "../tinybitmap.h"
+
+const int MAX_ELEMS = 64;
+
+
+std::vector<TinyBitSet<MAX_ELEMS>> randomKeys(int N) {
+	std::vector<TinyBitSet<MAX_ELEMS>> keys(N);
+	for (int i = 0; i < N; i++) {
+		int nelems = (rand() % 4) + 1;
+		for (int j = 0; j < nelems; j++) {
+			keys[i].insert((rand() % MAX_ELEMS) + 1);
+		}
+	}
+	return keys;
+}
+
+
+template <typename Map, typename KeyFn>
+void timeMap(char const *name, std::vector<TinyBitSet<MAX_ELEMS>> const &keys, std::vector<TinyBitSet<MAX_ELEMS>> const &absent, KeyFn keyfn) {
+	Map m;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < keys.size(); i++) {
+		m[keyfn(keys[i])] = int(i);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> insertion = end - start;
+
+	long hits = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < keys.size(); i++) {
+		hits += m.count(keyfn(keys[i]));
+	}
+	end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> present = end - start;
+
+	start = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < absent.size(); i++) {
+		hits += m.count(keyfn(absent[i]));
+	}
+	end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> missing = end - start;
+
+	std::cout << name << ": insertion " << insertion.count() << ", present lookup " << present.count()
+			  << ", absent lookup " << missing.count() << " (" << m.size() << " keys, " << hits << " hits)" << std::endl;
+}
+
+
+// count() adapter so TinyBitSetMap fits the same timing loop
+template <typename V>
+struct TinyBitSetMapAdapter : TinyBitSetMap<MAX_ELEMS, V> {
+	size_t count(TinyBitSet<MAX_ELEMS> const &key) const {
+		return this->contains(key) ? 1 : 0;
+	}
+};
+
+
+int main() {
+
+	int N = 1000000;
+
+	std::vector<TinyBitSet<MAX_ELEMS>> keys = randomKeys(N);
+	std::vector<TinyBitSet<MAX_ELEMS>> absent = randomKeys(N);
+	for (TinyBitSet<MAX_ELEMS> &key : absent) {
+		key.insertRange(60, 64);  // 5+ elements, never in keys
+	}
+
+	std::cout << "N = " << N << ", MAX_ELEMS = " << MAX_ELEMS << std::endl;
+
+	timeMap<TinyBitSetMapAdapter<int>>("TinyBitSetMap", keys, absent,
+		[](TinyBitSet<MAX_ELEMS> const &k) { return k; });
+	timeMap<std::unordered_map<TinyBitSet<MAX_ELEMS>, int>>("std::unordered_map<TinyBitSet>", keys, absent,
+		[](TinyBitSet<MAX_ELEMS> const &k) { return k; });
+	timeMap<std::unordered_map<uint64_t, int>>("std::unordered_map<uint64_t>", keys, absent,
+		[](TinyBitSet<MAX_ELEMS> const &k) { return uint64_t(k.getBitInt()); });
+
+	return 0;
+}
+
+
+/*
+N = 1000000, MAX_ELEMS = 64
+TinyBitSetMap: insertion 0.0351835, present lookup 0.0196719, absent lookup 0.0103653 (235047 keys, 1000000 hits)
+std::unordered_map<TinyBitSet>: insertion 0.0786, present lookup 0.0440313, absent lookup 0.0514892 (235047 keys, 1000000 hits)
+std::unordered_map<uint64_t>: insertion 0.0565262, present lookup 0.0344448, absent lookup 0.0361403 (235047 keys, 1000000 hits)
+*/
@@ -0,0 +1,76 @@
+/*
+
+	time the all-pairs intersection counts between two collections of TinyBitSet<64>
+	1. nested loops calling intersectionb(...).getSetSize()
+	2. intersectionCounts, the tiled kernel, into an existing buffer
+	3. the same split over threads
+	4. intersectingPairs with a threshold
+
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "../tinybitjoin.h"
+
+const int MAX_ELEMS = 64;
+
+
+template <typename Fn>
+double timeIt(Fn fn) {
+	auto start = std::chrono::high_resolution_clock::now();
+	fn();
+	auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count();
+}
+
+
+int main() {
+
+	size_t NA = 10000;
+	size_t NB = 20000;
+	std::vector<TinyBitSet<MAX_ELEMS>> a(NA);
+	std::vector<TinyBitSet<MAX_ELEMS>> b(NB);
+	for (auto &s : a) {
+		s = TinyBitSet<MAX_ELEMS>((uint64_t(rand()) << 32) | uint64_t(rand()));
+	}
+	for (auto &s : b) {
+		s = TinyBitSet<MAX_ELEMS>((uint64_t(rand()) << 32) | uint64_t(rand()));
+	}
+	std::vector<int> loopCounts(NA * NB);
+	std::vector<int> counts(NA * NB);
+
+	std::cout << "NA = " << NA << ", NB = " << NB << ", MAX_ELEMS = " << MAX_ELEMS << std::endl;
+
+	double loop = timeIt([&]() {
+		for (size_t i = 0; i < NA; i++) {
+			for (size_t j = 0; j < NB; j++) {
+				loopCounts[i * NB + j] = a[i].intersectionb(b[j]).getSetSize();
+			}
+		}
+	});
+	double tiled = timeIt([&]() { intersectionCounts(counts.data(), a.data(), NA, b.data(), NB); });
+	bool same = (counts == loopCounts);
+	double threaded = timeIt([&]() { intersectionCounts(counts.data(), a.data(), NA, b.data(), NB, 8); });
+	size_t npairs = 0;
+	double pairs = timeIt([&]() { npairs = intersectingPairs(a.data(), NA, b.data(), NB, 26).size(); });
+
+	std::cout << "nested loops: " << loop << ", intersectionCounts: " << tiled << " (same results: " << same << ")" << std::endl;
+	std::cout << "intersectionCounts, 8 threads: " << threaded << std::endl;
+	std::cout << "intersectingPairs >= 26: " << pairs << " (" << npairs << " pairs)" << std::endl;
+
+	return 0;
+}
+
+
+/*
+NA = 10000, NB = 20000, MAX_ELEMS = 64, -O2 (no -march), AVX-512 cpu, single core
+nested loops: 0.487488, intersectionCounts: 0.137091 (same results: 1)
+intersectionCounts, 8 threads: 0.138309
+intersectingPairs >= 26: 0.20172 (504366 pairs)
+with -march=native the nested loops vectorize too and come out even: both are bound by writing the
+800MB matrix, which intersectingPairs never materializes
+*/
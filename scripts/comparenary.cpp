@@ -0,0 +1,98 @@
+/*
+
+	time intersecting groups of 32 filter sets, as in candidate filtering where most intersections empty out
+	after a few operands, and unions of 32 sparse sets, which rarely fill up. the groups fit in L2 and are
+	run R times, as a pipeline reusing its filters would
+	1. chained intersectionb / unionb calls over the whole group
+	2. intersectAll / unionAll over the group in memory (early exit checked every 8, combined as a tree)
+	3. the variadic forms on 8 of the sets
+
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "../tinybitset.h"
+
+const int MAX_ELEMS = 256;
+
+
+template <typename Fn>
+double timeIt(Fn fn) {
+	auto start = std::chrono::high_resolution_clock::now();
+	fn();
+	auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count();
+}
+
+
+int main() {
+
+	size_t G = 1000;
+	size_t K = 32;
+	size_t R = 1000;
+	// filters keep about half the elements, sparse sets hold 4
+	std::vector<TinyBitSet<MAX_ELEMS>> filters(G * K);
+	std::vector<TinyBitSet<MAX_ELEMS>> sparse(G * K);
+	for (size_t i = 0; i < G * K; i++) {
+		for (int k = 0; k < MAX_ELEMS / 2; k++) {
+			filters[i].insert(rand() % MAX_ELEMS + 1);
+		}
+		for (int k = 0; k < 4; k++) {
+			sparse[i].insert(rand() % MAX_ELEMS + 1);
+		}
+	}
+	std::cout << R << " x " << G << " groups of " << K << " sets, MAX_ELEMS = " << MAX_ELEMS << std::endl;
+
+	size_t chained = 0;
+	double chainTime = timeIt([&]() {
+		for (size_t g = 0; g < G * R; g++) {
+			TinyBitSet<MAX_ELEMS> acc = filters[(g % G) * K];
+			for (size_t k = 1; k < K; k++) {
+				acc = acc.intersectionb(filters[(g % G) * K + k]);
+			}
+			chained += acc.getSetSize();
+		}
+	});
+	size_t nary = 0;
+	double naryTime = timeIt([&]() { for (size_t g = 0; g < G * R; g++) { nary += intersectAll(filters.data() + (g % G) * K, K).getSetSize(); } });
+	size_t variadic = 0;
+	double variadicTime = timeIt([&]() {
+		for (size_t g = 0; g < G * R; g++) {
+			TinyBitSet<MAX_ELEMS> const *f = filters.data() + (g % G) * K;
+			variadic += intersectAll(f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7]).getSetSize();
+		}
+	});
+	std::cout << "intersections, chained: " << chainTime << ", intersectAll: " << naryTime << " (same results: " << (chained == nary) << ")"
+			  << ", variadic of 8: " << variadicTime << " (" << variadic << ")" << std::endl;
+
+	size_t chainedUnion = 0;
+	double chainUnionTime = timeIt([&]() {
+		for (size_t g = 0; g < G * R; g++) {
+			TinyBitSet<MAX_ELEMS> acc = sparse[(g % G) * K];
+			for (size_t k = 1; k < K; k++) {
+				acc = acc.unionb(sparse[(g % G) * K + k]);
+			}
+			chainedUnion += acc.getSetSize();
+		}
+	});
+	size_t naryUnion = 0;
+	double naryUnionTime = timeIt([&]() { for (size_t g = 0; g < G * R; g++) { naryUnion += unionAll(sparse.data() + (g % G) * K, K).getSetSize(); } });
+	std::cout << "unions, chained: " << chainUnionTime << ", unionAll: " << naryUnionTime << " (same results: " << (chainedUnion == naryUnion) << ")"
+			  << std::endl;
+
+	return 0;
+}
+
+
+/*
+results, -O2 -march=native:
+1000 x 1000 groups of 32 sets, MAX_ELEMS = 256
+intersections, chained: 0.0145383, intersectAll: 0.00701127 (same results: 1), variadic of 8: 0.00952986 (184000)
+unions, chained: 0.0242138, unionAll: 0.0218162 (same results: 1)
+the intersections are empty after 6 - 8 filters, so intersectAll reads about a quarter of each group.
+the sparse unions never fill up and come out even, the chained loop is already one or over each operand
+*/
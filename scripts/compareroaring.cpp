@@ -0,0 +1,109 @@
+/*
+
+	time and size 32-bit id sets for
+	1. TinyRoaringSet, 2. std::unordered_set<uint32_t>
+	a. insertion
+	b. membership lookups
+	c. intersection of two sets
+
+	ids are clustered the way allocated ids tend to be: a few dense ranges plus sparse noise over 2^26
+
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <unordered_set>
+#include <vector>
+#include "../tinybitroaring.h"
+
+
+std::vector<uint32_t> randomIds(int N) {
+	std::vector<uint32_t> ids(N);
+	for (int i = 0; i < N; i++) {
+		uint32_t cluster = uint32_t(rand() % 16) << 22;
+		ids[i] = (i % 4 == 0) ? uint32_t(rand() % (1 << 26)) : cluster + uint32_t(rand() % 200000);
+	}
+	return ids;
+}
+
+
+int main() {
+
+	int N = 1000000;
+	std::vector<uint32_t> a = randomIds(N);
+	std::vector<uint32_t> b = randomIds(N);
+	std::cout << "N = " << N << std::endl;
+
+	TinyRoaringSet ra;
+	TinyRoaringSet rb;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < N; i++) {
+		ra.insert(a[i]);
+		rb.insert(b[i]);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> rinsert = end - start;
+
+	long hits = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < N; i++) {
+		hits += ra.contains(b[i]);
+	}
+	end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> rlookup = end - start;
+
+	start = std::chrono::high_resolution_clock::now();
+	TinyRoaringSet rboth = ra.intersectionb(rb);
+	end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> rintersect = end - start;
+
+	std::cout << "TinyRoaringSet: insertion " << rinsert.count() << ", lookup " << rlookup.count() << ", intersection "
+			  << rintersect.count() << " (" << ra.getSetSize() << " ids, " << ra.getSizeInBytes() << " bytes, "
+			  << hits << " hits, " << rboth.getSetSize() << " shared)" << std::endl;
+
+
+	std::unordered_set<uint32_t> ua;
+	std::unordered_set<uint32_t> ub;
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < N; i++) {
+		ua.insert(a[i]);
+		ub.insert(b[i]);
+	}
+	end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> uinsert = end - start;
+
+	hits = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < N; i++) {
+		hits += ua.count(b[i]);
+	}
+	end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> ulookup = end - start;
+
+	start = std::chrono::high_resolution_clock::now();
+	std::unordered_set<uint32_t> uboth;
+	for (uint32_t x : ua) {
+		if (ub.count(x)) {
+			uboth.insert(x);
+		}
+	}
+	end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> uintersect = end - start;
+
+	// one node (next pointer + value, rounded up by malloc) per id plus the bucket array
+	size_t ubytes = ua.size() * 32 + ua.bucket_count() * sizeof(void *);
+	std::cout << "std::unordered_set<uint32_t>: insertion " << uinsert.count() << ", lookup " << ulookup.count() << ", intersection "
+			  << uintersect.count() << " (" << ua.size() << " ids, ~" << ubytes << " bytes, "
+			  << hits << " hits, " << uboth.size() << " shared)" << std::endl;
+
+	return 0;
+}
+
+
+/*
+N = 1000000
+TinyRoaringSet: insertion 0.270636, lookup 0.0660155, intersection 0.00205107 (915462 ids, 893520 bytes, 162432 hits, 144688 shared)
+std::unordered_set<uint32_t>: insertion 0.831046, lookup 0.0973984, intersection 0.218683 (915462 ids, ~40872008 bytes, 162432 hits, 144688 shared)
+*/
@@ -0,0 +1,85 @@
+/*
+
+	time top-k nearest neighbour queries over TinyBitSet<64> fingerprints
+	1. a hand written loop: intersectionb / unionb / getSetSize per set, then a partial sort
+	2. topJaccard / topHamming, a blocked scan with a bounded heap
+	3. TinyBitSimilarityIndex, the same with popcount pruning by size group
+	4. topJaccard split over threads
+
+*/
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#include "../tinybitsimilarity.h"
+
+const int MAX_ELEMS = 64;
+
+
+template <typename Fn>
+double timeIt(Fn fn) {
+	auto start = std::chrono::high_resolution_clock::now();
+	fn();
+	auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count();
+}
+
+
+int main() {
+
+	size_t N = 1000000;
+	size_t K = 10;
+	int Q = 20;
+	std::vector<TinyBitSet<MAX_ELEMS>> sets(N);
+	for (size_t i = 0; i < N; i++) {
+		// sparse fingerprints with varied sizes, where the size groups have something to prune
+		uint64_t x = (uint64_t(rand()) << 32) | uint64_t(rand());
+		for (int d = rand() % 4; d > 0; d--) {
+			x &= (uint64_t(rand()) << 32) | uint64_t(rand());
+		}
+		sets[i] = TinyBitSet<MAX_ELEMS>(x);
+	}
+	std::vector<TinyBitSet<MAX_ELEMS>> queries(sets.begin(), sets.begin() + Q);
+
+	std::cout << "N = " << N << ", K = " << K << ", queries = " << Q << ", MAX_ELEMS = " << MAX_ELEMS << std::endl;
+
+	size_t check = 0;
+	double loop = timeIt([&]() {
+		for (TinyBitSet<MAX_ELEMS> q : queries) {
+			std::vector<std::pair<double, size_t>> scores(N);
+			for (size_t i = 0; i < N; i++) {
+				int u = sets[i].unionb(q).getSetSize();
+				scores[i] = std::make_pair((u == 0) ? -1.0 : -double(sets[i].intersectionb(q).getSetSize()) / u, i);
+			}
+			std::partial_sort(scores.begin(), scores.begin() + K, scores.end());
+			check += scores[0].second;
+		}
+	});
+	double scan = timeIt([&]() { for (auto const &q : queries) { check += topJaccard(sets.data(), N, q, K)[0].index; } });
+	double scanH = timeIt([&]() { for (auto const &q : queries) { check += topHamming(sets.data(), N, q, K)[0].index; } });
+	TinyBitSimilarityIndex<MAX_ELEMS> index(sets.data(), N);
+	double indexed = timeIt([&]() { for (auto const &q : queries) { check += index.topJaccard(q, K)[0].index; } });
+	double indexedH = timeIt([&]() { for (auto const &q : queries) { check += index.topHamming(q, K)[0].index; } });
+	double threaded = timeIt([&]() { for (auto const &q : queries) { check += topJaccard(sets.data(), N, q, K, 8)[0].index; } });
+
+	std::cout << "loop + partial_sort (jaccard): " << loop << std::endl;
+	std::cout << "topJaccard: " << scan << ", topHamming: " << scanH << std::endl;
+	std::cout << "index topJaccard: " << indexed << ", index topHamming: " << indexedH << std::endl;
+	std::cout << "topJaccard, 8 threads: " << threaded << " (" << check << ")" << std::endl;
+
+	return 0;
+}
+
+
+/*
+N = 1000000, K = 10, queries = 20, MAX_ELEMS = 64, -O2 (no -march), AVX-512 cpu, single core
+loop + partial_sort (jaccard): 0.220514
+topJaccard: 0.0569308, topHamming: 0.0476782
+index topJaccard: 0.0234583, index topHamming: 0.0196596
+topJaccard, 8 threads: 0.0576685
+*/
@@ -0,0 +1,131 @@
+#include "../tinybitalloc.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+void testAllocateRelease() {
+	TinyBitSlotAllocator pool(100);
+	long first = pool.allocate();
+	long second = pool.allocate();
+	bool released = pool.release(0);
+	bool releasedAgain = pool.release(0);
+	long reused = pool.allocate();
+
+	bool thrown = false;
+	try {
+		pool.release(100);
+	} catch (std::invalid_argument const &) {
+		thrown = true;
+	}
+	if ((first == 0) && (second == 1) && released && !releasedAgain && (reused == 0) && thrown && (pool.freeCount() == 98)) {
+		std::cout << "passed test: testAllocateRelease" << std::endl;
+	} else {
+		std::cout << "failed test: testAllocateRelease, free:" << pool.freeCount() << std::endl;
+	}
+	return;
+}
+
+
+void testExhaustDeep() {
+	// 3 levels, capacity not a multiple of 64, so the padding bits of the last leaf must stay used
+	size_t n = 64 * 64 + 70;
+	TinyBitSlotAllocator pool(n);
+	bool inOrder = true;
+	for (size_t i = 0; i < n; i++) {
+		inOrder = inOrder && (pool.allocate() == long(i));
+	}
+	long full = pool.allocate();
+	pool.release(4100);
+	pool.release(77);
+	long low = pool.allocate();
+	long high = pool.allocate();
+
+	if (inOrder && (full == -1) && (low == 77) && (high == 4100) && (pool.allocate() == -1) && (pool.freeCount() == 0)) {
+		std::cout << "passed test: testExhaustDeep" << std::endl;
+	} else {
+		std::cout << "failed test: testExhaustDeep, full:" << full << " low:" << low << " high:" << high << std::endl;
+	}
+	return;
+}
+
+
+void testNextFree() {
+	// compare against a linear scan after a scattered pattern of claims
+	size_t n = 64 * 64 * 2 + 5;
+	TinyBitSlotAllocator pool(n);
+	std::vector<bool> used(n, false);
+	for (size_t i = 0; i < n; i++) {
+		if ((i * 2654435761u) % 97 != 0) {
+			pool.claim(i);
+			used[i] = true;
+		}
+	}
+	bool same = true;
+	for (long after = -1; after < long(n) + 3; after++) {
+		long want = -1;
+		for (size_t i = size_t(after + 1); i < n; i++) {
+			if (!used[i]) {
+				want = long(i);
+				break;
+			}
+		}
+		same = same && (pool.nextFree(after) == want);
+	}
+	if (same && pool.isFree(0) && !pool.isFree(1) && !pool.claim(1)) {
+		std::cout << "passed test: testNextFree" << std::endl;
+	} else {
+		std::cout << "failed test: testNextFree" << std::endl;
+	}
+	return;
+}
+
+
+void testShardedConcurrent() {
+	// every slot handed out exactly once across threads, then all released
+	size_t n = 5000;
+	ShardedTinyBitSlotAllocator pool(n, 4);
+	std::vector<std::vector<long>> claimed(4);
+	std::vector<std::thread> workers;
+	for (size_t w = 0; w < 4; w++) {
+		workers.emplace_back([&pool, &claimed, w]() {
+			for (long slot = pool.allocate(w); slot != -1; slot = pool.allocate(w)) {
+				claimed[w].push_back(slot);
+			}
+		});
+	}
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+
+	std::vector<bool> seen(n, false);
+	size_t total = 0;
+	bool unique = true;
+	for (std::vector<long> const &slots : claimed) {
+		for (long slot : slots) {
+			unique = unique && !seen[size_t(slot)];
+			seen[size_t(slot)] = true;
+			total++;
+		}
+	}
+	bool released = true;
+	for (size_t i = 0; i < n; i++) {
+		released = released && pool.release(i);
+	}
+	if (unique && (total == n) && released && (pool.freeCount() == n) && (pool.shardCount() == 4)) {
+		std::cout << "passed test: testShardedConcurrent" << std::endl;
+	} else {
+		std::cout << "failed test: testShardedConcurrent, total:" << total << std::endl;
+	}
+	return;
+}
+
+
+
+int main() {
+	testAllocateRelease();
+	testExhaustDeep();
+	testNextFree();
+	testShardedConcurrent();
+	return 0;
+}
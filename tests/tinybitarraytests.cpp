@@ -0,0 +1,210 @@
+#include "../tinybitarray.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+template <int N>
+TinyBitSetArray<N> randomArray(size_t n, uint64_t seed) {
+	TinyBitSetArray<N> sets(n);
+	uint64_t state = seed;
+	for (size_t j = 0; j < n; j++) {
+		for (int k = 0; k < N / 3; k++) {
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			sets[j].insert(int((state >> 33) % N) + 1);
+		}
+	}
+	return sets;
+}
+
+
+// every bulk operation against the same TinyBitSet operation set by set
+template <int N>
+bool matchesPerSet(size_t n) {
+	TinyBitSetArray<N> a = randomArray<N>(n, 1);
+	TinyBitSetArray<N> b = randomArray<N>(n, 2);
+	TinyBitSet<N> mask = randomArray<N>(1, 3)[0];
+
+	TinyBitSetArray<N> u = a.unionb(b);
+	TinyBitSetArray<N> i = a.intersectionb(b);
+	TinyBitSetArray<N> l = a.leftDifference(b);
+	TinyBitSetArray<N> r = a.rightDifference(b);
+	TinyBitSetArray<N> mu = a.unionb(mask);
+	TinyBitSetArray<N> mi = a.intersectionb(mask);
+	TinyBitSetArray<N> ml = a.leftDifference(mask);
+	TinyBitSetArray<N> mr = a.rightDifference(mask);
+	TinyBitSetArray<N> inplace = a;
+	inplace.intersectWith(mask);
+	inplace.unionWith(b);
+	inplace.removeEach(mask);
+
+	bool ok = (u.size() == n);
+	for (size_t j = 0; j < n; j++) {
+		ok = ok && (u[j] == a[j].unionb(b[j])) && (i[j] == a[j].intersectionb(b[j]))
+			 && (l[j] == a[j].leftDifference(b[j])) && (r[j] == a[j].rightDifference(b[j]))
+			 && (mu[j] == a[j].unionb(mask)) && (mi[j] == a[j].intersectionb(mask))
+			 && (ml[j] == a[j].leftDifference(mask)) && (mr[j] == a[j].rightDifference(mask))
+			 && (inplace[j] == a[j].intersectionb(mask).unionb(b[j]).leftDifference(mask));
+	}
+	return ok;
+}
+
+
+void testBulkOperations() {
+	// single words of each width, 2 words (pattern broadcast) and 3 words (set by set broadcast), with ragged tails
+	bool ok = matchesPerSet<5>(1003) && matchesPerSet<16>(77) && matchesPerSet<30>(1001) && matchesPerSet<64>(515)
+			  && matchesPerSet<128>(131) && matchesPerSet<192>(67) && matchesPerSet<64>(0);
+	if (ok) {
+		std::cout << "passed test: testBulkOperations" << std::endl;
+	} else {
+		std::cout << "failed test: testBulkOperations" << std::endl;
+	}
+	return;
+}
+
+
+template <int N>
+bool queriesMatch(size_t n) {
+	TinyBitSetArray<N> a = randomArray<N>(n, 7);
+	for (size_t j = 0; j < n; j += 5) {
+		a[j].removeall();
+	}
+	std::vector<int> sizes = a.getSetSizes();
+	std::vector<uint8_t> has = a.containsEach(N);
+	std::vector<uint8_t> hasFirst = a.containsEach(1);
+	std::vector<uint8_t> empty = a.isemptyEach();
+	bool ok = (sizes.size() == n);
+	for (size_t j = 0; j < n; j++) {
+		ok = ok && (sizes[j] == a[j].getSetSize()) && (bool(has[j]) == a[j].contains(N))
+			 && (bool(hasFirst[j]) == a[j].contains(1)) && (bool(empty[j]) == a[j].isempty());
+	}
+	return ok;
+}
+
+
+void testBulkQueries() {
+	bool ok = queriesMatch<8>(100) && queriesMatch<33>(99) && queriesMatch<64>(1027) && queriesMatch<200>(50);
+	if (ok) {
+		std::cout << "passed test: testBulkQueries" << std::endl;
+	} else {
+		std::cout << "failed test: testBulkQueries" << std::endl;
+	}
+	return;
+}
+
+
+template <int N>
+bool countsMatch(size_t n, int nthreads = 1) {
+	TinyBitSetArray<N> a = randomArray<N>(n, 11);
+	std::vector<uint64_t> want(N + 1, 0);
+	for (size_t j = 0; j < n; j++) {
+		for (int k : a[j]) {
+			want[k]++;
+		}
+	}
+	return (a.elementCounts(nthreads) == want) && (elementCounts(a.data(), n, nthreads) == want);
+}
+
+
+void testElementCounts() {
+	// whole 128 word blocks plus tails, narrow sets that share words, 3 words (counted set by set), and threads
+	bool ok = countsMatch<7>(3001) && countsMatch<16>(1025) && countsMatch<30>(999) && countsMatch<64>(2053)
+			  && countsMatch<128>(517) && countsMatch<192>(101) && countsMatch<512>(300) && countsMatch<64>(0)
+			  && countsMatch<64>(200003, 4) && countsMatch<20>(100001, 3);
+	// bits above MaxElems in raw reps are not elements, in the kernel's blocks or in the tail after them
+	for (size_t n : {size_t(3), size_t(1031)}) {
+		std::vector<TinyBitSet<5>> stray(n, TinyBitSet<5>(0xE1));
+		std::vector<TinyBitSet<20>> strayWide(n, TinyBitSet<20>(0xFFF80003u));
+		std::vector<uint64_t> want(6, 0);
+		std::vector<uint64_t> wantWide(21, 0);
+		want[1] = n;
+		wantWide[1] = n;
+		wantWide[2] = n;
+		wantWide[20] = n;
+		ok = ok && (elementCounts(stray.data(), n) == want) && (elementCounts(strayWide.data(), n) == wantWide);
+	}
+	if (ok) {
+		std::cout << "passed test: testElementCounts" << std::endl;
+	} else {
+		std::cout << "failed test: testElementCounts" << std::endl;
+	}
+	return;
+}
+
+
+// expressions of arrays against the same operators set by set, in the constructor, assignment and compound forms
+template <int N>
+bool expressionsMatch(size_t n) {
+	TinyBitSetArray<N> a = randomArray<N>(n, 4);
+	TinyBitSetArray<N> b = randomArray<N>(n, 5);
+	TinyBitSetArray<N> c = randomArray<N>(n, 6);
+	TinyBitSet<N> mask = randomArray<N>(1, 7)[0];
+
+	TinyBitSetArray<N> fused = (a | b) - (c & mask);
+	TinyBitSetArray<N> flipped;
+	flipped = ~(a ^ c) | (mask - tinybit::setSpan(b.data(), n));
+	TinyBitSetArray<N> compound = a;
+	compound &= b | c;
+	compound ^= mask;
+	compound -= c;
+	compound |= ~compound;   // the array itself on both sides
+	bool ok = (fused.size() == n) && (flipped.size() == n) && (compound.size() == n);
+	for (size_t j = 0; j < n; j++) {
+		ok = ok && (fused[j] == ((a[j] | b[j]) - (c[j] & mask))) && (flipped[j] == (~(a[j] ^ c[j]) | (mask - b[j])))
+			 && (compound[j] == ~TinyBitSet<N>());
+	}
+	return ok;
+}
+
+
+void testExpressions() {
+	bool ok = expressionsMatch<5>(1003) && expressionsMatch<16>(77) && expressionsMatch<64>(515) && expressionsMatch<128>(131)
+			  && expressionsMatch<192>(67) && expressionsMatch<64>(0);
+	if (ok) {
+		std::cout << "passed test: testExpressions" << std::endl;
+	} else {
+		std::cout << "failed test: testExpressions" << std::endl;
+	}
+	return;
+}
+
+
+void testSizeMismatchError() {
+	TinyBitSetArray<64> a(10);
+	TinyBitSetArray<64> b(11);
+	bool thrown = false;
+	try {
+		a.unionWith(b);
+	} catch (std::invalid_argument const &) {
+		thrown = true;
+	}
+	bool exprThrown = false;
+	try {
+		TinyBitSetArray<64> c = a | (b & a[0]);
+	} catch (std::invalid_argument const &) {
+		exprThrown = true;
+	}
+	bool boundsThrown = false;
+	try {
+		a.containsEach(65);
+	} catch (std::invalid_argument const &) {
+		boundsThrown = true;
+	}
+	if (thrown && exprThrown && boundsThrown) {
+		std::cout << "passed test: testSizeMismatchError" << std::endl;
+	} else {
+		std::cout << "failed test: testSizeMismatchError" << std::endl;
+	}
+	return;
+}
+
+
+
+int main() {
+	testBulkOperations();
+	testBulkQueries();
+	testElementCounts();
+	testExpressions();
+	testSizeMismatchError();
+	return 0;
+}
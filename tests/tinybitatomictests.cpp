@@ -0,0 +1,105 @@
+#include "../tinybitatomic.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+void testInsertRemovePrevious() {
+	AtomicTinyBitSet<64> t;
+	bool first = t.insert(64);
+	bool second = t.insert(64);
+	bool removed = t.remove(64);
+	bool removedAgain = t.remove(64);
+	t.insert(3);
+
+	if (!first && second && removed && !removedAgain && t.contains(3) && !t.contains(64) && (t.getSetSize() == 1)) {
+		std::cout << "passed test: testInsertRemovePrevious" << std::endl;
+	} else {
+		std::cout << "failed test: testInsertRemovePrevious, size:" << t.getSetSize() << std::endl;
+	}
+	return;
+}
+
+
+void testTryPop() {
+	TinyBitSet<16> init;
+	init.insert(4);
+	init.insert(9);
+	init.insert(16);
+	AtomicTinyBitSet<16> t(init);
+	int smallest = t.tryPopSmallest();
+	int largest = t.tryPopLargest();
+	int last = t.tryPopSmallest();
+	int none = t.tryPopSmallest();
+
+	if ((smallest == 4) && (largest == 16) && (last == 9) && (none == 0) && t.isempty() && AtomicTinyBitSet<16>::isLockFree()) {
+		std::cout << "passed test: testTryPop" << std::endl;
+	} else {
+		std::cout << "failed test: testTryPop, " << smallest << " " << largest << " " << last << std::endl;
+	}
+	return;
+}
+
+
+void testSnapshot() {
+	AtomicTinyBitSet<32> t;
+	t.fill();
+	t.remove(7);
+	TinyBitSet<32> snap = t.load();
+	TinyBitSet<32> replacement;
+	replacement.insert(1);
+	TinyBitSet<32> old = t.exchange(replacement);
+
+	if ((snap.getSetSize() == 31) && !snap.contains(7) && (old == snap) && (t.load() == replacement)) {
+		std::cout << "passed test: testSnapshot" << std::endl;
+	} else {
+		std::cout << "failed test: testSnapshot, size:" << snap.getSetSize() << std::endl;
+	}
+	return;
+}
+
+
+void testConcurrentClaims() {
+	// every slot is claimed by exactly one thread
+	AtomicTinyBitSet<64> freeSlots;
+	freeSlots.fill();
+	std::vector<std::vector<int>> claimed(4);
+	std::vector<std::thread> workers;
+	for (int w = 0; w < 4; w++) {
+		workers.emplace_back([&freeSlots, &claimed, w]() {
+			for (int slot = freeSlots.tryPopSmallest(); slot != 0; slot = freeSlots.tryPopSmallest()) {
+				claimed[w].push_back(slot);
+			}
+		});
+	}
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+
+	TinyBitSet<64> seen;
+	int total = 0;
+	bool unique = true;
+	for (std::vector<int> const &slots : claimed) {
+		for (int slot : slots) {
+			unique = unique && !seen.contains(slot);
+			seen.insert(slot);
+			total++;
+		}
+	}
+	if (unique && (total == 64) && freeSlots.isempty()) {
+		std::cout << "passed test: testConcurrentClaims" << std::endl;
+	} else {
+		std::cout << "failed test: testConcurrentClaims, total:" << total << std::endl;
+	}
+	return;
+}
+
+
+
+int main() {
+	testInsertRemovePrevious();
+	testTryPop();
+	testSnapshot();
+	testConcurrentClaims();
+	return 0;
+}
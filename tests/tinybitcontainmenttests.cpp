@@ -0,0 +1,155 @@
+#include "../tinybitcontainment.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+template <int N>
+std::vector<TinyBitSet<N>> randomSets(size_t n, int density, uint64_t seed) {
+	std::vector<TinyBitSet<N>> sets(n);
+	uint64_t state = seed;
+	for (size_t j = 0; j < n; j++) {
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		int count = int((state >> 33) % density);
+		for (int k = 0; k < count; k++) {
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			sets[j].insert(int((state >> 33) % N) + 1);
+		}
+	}
+	return sets;
+}
+
+
+// query results are not sorted
+std::vector<size_t> sorted(std::vector<size_t> ids) {
+	std::sort(ids.begin(), ids.end());
+	return ids;
+}
+
+
+// the ids a linear scan with leftDifference finds, among the ones still stored
+template <int N>
+bool queriesMatch(TinyBitContainmentIndex<N> const &index, std::vector<TinyBitSet<N>> const &stored, std::vector<bool> const &alive,
+				  std::vector<TinyBitSet<N>> const &queries) {
+	std::vector<std::vector<size_t>> subs = index.subsetsOf(queries.data(), queries.size(), 3);
+	std::vector<std::vector<size_t>> sups = index.supersetsOf(queries.data(), queries.size());
+	bool ok = (subs.size() == queries.size()) && (sups.size() == queries.size());
+	for (size_t qi = 0; qi < queries.size(); qi++) {
+		TinyBitSet<N> q = queries[qi];
+		std::vector<size_t> wantSubs;
+		std::vector<size_t> wantSups;
+		for (size_t id = 0; id < stored.size(); id++) {
+			TinyBitSet<N> s = stored[id];
+			if (alive[id] && s.leftDifference(q).isempty()) {
+				wantSubs.push_back(id);
+			}
+			if (alive[id] && q.leftDifference(s).isempty()) {
+				wantSups.push_back(id);
+			}
+		}
+		ok = ok && (sorted(index.subsetsOf(q)) == wantSubs) && (sorted(index.supersetsOf(q)) == wantSups) && (sorted(subs[qi]) == wantSubs)
+			 && (sorted(sups[qi]) == wantSups);
+	}
+	return ok;
+}
+
+
+template <int N>
+bool indexMatches(size_t n, int density) {
+	std::vector<TinyBitSet<N>> stored = randomSets<N>(n, density, 1);
+	// repeats, so some leaves burst into nodes that hold sets equal to their path
+	for (size_t j = 0; j < n; j += 4) {
+		stored[j] = stored[j % 40];
+	}
+	TinyBitContainmentIndex<N> index;
+	std::vector<bool> alive(n, true);
+	bool ok = true;
+	for (size_t id = 0; id < n; id++) {
+		ok = ok && (index.insert(stored[id]) == id);
+	}
+	// rule masks are sparse, fact sets are dense: small queries find supersets, large ones subsets
+	std::vector<TinyBitSet<N>> queries = randomSets<N>(20, N, 2);
+	std::vector<TinyBitSet<N>> sparse = randomSets<N>(20, 3, 3);
+	queries.insert(queries.end(), sparse.begin(), sparse.end());
+	queries.push_back(TinyBitSet<N>());
+	ok = ok && queriesMatch(index, stored, alive, queries);
+
+	// remove every third, reinsert some, which reuses the freed ids
+	for (size_t id = 0; id < n; id += 3) {
+		ok = ok && index.remove(id) && !index.remove(id) && !index.contains(id);
+		alive[id] = false;
+	}
+	for (size_t j = 0; j < n / 6; j++) {
+		size_t id = index.insert(stored[j]);
+		ok = ok && !alive[id] && (id % 3 == 0);
+		stored[id] = stored[j];
+		alive[id] = true;
+	}
+	size_t live = 0;
+	for (size_t id = 0; id < n; id++) {
+		live += alive[id] ? 1 : 0;
+		ok = ok && (!alive[id] || (index.get(id) == stored[id]));
+	}
+	ok = ok && (index.size() == live) && queriesMatch(index, stored, alive, queries);
+
+	// remove most of the rest, so the posting lists are compacted, then reuse those ids too
+	for (size_t id = 0; id < n; id++) {
+		if (alive[id] && (id % 4 != 0)) {
+			ok = ok && index.remove(id);
+			alive[id] = false;
+		}
+	}
+	for (size_t j = 0; j < n / 4; j++) {
+		size_t id = index.insert(stored[n - 1 - j]);
+		stored[id] = stored[n - 1 - j];
+		alive[id] = true;
+	}
+	return ok && queriesMatch(index, stored, alive, queries);
+}
+
+
+void testContainmentQueries() {
+	// narrow, single word and 2 word sets, sparse and dense, enough of them for several levels of bursts
+	bool ok = indexMatches<12>(300, 6) && indexMatches<64>(3000, 10) && indexMatches<64>(3000, 40)
+			  && indexMatches<128>(1000, 20) && indexMatches<5>(500, 4) && indexMatches<64>(0, 4);
+	if (ok) {
+		std::cout << "passed test: testContainmentQueries" << std::endl;
+	} else {
+		std::cout << "failed test: testContainmentQueries" << std::endl;
+	}
+	return;
+}
+
+
+void testContainmentErrors() {
+	TinyBitContainmentIndex<64> index;
+	index.insert(TinyBitSet<64>());
+	bool idThrown = false;
+	try {
+		index.remove(1);
+	} catch (std::invalid_argument const &) {
+		idThrown = true;
+	}
+	index.remove(0);
+	bool getThrown = false;
+	try {
+		index.get(0);
+	} catch (std::invalid_argument const &) {
+		getThrown = true;
+	}
+	if (idThrown && getThrown) {
+		std::cout << "passed test: testContainmentErrors" << std::endl;
+	} else {
+		std::cout << "failed test: testContainmentErrors" << std::endl;
+	}
+	return;
+}
+
+
+
+int main() {
+	testContainmentQueries();
+	testContainmentErrors();
+	return 0;
+}
@@ -0,0 +1,211 @@
+#include "../tinybitarray.h"
+#include "../tinybitdispatch.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+std::vector<uint64_t> randomWords(size_t n, uint64_t seed) {
+	std::vector<uint64_t> words(n);
+	uint64_t state = seed;
+	for (size_t i = 0; i < n; i++) {
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		words[i] = state ^ (state >> 29);
+	}
+	return words;
+}
+
+
+// every kernel of the active path against plain loops
+bool kernelsMatch() {
+	tinybit::Kernels const &k = tinybit::kernels();
+	std::vector<uint64_t> a = randomWords(203, 1);
+	std::vector<uint64_t> b = randomWords(203, 2);
+	bool ok = true;
+
+	uint64_t total = 0;
+	for (uint64_t x : a) {
+		int bits = 0;
+		for (int j = 0; j < 64; j++) {
+			bits += int((x >> j) & 1);
+		}
+		total += uint64_t(bits);
+		ok = ok && (k.popcount(x) == bits);
+		// pext gathers the mask's bits, pdep scatters them back
+		uint64_t mask = x;
+		uint64_t packed = k.pext(b[0], mask);
+		ok = ok && (packed >> bits == 0 || bits == 64) && (k.pdep(packed, mask) == (b[0] & mask));
+	}
+	ok = ok && (k.popcountWords(a.data(), a.size()) == total) && (k.popcountWords(a.data(), 0) == 0);
+
+	// every set width over the same bytes, with tails that miss the vector loops
+	for (size_t setBytes : {size_t(1), size_t(2), size_t(4), size_t(8), size_t(16), size_t(24)}) {
+		size_t n = (a.size() * 8) / setBytes - 1;
+		std::vector<int> counts(n);
+		std::vector<int> common(n);
+		std::vector<int> combined(n);
+		k.popcountEach(counts.data(), a.data(), n, setBytes);
+		k.overlapCounts(common.data(), combined.data(), a.data(), n, setBytes, b.data());
+		unsigned char const *bytes = reinterpret_cast<unsigned char const *>(a.data());
+		unsigned char const *query = reinterpret_cast<unsigned char const *>(b.data());
+		for (size_t i = 0; i < n; i++) {
+			int want = 0;
+			int wantCommon = 0;
+			int wantCombined = 0;
+			for (size_t j = 0; j < setBytes; j++) {
+				want += __builtin_popcount(bytes[setBytes * i + j]);
+				wantCommon += __builtin_popcount(bytes[setBytes * i + j] & query[j]);
+				wantCombined += __builtin_popcount(bytes[setBytes * i + j] | query[j]);
+			}
+			ok = ok && (counts[i] == want) && (common[i] == wantCommon) && (combined[i] == wantCombined);
+		}
+	}
+
+	// 9 x 13 single word sets, into rows of 15
+	std::vector<int> joined(9 * 15, -1);
+	k.joinCounts(joined.data(), 15, a.data(), 9, b.data(), 13, 8);
+	for (size_t i = 0; i < 9; i++) {
+		for (size_t j = 0; j < 15; j++) {
+			ok = ok && (joined[i * 15 + j] == ((j < 13) ? __builtin_popcountll(a[i] & b[j]) : -1));
+		}
+	}
+
+	// a stream longer than one 128 word block, counted bit by bit
+	std::vector<uint64_t> lanes(512, 0);
+	std::vector<uint64_t> wantLanes(512, 0);
+	k.positionCounts(lanes.data(), a.data(), a.size());
+	for (size_t i = 0; i < a.size(); i++) {
+		for (int j = 0; j < 64; j++) {
+			wantLanes[64 * (i % 8) + j] += (a[i] >> j) & 1;
+		}
+	}
+	ok = ok && (lanes == wantLanes);
+
+	// two groups of 8 blocks at every width: word c of block l gets bit c of its rows, row r at bit r
+	std::vector<uint64_t> matrix = randomWords(16 * 64, 3);
+	for (int width : {8, 16, 32, 64}) {
+		std::vector<uint64_t> blocks(matrix.begin(), matrix.begin() + 16 * width);
+		k.transposeBits(blocks.data(), 2, width);
+		for (size_t l = 0; l < 16; l++) {
+			uint64_t const *in = matrix.data() + (l / 8) * 8 * width + (l % 8);
+			uint64_t const *out = blocks.data() + (l / 8) * 8 * width + (l % 8);
+			for (int r = 0; r < 64; r++) {
+				uint64_t row = in[8 * (r % width)] >> ((r / width) * width);
+				for (int c = 0; c < width; c++) {
+					ok = ok && (((out[8 * c] >> r) & 1) == ((row >> c) & 1));
+				}
+			}
+		}
+	}
+
+	for (int op = 0; op < 4; op++) {
+		size_t bytes = a.size() * 8 - 3;
+		std::vector<unsigned char> out(bytes);
+		unsigned char const *pa = reinterpret_cast<unsigned char const *>(a.data());
+		unsigned char const *pb = reinterpret_cast<unsigned char const *>(b.data());
+		k.bitBytes[op](out.data(), pa, pb, ~size_t(0), bytes);
+		for (size_t i = 0; i < bytes; i++) {
+			unsigned char want = (op == 0) ? (pa[i] | pb[i]) : (op == 1) ? (pa[i] & pb[i])
+							   : (op == 2) ? (pa[i] & ~pb[i]) : (~pa[i] & pb[i]);
+			ok = ok && (out[i] == want);
+		}
+	}
+	return ok;
+}
+
+
+void testEveryPath() {
+	bool ok = true;
+	int tried = 0;
+	for (TinyBitPath path : {TinyBitPath::Scalar, TinyBitPath::Popcnt, TinyBitPath::AVX2, TinyBitPath::AVX512}) {
+		if (tinybit::pathSupported(path)) {
+			tinybit::forcePath(path);
+			ok = ok && (tinybit::activePath() == path) && kernelsMatch();
+			tried++;
+		}
+	}
+	tinybit::resetPath();
+	if (ok && (tried >= 1) && tinybit::pathSupported(tinybit::bestPath())) {
+		std::cout << "passed test: testEveryPath" << std::endl;
+	} else {
+		std::cout << "failed test: testEveryPath, paths tried:" << tried << std::endl;
+	}
+	return;
+}
+
+
+void testSetsAgreeAcrossPaths() {
+	// TinyBitSet and TinyBitSetArray give the same answers on every path
+	TinyBitSetArray<64> rows(1001);
+	TinyBitSetArray<256> wide(33);
+	std::vector<uint64_t> words = randomWords(1001 + 33 * 4, 9);
+	for (size_t i = 0; i < rows.size(); i++) {
+		rows[i] = TinyBitSet<64>(words[i]);
+	}
+	for (size_t i = 0; i < wide.size(); i++) {
+		for (int j = 1; j <= 256; j += int(words[1001 + i] % 7) + 1) {
+			wide[i].insert(j);
+		}
+	}
+	TinyBitSet<64> mask(0x0f0f0f0f0f0f0f0full);
+
+	tinybit::forcePath(TinyBitPath::Scalar);
+	std::vector<int> sizes = rows.getSetSizes();
+	std::vector<int> wideSizes = wide.getSetSizes();
+	TinyBitSetArray<64> masked = rows.leftDifference(mask);
+	int selected = rows[7].select(20);
+
+	bool same = true;
+	for (TinyBitPath path : {TinyBitPath::Popcnt, TinyBitPath::AVX2, TinyBitPath::AVX512}) {
+		if (!tinybit::pathSupported(path)) {
+			continue;
+		}
+		tinybit::forcePath(path);
+		TinyBitSetArray<64> again = rows.leftDifference(mask);
+		bool rowsSame = true;
+		for (size_t i = 0; i < rows.size(); i++) {
+			rowsSame = rowsSame && (again[i] == masked[i]) && (rows[i].getSetSize() == sizes[i]);
+		}
+		same = same && rowsSame && (rows.getSetSizes() == sizes) && (wide.getSetSizes() == wideSizes)
+			   && (wide[3].getSetSize() == wideSizes[3]) && (rows[7].select(20) == selected);
+	}
+	tinybit::resetPath();
+	if (same) {
+		std::cout << "passed test: testSetsAgreeAcrossPaths" << std::endl;
+	} else {
+		std::cout << "failed test: testSetsAgreeAcrossPaths" << std::endl;
+	}
+	return;
+}
+
+
+void testUnsupportedPathError() {
+	// forcing a path the cpu lacks throws instead of faulting later; scalar is always there
+	bool ok = tinybit::pathSupported(TinyBitPath::Scalar);
+	for (TinyBitPath path : {TinyBitPath::Popcnt, TinyBitPath::AVX2, TinyBitPath::AVX512}) {
+		if (!tinybit::pathSupported(path)) {
+			bool thrown = false;
+			try {
+				tinybit::forcePath(path);
+			} catch (std::invalid_argument const &) {
+				thrown = true;
+			}
+			ok = ok && thrown;
+		}
+	}
+	if (ok) {
+		std::cout << "passed test: testUnsupportedPathError" << std::endl;
+	} else {
+		std::cout << "failed test: testUnsupportedPathError" << std::endl;
+	}
+	return;
+}
+
+
+
+int main() {
+	testEveryPath();
+	testSetsAgreeAcrossPaths();
+	testUnsupportedPathError();
+	return 0;
+}
@@ -0,0 +1,232 @@
+#include "../tinybitgraph.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+// n vertices, each edge (or arc) present with probability percent / 100
+template <int N>
+TinyBitGraph<N> randomGraph(int n, int percent, bool directed, uint64_t seed) {
+	TinyBitGraph<N> g(n);
+	uint64_t state = seed;
+	for (int u = 1; u <= n; u++) {
+		for (int v = directed ? 1 : u + 1; v <= n; v++) {
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			if ((u != v) && (int((state >> 33) % 100) < percent)) {
+				if (directed) {
+					g.addArc(u, v);
+				} else {
+					g.addEdge(u, v);
+				}
+			}
+		}
+	}
+	return g;
+}
+
+
+// reachability, distances and closure of a directed graph against a plain queue BFS and Floyd-Warshall on bools
+template <int N>
+bool pathsMatch(int n, int percent, uint64_t seed) {
+	TinyBitGraph<N> g = randomGraph<N>(n, percent, true, seed);
+	TinyBitGraph<N> closure = g.transitiveClosure();
+	std::vector<std::vector<bool>> path(n + 1, std::vector<bool>(n + 1, false));
+	for (int u = 1; u <= n; u++) {
+		for (int v = 1; v <= n; v++) {
+			path[u][v] = g.hasArc(u, v);
+		}
+	}
+	for (int k = 1; k <= n; k++) {
+		for (int i = 1; i <= n; i++) {
+			for (int j = 1; j <= n; j++) {
+				path[i][j] = path[i][j] || (path[i][k] && path[k][j]);
+			}
+		}
+	}
+	bool ok = true;
+	for (int s = 1; s <= n; s++) {
+		std::vector<int> dist(n + 1, -1);
+		std::vector<int> queue = {s};
+		dist[s] = 0;
+		for (size_t q = 0; q < queue.size(); q++) {
+			for (int v = 1; v <= n; v++) {
+				if (g.hasArc(queue[q], v) && (dist[v] < 0)) {
+					dist[v] = dist[queue[q]] + 1;
+					queue.push_back(v);
+				}
+			}
+		}
+		TinyBitSet<N> reached;
+		TinyBitSet<N> paths;
+		for (int v = 1; v <= n; v++) {
+			if (dist[v] >= 0) {
+				reached.insert(v);
+			}
+			if (path[s][v]) {
+				paths.insert(v);
+			}
+		}
+		std::array<int, N + 1> got = g.distancesFrom(s);
+		ok = ok && std::equal(dist.begin(), dist.end(), got.begin()) && (g.reachableFrom(s) == reached) && (closure.neighbours(s) == paths);
+	}
+	return ok;
+}
+
+
+// cliques against every subset (n <= 16), colourings checked proper, greedy against first fit, components against reachability
+template <int N>
+bool undirectedMatch(int n, int percent, uint64_t seed) {
+	TinyBitGraph<N> g = randomGraph<N>(n, percent, false, seed);
+	int omega = 0;
+	for (uint32_t s = 0; s < (uint32_t(1) << n); s++) {
+		bool clique = true;
+		for (int u = 1; u <= n && clique; u++) {
+			for (int v = u + 1; v <= n && clique; v++) {
+				clique = !((s >> (u - 1)) & 1) || !((s >> (v - 1)) & 1) || g.hasArc(u, v);
+			}
+		}
+		omega = (clique && (__builtin_popcount(s) > omega)) ? __builtin_popcount(s) : omega;
+	}
+	TinyBitSet<N> best = g.maximumClique();
+	bool ok = (best.getSetSize() == omega);
+	for (int u : best) {
+		ok = ok && ((g.neighbours(u) & best).getSetSize() == best.getSetSize() - 1);
+	}
+	int maximal = 0;
+	g.forEachMaximalClique([&](TinyBitSet<N> const &c) {
+		maximal++;
+		for (int u : c) {
+			ok = ok && ((g.neighbours(u) & c).getSetSize() == c.getSetSize() - 1);
+		}
+		// nothing outside c is adjacent to all of it
+		for (int v = 1; v <= n; v++) {
+			ok = ok && (c.contains(v) || ((g.neighbours(v) & c) != c));
+		}
+	});
+	ok = ok && ((n == 0) ? (maximal == 0) : (maximal >= 1));
+
+	TinyBitColoring<N> greedy = g.greedyColoring();
+	TinyBitColoring<N> dsatur = g.dsaturColoring();
+	std::vector<int> firstFit(n + 1, 0);
+	int firstFitCount = 0;
+	for (int v = 1; v <= n; v++) {
+		std::vector<bool> used(n + 2, false);
+		for (int u = 1; u < v; u++) {
+			if (g.hasArc(v, u)) {
+				used[firstFit[u]] = true;
+			}
+		}
+		firstFit[v] = 1;
+		while (used[firstFit[v]]) {
+			firstFit[v]++;
+		}
+		firstFitCount = (firstFit[v] > firstFitCount) ? firstFit[v] : firstFitCount;
+	}
+	ok = ok && (greedy.count == firstFitCount) && (dsatur.count >= omega);
+	for (int u = 1; u <= n; u++) {
+		ok = ok && (greedy.of[u] == firstFit[u]) && (dsatur.of[u] >= 1) && (dsatur.of[u] <= dsatur.count);
+		for (int v : g.neighbours(u)) {
+			ok = ok && (dsatur.of[u] != dsatur.of[v]);
+		}
+	}
+
+	TinyBitComponents<N> comps = g.components();
+	for (int u = 1; u <= n; u++) {
+		for (int v = 1; v <= n; v++) {
+			ok = ok && ((comps.of[u] == comps.of[v]) == g.reachableFrom(u).contains(v));
+		}
+		ok = ok && (comps.of[u] >= 1) && (comps.of[u] <= comps.count);
+	}
+	return ok;
+}
+
+
+void testPaths() {
+	bool ok = pathsMatch<64>(40, 5, 1) && pathsMatch<64>(64, 2, 2) && pathsMatch<20>(17, 10, 3) && pathsMatch<100>(90, 2, 4)
+			  && pathsMatch<8>(8, 30, 5);
+	if (ok) {
+		std::cout << "passed test: testPaths" << std::endl;
+	} else {
+		std::cout << "failed test: testPaths" << std::endl;
+	}
+	return;
+}
+
+
+void testCliquesColoringsComponents() {
+	bool ok = true;
+	for (int percent : {10, 30, 60, 90}) {
+		ok = ok && undirectedMatch<64>(16, percent, uint64_t(percent)) && undirectedMatch<16>(13, percent, uint64_t(percent) + 1)
+			 && undirectedMatch<128>(15, percent, uint64_t(percent) + 2);
+	}
+	ok = ok && undirectedMatch<64>(0, 50, 1) && undirectedMatch<64>(1, 50, 1);
+	if (ok) {
+		std::cout << "passed test: testCliquesColoringsComponents" << std::endl;
+	} else {
+		std::cout << "failed test: testCliquesColoringsComponents" << std::endl;
+	}
+	return;
+}
+
+
+void testBatch() {
+	std::vector<TinyBitGraph<64>> graphs;
+	for (uint64_t s = 0; s < 200; s++) {
+		graphs.push_back(randomGraph<64>(30 + int(s % 30), 40, false, s));
+	}
+	auto cliques = mapGraphs(graphs.data(), graphs.size(), [](TinyBitGraph<64> const &g) { return g.maximumClique(); }, 4);
+	std::vector<int> colors(graphs.size());
+	mapGraphs(colors.data(), graphs.data(), graphs.size(), [](TinyBitGraph<64> const &g) { return g.dsaturColoring().count; });
+	bool ok = (cliques.size() == graphs.size());
+	for (size_t i = 0; i < graphs.size(); i++) {
+		ok = ok && (cliques[i] == graphs[i].maximumClique()) && (colors[i] >= cliques[i].getSetSize());
+	}
+	if (ok) {
+		std::cout << "passed test: testBatch" << std::endl;
+	} else {
+		std::cout << "failed test: testBatch" << std::endl;
+	}
+	return;
+}
+
+
+void testGraphErrors() {
+	int caught = 0;
+	TinyBitGraph<64> g(10);
+	try {
+		g.addEdge(3, 11);
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	try {
+		TinyBitGraph<64> big(65);
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	std::vector<TinyBitSet<64>> rows(5);
+	rows[2].insert(6);
+	try {
+		TinyBitGraph<64> fromRows(rows.data(), 5);
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	rows[2].remove(6);
+	rows[2].insert(5);
+	TinyBitGraph<64> fromRows(rows.data(), 5);
+	if ((caught == 3) && fromRows.hasArc(3, 5) && !fromRows.hasArc(5, 3) && (fromRows.degree(3) == 1)) {
+		std::cout << "passed test: testGraphErrors" << std::endl;
+	} else {
+		std::cout << "failed test: testGraphErrors, caught:" << caught << std::endl;
+	}
+	return;
+}
+
+
+int main() {
+	testPaths();
+	testCliquesColoringsComponents();
+	testBatch();
+	testGraphErrors();
+	return 0;
+}
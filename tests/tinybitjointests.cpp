@@ -0,0 +1,81 @@
+#include "../tinybitjoin.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+template <int N>
+std::vector<TinyBitSet<N>> randomSets(size_t n, uint64_t seed) {
+	std::vector<TinyBitSet<N>> sets(n);
+	uint64_t state = seed;
+	for (size_t j = 0; j < n; j++) {
+		for (int k = 0; k < N / 4; k++) {
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			sets[j].insert(int((state >> 33) % N) + 1);
+		}
+	}
+	return sets;
+}
+
+
+// the dense matrix and the pair list against intersectionb per pair
+template <int N>
+bool joinMatches(size_t na, size_t nb, int minCommon, int nthreads = 1) {
+	std::vector<TinyBitSet<N>> a = randomSets<N>(na, 1);
+	std::vector<TinyBitSet<N>> b = randomSets<N>(nb, 2);
+	std::vector<int> counts = intersectionCounts(a.data(), na, b.data(), nb, nthreads);
+	std::vector<TinyBitPair> pairs = intersectingPairs(a.data(), na, b.data(), nb, minCommon, nthreads);
+	bool ok = (counts.size() == na * nb);
+	size_t p = 0;
+	for (size_t i = 0; i < na; i++) {
+		for (size_t j = 0; j < nb; j++) {
+			int want = a[i].intersectionb(b[j]).getSetSize();
+			ok = ok && (counts[i * nb + j] == want);
+			if (want >= minCommon) {
+				ok = ok && (p < pairs.size()) && (pairs[p].a == i) && (pairs[p].b == j) && (pairs[p].common == want);
+				p++;
+			}
+		}
+	}
+	return ok && (p == pairs.size());
+}
+
+
+void testJoin() {
+	// widths that take the vector kernels and the ones that don't, b spanning several L1 tiles,
+	// a spanning several blocks, and a threaded join
+	bool ok = joinMatches<8>(37, 51, 1) && joinMatches<20>(40, 33, 3) && joinMatches<64>(67, 5001, 14)
+			  && joinMatches<64>(33000, 9, 12) && joinMatches<128>(21, 301, 8) && joinMatches<192>(13, 17, 10)
+			  && joinMatches<64>(0, 10, 1) && joinMatches<64>(10, 0, 1) && joinMatches<64>(1200, 1100, 15, 4);
+	if (ok) {
+		std::cout << "passed test: testJoin" << std::endl;
+	} else {
+		std::cout << "failed test: testJoin" << std::endl;
+	}
+	return;
+}
+
+
+void testCallerBuffer() {
+	// rows land at i * nb, nothing outside the na * nb entries is written
+	std::vector<TinyBitSet<64>> a = randomSets<64>(3, 4);
+	std::vector<TinyBitSet<64>> b = randomSets<64>(11, 5);
+	std::vector<int> out(3 * 11 + 1, -7);
+	intersectionCounts(out.data(), a.data(), a.size(), b.data(), b.size());
+	bool ok = (out[3 * 11] == -7) && (out[2 * 11 + 10] == a[2].intersectionb(b[10]).getSetSize())
+			  && (out[1 * 11 + 3] == a[1].intersectionb(b[3]).getSetSize());
+	if (ok) {
+		std::cout << "passed test: testCallerBuffer" << std::endl;
+	} else {
+		std::cout << "failed test: testCallerBuffer" << std::endl;
+	}
+	return;
+}
+
+
+
+int main() {
+	testJoin();
+	testCallerBuffer();
+	return 0;
+}
@@ -0,0 +1,155 @@
+#include "../tinybitmap.h"
+#include <iostream>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+
+void testStdHash() {
+	std::unordered_set<TinyBitSet<64>> seen;
+	TinyBitSet<64> a;
+	a.insert(1);
+	TinyBitSet<64> b;
+	b.insert(2);
+	seen.insert(a);
+	seen.insert(b);
+	seen.insert(a);
+
+	TinyBitSet<200> wide1;
+	wide1.insert(150);
+	TinyBitSet<200> wide2;
+	wide2.insert(1);
+	std::hash<TinyBitSet<200>> widehash;
+
+	if ((seen.size() == 2) && (std::hash<TinyBitSet<64>>()(a) != std::hash<TinyBitSet<64>>()(b))
+		&& (widehash(wide1) != widehash(wide2)) && (widehash(wide1) == widehash(TinyBitSet<200>(wide1.getBitInt())))) {
+		std::cout << "passed test: testStdHash" << std::endl;
+	} else {
+		std::cout << "failed test: testStdHash, size:" << seen.size() << std::endl;
+	}
+	return;
+}
+
+
+void testOrdering() {
+	std::map<TinyBitSet<16>, int> ordered;
+	TinyBitSet<16> a;
+	a.insert(16);
+	TinyBitSet<16> b;
+	b.insert(1);
+	b.insert(2);
+	ordered[a] = 1;
+	ordered[b] = 2;
+
+	TinyBitSet<130> wlow;
+	wlow.insert(64);
+	TinyBitSet<130> whigh;
+	whigh.insert(65);
+	if ((ordered.begin()->second == 2) && (b < a) && !(a < b) && !(a < a) && (wlow < whigh) && !(whigh < wlow)) {
+		std::cout << "passed test: testOrdering" << std::endl;
+	} else {
+		std::cout << "failed test: testOrdering" << std::endl;
+	}
+	return;
+}
+
+
+void testMapInsertFind() {
+	TinyBitSetMap<32, int> memo;
+	for (int i = 1; i <= 32; i++) {
+		for (int j = i; j <= 32; j++) {
+			TinyBitSet<32> key;
+			key.insert(i);
+			key.insert(j);
+			memo[key] = 100 * i + j;
+		}
+	}
+
+	bool found = true;
+	for (int i = 1; i <= 32; i++) {
+		for (int j = i; j <= 32; j++) {
+			TinyBitSet<32> key;
+			key.insert(i);
+			key.insert(j);
+			int const *v = memo.find(key);
+			found = found && (v != nullptr) && (*v == 100 * i + j);
+		}
+	}
+	TinyBitSet<32> missing;
+	missing.insertRange(1, 3);
+
+	bool inserted = memo.insert(missing, 7);
+	bool reinserted = memo.insert(missing, 8);
+	if (found && (memo.size() == 529) && inserted && !reinserted && (*memo.find(missing) == 7)) {
+		std::cout << "passed test: testMapInsertFind" << std::endl;
+	} else {
+		std::cout << "failed test: testMapInsertFind, size:" << memo.size() << std::endl;
+	}
+	return;
+}
+
+
+void testMapErase() {
+	TinyBitSetMap<64, long> m;
+	std::vector<TinyBitSet<64>> keys;
+	for (int i = 1; i <= 64; i++) {
+		TinyBitSet<64> key;
+		key.insertRange(1, i);
+		keys.push_back(key);
+		m[key] = i;
+	}
+	// churn through many erase/insert rounds so tombstones force same-size rebuilds
+	for (int round = 0; round < 50; round++) {
+		for (int i = 0; i < 64; i += 2) {
+			m.erase(keys[i]);
+		}
+		for (int i = 0; i < 64; i += 2) {
+			m[keys[i]] = i + 1;
+		}
+	}
+	bool erased = m.erase(keys[5]);
+	bool erasedAgain = m.erase(keys[5]);
+
+	long total = 0;
+	m.forEach([&total](TinyBitSet<64> const &, long v) { total += v; });
+	if (erased && !erasedAgain && (m.size() == 63) && !m.contains(keys[5]) && m.contains(keys[6]) && (total == 2080 - 6)) {
+		std::cout << "passed test: testMapErase" << std::endl;
+	} else {
+		std::cout << "failed test: testMapErase, size:" << m.size() << " total:" << total << std::endl;
+	}
+	return;
+}
+
+
+void testSet() {
+	TinyBitSetSet<300> s;
+	s.reserve(1000);
+	for (int i = 1; i <= 300; i++) {
+		TinyBitSet<300> key;
+		key.insert(i);
+		s.insert(key);
+	}
+	TinyBitSet<300> one;
+	one.insert(1);
+	bool again = s.insert(one);
+	s.erase(one);
+	int count = 0;
+	s.forEach([&count](TinyBitSet<300> const &) { count++; });
+	if (!again && (s.size() == 299) && (count == 299) && !s.contains(one)) {
+		std::cout << "passed test: testSet" << std::endl;
+	} else {
+		std::cout << "failed test: testSet, size:" << s.size() << std::endl;
+	}
+	return;
+}
+
+
+
+int main() {
+	testStdHash();
+	testOrdering();
+	testMapInsertFind();
+	testMapErase();
+	testSet();
+	return 0;
+}
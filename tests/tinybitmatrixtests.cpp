@@ -0,0 +1,161 @@
+#include "../tinybitmatrix.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+// each pair present with probability 1 / sparsity
+template <int N>
+TinyBitMatrix<N> randomMatrix(int sparsity, uint64_t seed) {
+	TinyBitMatrix<N> m;
+	uint64_t state = seed;
+	for (int i = 1; i <= N; i++) {
+		for (int j = 1; j <= N; j++) {
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			if ((state >> 33) % sparsity == 0) {
+				m.insert(i, j);
+			}
+		}
+	}
+	return m;
+}
+
+
+template <int N>
+TinyBitMatrix<N> multiplyByContains(TinyBitMatrix<N> const &a, TinyBitMatrix<N> const &b) {
+	TinyBitMatrix<N> c;
+	for (int i = 1; i <= N; i++) {
+		for (int j = 1; j <= N; j++) {
+			for (int k = 1; k <= N; k++) {
+				if (a.contains(i, k) && b.contains(k, j)) {
+					c.insert(i, j);
+					break;
+				}
+			}
+		}
+	}
+	return c;
+}
+
+
+template <int N>
+TinyBitMatrix<N> closureByContains(TinyBitMatrix<N> const &relation) {
+	TinyBitMatrix<N> m = relation;
+	for (int k = 1; k <= N; k++) {
+		for (int i = 1; i <= N; i++) {
+			for (int j = 1; j <= N; j++) {
+				if (m.contains(i, k) && m.contains(k, j)) {
+					m.insert(i, j);
+				}
+			}
+		}
+	}
+	return m;
+}
+
+
+// products, closure and transpose of random matrices against the contains loops, dense and sparse
+template <int N>
+bool matricesMatch(uint64_t seed) {
+	bool ok = true;
+	for (int sparsity : {2, 5, N}) {
+		TinyBitMatrix<N> a = randomMatrix<N>(sparsity, seed);
+		TinyBitMatrix<N> b = randomMatrix<N>(sparsity, seed + 1);
+		TinyBitMatrix<N> expected = multiplyByContains(a, b);
+		ok = ok && ((a * b) == expected);
+		// in place, and over plain rows
+		TinyBitMatrix<N> c = a;
+		c *= b;
+		std::vector<TinyBitSet<N>> rows(a.data(), a.data() + N);
+		multiplyRows(rows.data(), rows.data(), b.data());
+		ok = ok && (c == expected) && (TinyBitMatrix<N>(rows.data()) == expected);
+		ok = ok && ((TinyBitMatrix<N>::identity() * a) == a) && ((a * TinyBitMatrix<N>::identity()) == a);
+
+		TinyBitMatrix<N> sparse = randomMatrix<N>(2 * N, seed + 2);
+		ok = ok && (sparse.transitiveClosure() == closureByContains(sparse)) && (a.transitiveClosure() == closureByContains(a));
+
+		TinyBitMatrix<N> t = a.transpose();
+		for (int i = 1; i <= N; i++) {
+			for (int j = 1; j <= N; j++) {
+				ok = ok && (t.contains(j, i) == a.contains(i, j));
+			}
+		}
+		ok = ok && (t.transpose() == a) && ((a | b) == (b | a));
+	}
+	return ok;
+}
+
+
+void testMultiply() {
+	bool ok = matricesMatch<5>(1) && matricesMatch<8>(2) && matricesMatch<13>(3) && matricesMatch<32>(4) && matricesMatch<64>(5)
+			  && matricesMatch<100>(6) && matricesMatch<256>(7) && matricesMatch<300>(8);
+	if (ok) {
+		std::cout << "passed test: testMultiply" << std::endl;
+	} else {
+		std::cout << "failed test: testMultiply" << std::endl;
+	}
+	return;
+}
+
+
+void testBatchMultiply() {
+	size_t count = 300;
+	std::vector<TinyBitMatrix<64>> a;
+	std::vector<TinyBitMatrix<64>> b;
+	for (size_t m = 0; m < count; m++) {
+		a.push_back(randomMatrix<64>(int(m % 40) + 2, m));
+		b.push_back(randomMatrix<64>(int(m % 30) + 2, m + count));
+	}
+	std::vector<TinyBitMatrix<64>> products(count);
+	std::vector<TinyBitMatrix<64>> closures(count);
+	multiplyAll(products.data(), a.data(), b.data(), count, 4);
+	transitiveClosureAll(closures.data(), a.data(), count, 4);
+	bool ok = true;
+	for (size_t m = 0; m < count; m++) {
+		ok = ok && (products[m] == a[m] * b[m]) && (closures[m] == a[m].transitiveClosure());
+	}
+	// in place, one thread
+	multiplyAll(a.data(), a.data(), b.data(), count);
+	ok = ok && (a == products);
+	if (ok) {
+		std::cout << "passed test: testBatchMultiply" << std::endl;
+	} else {
+		std::cout << "failed test: testBatchMultiply" << std::endl;
+	}
+	return;
+}
+
+
+void testMatrixErrors() {
+	int caught = 0;
+	TinyBitMatrix<64> m;
+	try {
+		m.insert(0, 3);
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	try {
+		m.insert(3, 65);
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	try {
+		m.row(65);
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	if (caught == 3) {
+		std::cout << "passed test: testMatrixErrors" << std::endl;
+	} else {
+		std::cout << "failed test: testMatrixErrors, caught:" << caught << std::endl;
+	}
+	return;
+}
+
+
+int main() {
+	testMultiply();
+	testBatchMultiply();
+	testMatrixErrors();
+	return 0;
+}
@@ -0,0 +1,154 @@
+#include "../tinybitpermutation.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+template <int N>
+std::vector<int> randomImages(uint64_t seed) {
+	std::vector<int> images(N);
+	for (int i = 0; i < N; i++) {
+		images[i] = i + 1;
+	}
+	uint64_t state = seed;
+	for (int i = N - 1; i > 0; i--) {
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		std::swap(images[i], images[(state >> 33) % (i + 1)]);
+	}
+	return images;
+}
+
+
+// p(s) against mapping element by element, for sparse, dense, empty and full sets, and the inverse and composition
+template <int N>
+bool permutationMatches(uint64_t seed) {
+	std::vector<int> images = randomImages<N>(seed);
+	TinyBitPermutation<N> p(images);
+	TinyBitPermutation<N> q(randomImages<N>(seed + 1));
+	std::vector<TinyBitSet<N>> sets(40);
+	uint64_t state = seed;
+	for (size_t k = 0; k < sets.size(); k++) {
+		for (int i = 1; i <= N; i++) {
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			if ((state >> 33) % (k % 5 + 1) == 0) {
+				sets[k].insert(i);
+			}
+		}
+	}
+	sets[0].removeall();
+	sets[1].fill();
+	std::vector<TinyBitSet<N>> mapped(sets.size());
+	p.apply(mapped.data(), sets.data(), sets.size());
+	bool ok = true;
+	for (size_t k = 0; k < sets.size(); k++) {
+		TinyBitSet<N> expected;
+		for (int i : sets[k]) {
+			expected.insert(images[i - 1]);
+		}
+		ok = ok && (p(sets[k]) == expected) && (mapped[k] == expected) && (p.inverse()(expected) == sets[k])
+			 && (p.then(q)(sets[k]) == q(p(sets[k])));
+	}
+	for (int i = 1; i <= N; i++) {
+		ok = ok && (p(i) == images[i - 1]) && (p.inverse()(p(i)) == i);
+	}
+	// in place
+	p.apply(sets.data(), sets.data(), sets.size());
+	return ok && (sets == mapped) && (p.then(p.inverse()) == TinyBitPermutation<N>()) && (TinyBitPermutation<N>()(sets[5]) == sets[5]);
+}
+
+
+void testPermutations() {
+	bool ok = permutationMatches<5>(1) && permutationMatches<8>(2) && permutationMatches<13>(3) && permutationMatches<32>(4)
+			  && permutationMatches<64>(5) && permutationMatches<65>(6) && permutationMatches<128>(7) && permutationMatches<300>(8);
+	if (ok) {
+		std::cout << "passed test: testPermutations" << std::endl;
+	} else {
+		std::cout << "failed test: testPermutations" << std::endl;
+	}
+	return;
+}
+
+
+// the rotations and reflections of a 4 x 4 grid: every set in an orbit gets the same canonical form
+void testCanonicalForm() {
+	std::vector<TinyBitPermutation<16>> group;
+	for (int t = 1; t < 8; t++) {
+		std::vector<int> images(16);
+		for (int r = 0; r < 4; r++) {
+			for (int c = 0; c < 4; c++) {
+				int rr = r;
+				int cc = c;
+				for (int k = 0; k < t % 4; k++) {
+					int turned = cc;
+					cc = 3 - rr;
+					rr = turned;
+				}
+				if (t >= 4) {
+					cc = 3 - cc;
+				}
+				images[4 * r + c] = 4 * rr + cc + 1;
+			}
+		}
+		group.push_back(TinyBitPermutation<16>(images));
+	}
+	bool ok = true;
+	size_t classes = 0;
+	for (uint32_t bits = 0; bits < (1u << 16); bits++) {
+		TinyBitSet<16> s(static_cast<uint16_t>(bits));
+		TinyBitSet<16> canonical = canonicalForm(s, group.data(), group.size());
+		classes += (canonical == s);
+		for (TinyBitPermutation<16> const &p : group) {
+			ok = ok && (canonicalForm(p(s), group.data(), group.size()) == canonical) && !(s < canonical);
+		}
+	}
+	// Burnside: 8548 two-colourings of a 4 x 4 grid up to the dihedral group
+	if (ok && (classes == 8548)) {
+		std::cout << "passed test: testCanonicalForm" << std::endl;
+	} else {
+		std::cout << "failed test: testCanonicalForm, classes:" << classes << std::endl;
+	}
+	return;
+}
+
+
+void testPermutationErrors() {
+	int caught = 0;
+	std::vector<int> images = randomImages<8>(1);
+	images[3] = images[4];
+	try {
+		TinyBitPermutation<8> p(images);
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	images[3] = 9;
+	try {
+		TinyBitPermutation<8> p(images);
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	try {
+		TinyBitPermutation<8> p(std::vector<int>({1, 2, 3}));
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	try {
+		TinyBitPermutation<8>()(9);
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	if (caught == 4) {
+		std::cout << "passed test: testPermutationErrors" << std::endl;
+	} else {
+		std::cout << "failed test: testPermutationErrors, caught:" << caught << std::endl;
+	}
+	return;
+}
+
+
+int main() {
+	testPermutations();
+	testCanonicalForm();
+	testPermutationErrors();
+	return 0;
+}
@@ -0,0 +1,153 @@
+#include "../tinybitroaring.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <vector>
+
+
+// values spread so that chunks end up as arrays (sparse), bitmaps (dense) and long runs
+void fillMixed(TinyRoaringSet &t, std::set<uint32_t> &ref, uint32_t seed) {
+	uint32_t state = seed;
+	for (int i = 0; i < 3000; i++) {
+		state = state * 1664525u + 1013904223u;
+		uint32_t x = (state >> 8) % (1u << 20);
+		t.insert(x);
+		ref.insert(x);
+	}
+	for (int i = 0; i < 20000; i++) {
+		state = state * 1664525u + 1013904223u;
+		uint32_t x = (5u << 16) | ((state >> 8) & 0x7fff);
+		t.insert(x);
+		ref.insert(x);
+	}
+	for (uint32_t x = (9u << 16) + 100 + seed % 7; x < (9u << 16) + 30000; x++) {
+		t.insert(x);
+		ref.insert(x);
+	}
+}
+
+
+bool sameAs(TinyRoaringSet const &t, std::set<uint32_t> const &ref) {
+	std::vector<uint32_t> elems = t.getIntegerElements();
+	return (t.getSetSize() == ref.size()) && std::equal(elems.begin(), elems.end(), ref.begin(), ref.end());
+}
+
+
+void testInsertRemove() {
+	TinyRoaringSet t;
+	t.insert(0);
+	t.insert(4294967295u);
+	t.insert(70000);
+	t.insert(70000);
+	t.remove(0);
+	t.remove(12345);
+
+	// push one chunk past 4096 values and back, through the array -> bitmap -> array conversions
+	for (uint32_t x = 0; x < 5000; x++) {
+		t.insert((3u << 16) | (x * 13 % 65536));
+	}
+	bool dense = (t.getSetSize() == 5002) && t.contains((3u << 16) | 13);
+	for (uint32_t x = 0; x < 5000; x++) {
+		t.remove((3u << 16) | (x * 13 % 65536));
+	}
+
+	if (dense && !t.contains(0) && t.contains(4294967295u) && t.contains(70000) && (t.getSetSize() == 2) && !t.isempty()) {
+		std::cout << "passed test: testInsertRemove" << std::endl;
+	} else {
+		std::cout << "failed test: testInsertRemove, size:" << t.getSetSize() << std::endl;
+	}
+	return;
+}
+
+
+void testSetOperations() {
+	TinyRoaringSet a;
+	TinyRoaringSet b;
+	std::set<uint32_t> ra;
+	std::set<uint32_t> rb;
+	fillMixed(a, ra, 1);
+	fillMixed(b, rb, 2);
+
+	std::set<uint32_t> ru;
+	std::set<uint32_t> ri;
+	std::set<uint32_t> rd;
+	std::set_union(ra.begin(), ra.end(), rb.begin(), rb.end(), std::inserter(ru, ru.end()));
+	std::set_intersection(ra.begin(), ra.end(), rb.begin(), rb.end(), std::inserter(ri, ri.end()));
+	std::set_difference(ra.begin(), ra.end(), rb.begin(), rb.end(), std::inserter(rd, rd.end()));
+
+	bool plain = sameAs(a.unionb(b), ru) && sameAs(a.intersectionb(b), ri) && sameAs(a.leftDifference(b), rd)
+				 && sameAs(b.rightDifference(a), rd);
+	a.runOptimize();
+	bool runs = sameAs(a.unionb(b), ru) && sameAs(a.intersectionb(b), ri) && sameAs(a.leftDifference(b), rd)
+				&& sameAs(b.leftDifference(a).rightDifference(b), ri);
+
+	if (plain && runs) {
+		std::cout << "passed test: testSetOperations" << std::endl;
+	} else {
+		std::cout << "failed test: testSetOperations, plain:" << plain << " runs:" << runs << std::endl;
+	}
+	return;
+}
+
+
+void testArrayIntersection() {
+	// array-array paths, long enough for the 8 by 8 blocks and with ragged tails
+	std::vector<uint16_t> a;
+	std::vector<uint16_t> b;
+	for (uint16_t v = 0; v < 3000; v += 3) {
+		a.push_back(v);
+	}
+	for (uint16_t v = 1; v < 2011; v += 2) {
+		b.push_back(v);
+	}
+	std::vector<uint16_t> got;
+	std::vector<uint16_t> want;
+	tinybit::intersectArrays(a, b, got);
+	std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(want));
+	bool inter = (got == want);
+	want.clear();
+	tinybit::differenceArrays(a, b, got);
+	std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(want));
+	bool diff = (got == want);
+
+	if (inter && diff) {
+		std::cout << "passed test: testArrayIntersection" << std::endl;
+	} else {
+		std::cout << "failed test: testArrayIntersection, inter:" << inter << " diff:" << diff << std::endl;
+	}
+	return;
+}
+
+
+void testRunOptimize() {
+	TinyRoaringSet t;
+	for (uint32_t x = 1000; x < 61000; x++) {
+		t.insert(x);
+	}
+	TinyRoaringSet copy = t;
+	size_t before = t.getSizeInBytes();
+	t.runOptimize();
+	size_t after = t.getSizeInBytes();
+	t.insert(500);
+	t.remove(2000);
+
+	if ((after < 16) && (before >= 8192) && (copy.getSetSize() == 60000) && (t.getSetSize() == 60000) && t.contains(500)
+		&& !t.contains(2000) && t.contains(60999) && (copy != t)) {
+		std::cout << "passed test: testRunOptimize" << std::endl;
+	} else {
+		std::cout << "failed test: testRunOptimize, before:" << before << " after:" << after << std::endl;
+	}
+	return;
+}
+
+
+
+int main() {
+	testInsertRemove();
+	testSetOperations();
+	testArrayIntersection();
+	testRunOptimize();
+	return 0;
+}
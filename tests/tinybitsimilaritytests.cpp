@@ -0,0 +1,106 @@
+#include "../tinybitsimilarity.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+template <int N>
+std::vector<TinyBitSet<N>> randomSets(size_t n, uint64_t seed) {
+	std::vector<TinyBitSet<N>> sets(n);
+	uint64_t state = seed;
+	for (size_t j = 0; j < n; j++) {
+		// sizes spread over 0 .. N so the index has many groups
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		int count = int((state >> 33) % (N + 1));
+		for (int k = 0; k < count; k++) {
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			sets[j].insert(int((state >> 33) % N) + 1);
+		}
+	}
+	return sets;
+}
+
+
+// the k best by sorting every set, the same tie-break as the heap
+template <typename Closer, int N>
+std::vector<TinyBitMatch> bruteForce(std::vector<TinyBitSet<N>> const &sets, TinyBitSet<N> const &query, size_t k) {
+	std::vector<TinyBitMatch> all;
+	for (size_t i = 0; i < sets.size(); i++) {
+		TinyBitSet<N> a = sets[i];
+		TinyBitSet<N> q = query;
+		all.push_back(TinyBitMatch{i, a.intersectionb(q).getSetSize(), a.unionb(q).getSetSize()});
+	}
+	std::sort(all.begin(), all.end(), Closer());
+	all.resize(std::min(k, all.size()));
+	return all;
+}
+
+
+bool sameMatches(std::vector<TinyBitMatch> const &a, std::vector<TinyBitMatch> const &b) {
+	bool same = (a.size() == b.size());
+	for (size_t i = 0; same && (i < a.size()); i++) {
+		same = (a[i].index == b[i].index) && (a[i].common == b[i].common) && (a[i].combined == b[i].combined);
+	}
+	return same;
+}
+
+
+template <int N>
+bool searchesMatch(size_t n, size_t k, int nthreads) {
+	std::vector<TinyBitSet<N>> sets = randomSets<N>(n, 5);
+	std::vector<TinyBitSet<N>> queries = randomSets<N>(6, 6);
+	queries.push_back(TinyBitSet<N>());
+	TinyBitSimilarityIndex<N> index(sets.data(), sets.size());
+	bool ok = (index.size() == n);
+	for (TinyBitSet<N> const &q : queries) {
+		std::vector<TinyBitMatch> wantJ = bruteForce<tinybit::JaccardCloser>(sets, q, k);
+		std::vector<TinyBitMatch> wantH = bruteForce<tinybit::HammingCloser>(sets, q, k);
+		ok = ok && sameMatches(topJaccard(sets.data(), n, q, k, nthreads), wantJ) && sameMatches(topHamming(sets.data(), n, q, k, nthreads), wantH)
+			 && sameMatches(index.topJaccard(q, k, nthreads), wantJ) && sameMatches(index.topHamming(q, k, nthreads), wantH);
+	}
+	return ok;
+}
+
+
+void testTopK() {
+	// narrow, single word (vector kernels) and 3 word sets, k below and above n, and threaded scans
+	bool ok = searchesMatch<12>(500, 10, 1) && searchesMatch<64>(1003, 7, 1) && searchesMatch<64>(5, 7, 1)
+			  && searchesMatch<192>(301, 3, 1) && searchesMatch<64>(40000, 25, 4) && searchesMatch<32>(20001, 1, 3)
+			  && searchesMatch<64>(100, 0, 1);
+	if (ok) {
+		std::cout << "passed test: testTopK" << std::endl;
+	} else {
+		std::cout << "failed test: testTopK" << std::endl;
+	}
+	return;
+}
+
+
+void testScores() {
+	TinyBitSet<64> a;
+	TinyBitSet<64> b;
+	a.insertRange(1, 4);
+	b.insertRange(3, 8);
+	std::vector<TinyBitSet<64>> sets = {a, b, TinyBitSet<64>()};
+	std::vector<TinyBitMatch> j = topJaccard(sets.data(), sets.size(), a, 3);
+	std::vector<TinyBitMatch> h = topHamming(sets.data(), sets.size(), TinyBitSet<64>(), 1);
+	// a itself, then b (2 of 8 shared), then the empty set; two empty sets count as identical
+	bool ok = (j.size() == 3) && (j[0].index == 0) && (j[0].jaccard() == 1.0) && (j[1].index == 1) && (j[1].jaccard() == 0.25)
+			  && (j[1].hamming() == 6) && (j[2].index == 2) && (j[2].jaccard() == 0.0)
+			  && (h.size() == 1) && (h[0].index == 2) && (h[0].hamming() == 0) && (h[0].jaccard() == 1.0);
+	if (ok) {
+		std::cout << "passed test: testScores" << std::endl;
+	} else {
+		std::cout << "failed test: testScores" << std::endl;
+	}
+	return;
+}
+
+
+
+int main() {
+	testTopK();
+	testScores();
+	return 0;
+}
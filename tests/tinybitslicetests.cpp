@@ -0,0 +1,134 @@
+#include "../tinybitslice.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+template <int N>
+std::vector<TinyBitSet<N>> randomSets(size_t n, uint64_t seed) {
+	std::vector<TinyBitSet<N>> sets(n);
+	uint64_t state = seed;
+	for (size_t j = 0; j < n; j++) {
+		for (int k = 0; k < N / 2; k++) {
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			sets[j].insert(int((state >> 33) % N) + 1);
+		}
+	}
+	return sets;
+}
+
+
+bool maskBit(std::vector<uint64_t> const &mask, size_t r) {
+	return ((mask[r / 64] >> (r % 64)) & 1) != 0;
+}
+
+
+// columns against contains(), the round trip back to sets, and a few predicates against per set checks
+template <int N>
+bool slicesMatch(size_t n) {
+	std::vector<TinyBitSet<N>> sets = randomSets<N>(n, uint64_t(N) * 7 + n);
+	TinyBitSlices<N> slices(sets.data(), n);
+	bool ok = (slices.size() == n) && (slices.blocks() == (n + 63) / 64) && (slices.toSets() == sets);
+	for (int k = 1; k <= N; k++) {
+		uint64_t const *column = slices.column(k);
+		for (size_t r = 0; r < n; r++) {
+			ok = ok && (((column[r / 64] >> (r % 64)) & 1) == (sets[r].contains(k) ? 1u : 0u));
+		}
+	}
+
+	TinyBitSet<N> some;
+	some.insert(1);
+	some.insert(N);
+	using P = TinyBitPredicate;
+	P notLast = P::element(1) & ~P::element(N);
+	P mixed = (P::element(N / 2 + 1) ^ P::element(2)) | ~(P::element(1) & P::element(N));
+	std::vector<uint64_t> notLastMask = slices.select(notLast);
+	std::vector<uint64_t> mixedMask = slices.select(mixed, 3);
+	std::vector<uint64_t> allMask = slices.select(P::allOf(some));
+	std::vector<uint64_t> anyMask = slices.select(P::anyOf(some));
+	std::vector<uint64_t> everyMask = slices.select(P(true));
+	size_t mixedCount = 0;
+	for (size_t r = 0; r < n; r++) {
+		TinyBitSet<N> s = sets[r];
+		bool mixedWant = (s.contains(N / 2 + 1) != s.contains(2)) || !(s.contains(1) && s.contains(N));
+		mixedCount += mixedWant ? 1 : 0;
+		ok = ok && (maskBit(notLastMask, r) == (s.contains(1) && !s.contains(N))) && (maskBit(mixedMask, r) == mixedWant)
+			 && (maskBit(allMask, r) == (s.contains(1) && s.contains(N))) && (maskBit(anyMask, r) == (s.contains(1) || s.contains(N)))
+			 && maskBit(everyMask, r);
+	}
+	// nothing set past the last row
+	for (size_t r = n; r < 64 * slices.blocks(); r++) {
+		ok = ok && !maskBit(mixedMask, r) && !maskBit(everyMask, r);
+	}
+	return ok && (slices.count(mixed) == mixedCount) && (slices.count(P(false)) == 0) && (slices.count(P(true)) == n);
+}
+
+
+void testSlices() {
+	// every transpose width, widths that leave columns of a word unused, several words per set, sizes that
+	// end partway through a block and partway through a call's 64 blocks, and enough blocks for select to
+	// give each of its 3 threads a range
+	bool ok = slicesMatch<5>(100) && slicesMatch<8>(517) && slicesMatch<13>(64) && slicesMatch<16>(4097)
+			  && slicesMatch<30>(1000) && slicesMatch<32>(129) && slicesMatch<50>(333) && slicesMatch<64>(5000)
+			  && slicesMatch<100>(200) && slicesMatch<192>(65) && slicesMatch<64>(1) && slicesMatch<64>(0)
+			  && slicesMatch<8>(3 * 64 * tinybit::selectParallelMin + 37);
+	if (ok) {
+		std::cout << "passed test: testSlices" << std::endl;
+	} else {
+		std::cout << "failed test: testSlices" << std::endl;
+	}
+	return;
+}
+
+
+void testPredicateProgram() {
+	// a & ~b is one and-not step, a double not cancels, and the stack depth follows the tree
+	using P = TinyBitPredicate;
+	P andNot = P::element(3) & ~P::element(17);
+	P twice = ~~P::element(4);
+	P deep = P::element(1) | (P::element(2) & (P::element(3) ^ P::element(4)));
+	bool ok = (andNot.program().size() == 3) && (andNot.program()[2].op == P::Op::AndNot) && (twice.program().size() == 1)
+			  && (deep.depth() == 4) && (andNot.depth() == 2) && (deep.maxElement() == 4) && (P(true).maxElement() == 0);
+	if (ok) {
+		std::cout << "passed test: testPredicateProgram" << std::endl;
+	} else {
+		std::cout << "failed test: testPredicateProgram" << std::endl;
+	}
+	return;
+}
+
+
+void testSliceErrors() {
+	std::vector<TinyBitSet<20>> sets = randomSets<20>(10, 1);
+	TinyBitSlices<20> slices(sets.data(), sets.size());
+	int caught = 0;
+	try {
+		TinyBitPredicate::element(0);
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	try {
+		slices.column(21);
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	try {
+		slices.select(TinyBitPredicate::element(3) | TinyBitPredicate::element(21));
+	} catch (std::invalid_argument const &) {
+		caught++;
+	}
+	if (caught == 3) {
+		std::cout << "passed test: testSliceErrors" << std::endl;
+	} else {
+		std::cout << "failed test: testSliceErrors, caught:" << caught << std::endl;
+	}
+	return;
+}
+
+
+int main() {
+	testSlices();
+	testPredicateProgram();
+	testSliceErrors();
+	return 0;
+}
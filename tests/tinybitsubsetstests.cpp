@@ -0,0 +1,110 @@
+#include "../tinybitsubsets.h"
+#include <iostream>
+#include <vector>
+
+
+void testSubmasks() {
+	TinyBitSet<8> t;
+	t.insert(1);
+	t.insert(3);
+	t.insert(8);
+	std::vector<int> seen;
+	for (TinyBitSet<8> sub : submasks(t)) {
+		seen.push_back(sub.getBitInt());
+	}
+
+	if (seen == std::vector<int>({0x85, 0x84, 0x81, 0x80, 0x05, 0x04, 0x01, 0x00})) {
+		std::cout << "passed test: testSubmasks" << std::endl;
+	} else {
+		std::cout << "failed test: testSubmasks, count:" << seen.size() << std::endl;
+	}
+	return;
+}
+
+
+void testSupersets() {
+	TinyBitSet<4> t;
+	t.insert(2);
+	t.insert(3);
+	std::vector<int> seen;
+	for (TinyBitSet<4> sup : supersets(t)) {
+		seen.push_back(sup.getBitInt());
+	}
+
+	TinyBitSet<64> full;
+	full.fill();
+	int count = 0;
+	for (TinyBitSet<64> sup : supersets(full)) {
+		count += sup.getSetSize();
+	}
+
+	if ((seen == std::vector<int>({0x6, 0x7, 0xe, 0xf})) && (count == 64)) {
+		std::cout << "passed test: testSupersets" << std::endl;
+	} else {
+		std::cout << "failed test: testSupersets, count:" << seen.size() << std::endl;
+	}
+	return;
+}
+
+
+void testCombinations() {
+	std::vector<int> seen;
+	for (TinyBitSet<4> c : combinations<4>(2)) {
+		seen.push_back(c.getBitInt());
+	}
+
+	int count = 0;
+	bool allSize3 = true;
+	for (TinyBitSet<64> c : combinations<64>(3)) {
+		count++;
+		allSize3 = allSize3 && (c.getSetSize() == 3);
+	}
+
+	int none = 0;
+	for (TinyBitSet<8> c : combinations<8>(9)) {
+		none += c.getSetSize() + 1;
+	}
+	int zero = 0;
+	for (TinyBitSet<8> c : combinations<8>(0)) {
+		zero += c.getSetSize() + 1;
+	}
+
+	// colex: {1,2} {1,3} {2,3} {1,4} {2,4} {3,4}
+	if ((seen == std::vector<int>({0x3, 0x5, 0x6, 0x9, 0xa, 0xc})) && (count == 41664) && allSize3 && (none == 0) && (zero == 1)) {
+		std::cout << "passed test: testCombinations" << std::endl;
+	} else {
+		std::cout << "failed test: testCombinations, count:" << count << std::endl;
+	}
+	return;
+}
+
+
+void testSplits() {
+	TinyBitSet<16> t;
+	t.insert(2);
+	t.insert(9);
+	t.insert(16);
+	int count = 0;
+	bool disjoint = true;
+	for (auto const &parts : splits(t)) {
+		count++;
+		disjoint = disjoint && parts.first.intersectionb(parts.second).isempty() && (parts.first.unionb(parts.second) == t);
+	}
+
+	if ((count == 8) && disjoint) {
+		std::cout << "passed test: testSplits" << std::endl;
+	} else {
+		std::cout << "failed test: testSplits, count:" << count << std::endl;
+	}
+	return;
+}
+
+
+
+int main() {
+	testSubmasks();
+	testSupersets();
+	testCombinations();
+	testSplits();
+	return 0;
+}
@@ -1,7 +1,10 @@
 
 #include "../tinybitset.h"  // had to be installed in /usr/local/include for macOS
+#include <climits>
 #include <iostream>
 #include <vector>
+#include <cstring>
+#include <type_traits>
 
 
 void testEqual() {
@@ -83,14 +86,67 @@ void testValidSize() {
 	return;
 }
 
-void testInvalidSizeError() {
-	try {
-		TinyBitSet<65> t;
-	} catch (std::invalid_argument const &err) {
-		std::cout << "passed test: testInvalidSizeError, " << err.what() << std::endl;
-		return;
+void testExactWidth() {
+	TinyBitSet<16> src[4];
+	src[0].insert(16);
+	src[3].insert(1);
+	TinyBitSet<16> dst[4];
+	std::memcpy(dst, src, sizeof(src));
+
+	bool widths = (sizeof(TinyBitSet<8>) == 1) && (sizeof(TinyBitSet<16>) == 2) && (sizeof(TinyBitSet<32>) == 4)
+				&& (sizeof(TinyBitSet<64>) == 8) && (sizeof(TinyBitSet<128>) == 16) && (sizeof(TinyBitSet<192>) == 24);
+	if (widths && std::is_trivially_copyable<TinyBitSet<16>>::value && (dst[0] == src[0]) && dst[3].contains(1)) {
+		std::cout << "passed test: testExactWidth" << std::endl;
+	} else {
+		std::cout << "failed test: testExactWidth, sizeof:" << sizeof(TinyBitSet<16>) << std::endl;
 	}
-	std::cout << "failed test: testInvalidSizeError, no exception thrown" << std::endl;
+	return;
+}
+
+// built entirely at compile time, a TinyBitSet<0> would fail to compile instead of throwing
+constexpr TinyBitSet<16> makeRuleMask(int lo, int hi) {
+	TinyBitSet<16> t;
+	for (int i = lo; i <= hi; i++) {
+		t.insert(i);
+	}
+	return t;
+}
+
+constexpr TinyBitSet<16> ruleTable[3] = {makeRuleMask(1, 4), makeRuleMask(3, 8), makeRuleMask(16, 16)};
+constexpr TinyBitSet<16> ruleOverlap = ruleTable[0].intersectionb(ruleTable[1]);
+static_assert(ruleOverlap.getSetSize() == 2 && ruleOverlap.contains(3) && ruleOverlap.contains(4), "constexpr intersection");
+static_assert(ruleTable[2].unionb(ruleTable[0]).getSetSize() == 5, "constexpr union");
+static_assert(ruleTable[1].select(2) == 4 && ruleTable[1].rank(5) == 3, "constexpr select and rank");
+
+constexpr TinyBitSet<130> makeWideMask() {
+	TinyBitSet<130> t;
+	t.fill();
+	t.remove(65);
+	t.invertSet();
+	return t;
+}
+static_assert(makeWideMask().getSetSize() == 1 && makeWideMask().contains(65), "constexpr wide set");
+
+
+void testConstexpr() {
+	constexpr TinyBitSet<16> left = ruleTable[1].leftDifference(ruleTable[0]);
+	if ((left.getIntegerElements() == std::vector<int>({5, 6, 7, 8})) && (makeWideMask().getIntegerElements() == std::vector<int>({65}))) {
+		std::cout << "passed test: testConstexpr" << std::endl;
+	} else {
+		std::cout << "failed test: testConstexpr, size:" << left.getSetSize() << std::endl;
+	}
+	return;
+}
+
+
+void testValidSizeWide() {
+	TinyBitSet<200> t;
+	if ((t.getMaxElements() == 200) && (t.getSetSize() == 0) && t.isempty()) {
+		std::cout << "passed test: testValidSizeWide, (empty 200 bit set)" << std::endl;
+	} else {
+		std::cout << "failed test: testValidSizeWide, " << std::endl;
+	}
+	return;
 }
 
 
@@ -129,6 +185,65 @@ void testContains() {
 }
 
 
+void testInsertHighBits() {
+	TinyBitSet<64> t;
+	t.insert(33);
+	t.insert(64);
+	if ((t.getSetSize() == 2) && t.contains(64) && !t.contains(32) && (t.getIntegerElements() == std::vector<int>({33, 64}))) {
+		std::cout << "passed test: testInsertHighBits" << std::endl;
+	} else {
+		std::cout << "failed test: testInsertHighBits, size:" << t.getSetSize() << std::endl;
+	}
+	return;
+}
+
+
+void testInsertWide() {
+	TinyBitSet<300> t;
+	t.insert(1);
+	t.insert(64);
+	t.insert(65);
+	t.insert(300);
+	t.remove(64);
+	if ((t.getSetSize() == 3) && t.contains(65) && !t.contains(64) && (t.getIntegerElements() == std::vector<int>({1, 65, 300}))) {
+		std::cout << "passed test: testInsertWide" << std::endl;
+	} else {
+		std::cout << "failed test: testInsertWide, size:" << t.getSetSize() << std::endl;
+	}
+	return;
+}
+
+
+void testOutOfRangeError() {
+	TinyBitSet<32> t;
+	try {
+		t.insert(33);
+	} catch (std::invalid_argument const &err) {
+		std::cout << "passed test: testOutOfRangeError, " << err.what() << std::endl;
+		return;
+	}
+	std::cout << "failed test: testOutOfRangeError, no exception thrown" << std::endl;
+}
+
+
+void testBoundsPolicies() {
+	TinyBitSet<32, TinyBitNoCheck> unchecked;
+	unchecked.insert(5);
+	unchecked.insert(32);
+	TinyBitSet<32, TinyBitAssertCheck> asserted;
+	asserted.insert(5);
+	asserted.remove(5);
+	asserted.insert(1);
+	if (unchecked.contains(32) && (unchecked.popInt(5) == 5) && (unchecked.popInt(5) == 0)
+		&& (unchecked.getSetSize() == 1) && (asserted.getIntegerElements() == std::vector<int>({1}))) {
+		std::cout << "passed test: testBoundsPolicies" << std::endl;
+	} else {
+		std::cout << "failed test: testBoundsPolicies, size:" << unchecked.getSetSize() << std::endl;
+	}
+	return;
+}
+
+
 void testRemoveOne() {
 	TinyBitSet<32> t;
 	t.insert(5);
@@ -170,6 +285,23 @@ void testFill() {
 
 
 
+void testFillWide() {
+	TinyBitSet<130> t;
+	t.fill();
+	TinyBitSet<130> t2;
+	t2.insert(2);
+	t2.insert(129);
+	t2.invertSet();
+	if ((t.getSetSize() == 130) && t.contains(130) && (t2.getSetSize() == 128) && !t2.contains(129) && t2.contains(130)) {
+		std::cout << "passed test: testFillWide" << std::endl;
+	} else {
+		std::cout << "failed test: testFillWide, size:" << t.getSetSize() << " " << t2.getSetSize() << std::endl;
+	}
+	return;
+}
+
+
+
 void testRemoveAll() {
 	TinyBitSet<37> t;
 	t.insert(10);
@@ -188,6 +320,34 @@ void testRemoveAll() {
 
 
 
+void testIterate() {
+	TinyBitSet<64> t;
+	t.insert(64);
+	t.insert(3);
+	t.insert(33);
+	std::vector<int> seen;
+	for (int i : t) {
+		seen.push_back(i);
+	}
+
+	TinyBitSet<300> wide;
+	wide.insert(300);
+	wide.insert(2);
+	wide.insert(129);
+	std::vector<int> seenWide;
+	wide.forEach([&seenWide](int i) { seenWide.push_back(i); });
+
+	TinyBitSet<8> empty;
+	if ((seen == std::vector<int>({3, 33, 64})) && (seenWide == std::vector<int>({2, 129, 300}))
+		&& (std::vector<int>(wide.begin(), wide.end()) == seenWide) && (empty.begin() == empty.end())) {
+		std::cout << "passed test: testIterate" << std::endl;
+	} else {
+		std::cout << "failed test: testIterate, " << seen.size() << " " << seenWide.size() << std::endl;
+	}
+	return;
+}
+
+
 void testUnion() {
 	TinyBitSet<9> t1;
 	t1.insert(5);
@@ -239,6 +399,122 @@ void testIntersection() {
 
 
 
+void testSetOpsWide() {
+	TinyBitSet<512> t1;
+	t1.insert(5);
+	t1.insert(70);
+	t1.insert(300);
+	t1.insert(512);
+
+	TinyBitSet<512> t2;
+	t2.insert(70);
+	t2.insert(200);
+	t2.insert(512);
+
+	TinyBitSet<512> tunion = t1.unionb(t2);
+	TinyBitSet<512> tinter = t1.intersectionb(t2);
+	TinyBitSet<512> tleft = t1.leftDifference(t2);
+	TinyBitSet<512> tright = t1.rightDifference(t2);
+	if ((tunion.getIntegerElements() == std::vector<int>({5, 70, 200, 300, 512}))
+		&& (tinter.getIntegerElements() == std::vector<int>({70, 512}))
+		&& (tleft.getIntegerElements() == std::vector<int>({5, 300}))
+		&& (tright.getIntegerElements() == std::vector<int>({200}))) {
+		std::cout << "passed test: testSetOpsWide" << std::endl;
+	} else {
+		std::cout << "failed test: testSetOpsWide, " << tunion.getSetSize() << tinter.getSetSize() << std::endl;
+	}
+	return;
+}
+
+
+
+void testOperators() {
+	TinyBitSet<512> t1;
+	t1.insert(5);
+	t1.insert(70);
+	t1.insert(512);
+	TinyBitSet<512> t2;
+	t2.insert(70);
+	t2.insert(200);
+
+	TinyBitSet<512> sym = t1 ^ t2;
+	TinyBitSet<512> compound = t1;
+	compound |= t2;
+	compound -= t1 & t2;
+	compound ^= sym;
+	compound &= ~t2;
+	// ~ stays inside 1 .. MaxElems, and an expression is usable at compile time
+	constexpr TinyBitSet<10> small = ~TinyBitSet<10>(0b1011) - TinyBitSet<10>(0b10000);
+	static_assert(noexcept(t1 | t2) && noexcept(compound -= t1) && noexcept(~t1), "set operators are noexcept");
+	if (((t1 | t2) == t1.unionb(t2)) && ((t1 & t2) == t1.intersectionb(t2)) && ((t1 - t2) == t1.leftDifference(t2))
+		&& (sym.getIntegerElements() == std::vector<int>({5, 200, 512})) && compound.isempty()
+		&& ((~t1).getSetSize() == 509) && (~~t1 == t1) && (small.getIntegerElements() == std::vector<int>({3, 6, 7, 8, 9, 10}))) {
+		std::cout << "passed test: testOperators" << std::endl;
+	} else {
+		std::cout << "failed test: testOperators, " << compound.getSetSize() << small.getSetSize() << std::endl;
+	}
+	return;
+}
+
+
+
+// the variadic and span forms against chained operators, across block boundaries and early exits
+template <int N>
+bool naryMatches(size_t n, int perSet) {
+	std::vector<TinyBitSet<N>> sets(n);
+	uint64_t state = uint64_t(N) * 31 + n;
+	for (auto &s : sets) {
+		s.fill();
+		for (int k = 0; k < perSet; k++) {
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			s.remove(int((state >> 33) % N) + 1);
+		}
+	}
+	TinyBitSet<N> u;
+	TinyBitSet<N> in;
+	in.fill();
+	TinyBitSet<N> x;
+	bool ok = true;
+	for (size_t i = 0; i < n; i++) {
+		u |= ~sets[i];
+		in &= sets[i];
+		x ^= sets[i];
+		// every prefix, so the exits land inside and at the ends of blocks
+		std::vector<TinyBitSet<N>> flipped(i + 1);
+		for (size_t j = 0; j <= i; j++) {
+			flipped[j] = ~sets[j];
+		}
+		ok = ok && (intersectAll(sets.data(), i + 1) == in) && (unionAll(flipped.data(), i + 1) == u)
+			 && (symmetricDifferenceAll(sets.data(), i + 1) == x);
+	}
+	return ok;
+}
+
+
+void testNaryOps() {
+	TinyBitSet<100> a;
+	a.insertRange(1, 60);
+	TinyBitSet<100> b;
+	b.insertRange(40, 100);
+	TinyBitSet<100> c;
+	c.insertRange(50, 55);
+	TinyBitSet<100> full;
+	full.fill();
+	constexpr TinyBitSet<8> packed = intersectAll(TinyBitSet<8>(0b1110), TinyBitSet<8>(0b0111), TinyBitSet<8>(0b1111));
+	bool ok = (intersectAll(a, b, c) == c) && (unionAll(a, b, c) == full) && (symmetricDifferenceAll(a, b, c) == ((a ^ b) ^ c))
+			  && (intersectAll(a) == a) && (packed == TinyBitSet<8>(0b0110))
+			  && (intersectAll(static_cast<TinyBitSet<100> const *>(nullptr), 0) == full) && unionAll(&a, 0).isempty()
+			  && naryMatches<8>(40, 2) && naryMatches<64>(70, 3) && naryMatches<64>(40, 60) && naryMatches<200>(50, 20);
+	if (ok) {
+		std::cout << "passed test: testNaryOps" << std::endl;
+	} else {
+		std::cout << "failed test: testNaryOps" << std::endl;
+	}
+	return;
+}
+
+
+
 void testPopSmallest() {
 	TinyBitSet<17> t;
 	t.insert(5);
@@ -270,6 +546,87 @@ void testPopLargest() {
 	return;
 }
 
+void testPopWide() {
+	TinyBitSet<256> t;
+	t.insert(100);
+	t.insert(7);
+	t.insert(255);
+	int smallest = t.popSmallest();
+	int largest = t.popLargest();
+
+	if ((smallest == 7) && (largest == 255) && (t.getIntegerElements() == std::vector<int>({100}))) {
+		std::cout << "passed test: testPopWide" << std::endl;
+	} else {
+		std::cout << "failed test: testPopWide, " << smallest << " " << largest << std::endl;
+	}
+	return;
+}
+
+void testSelectRank() {
+	TinyBitSet<64> t;
+	t.insert(2);
+	t.insert(40);
+	t.insert(64);
+	TinyBitSet<200> wide;
+	wide.insert(1);
+	wide.insert(64);
+	wide.insert(65);
+	wide.insert(199);
+
+	bool small = (t.select(1) == 2) && (t.select(3) == 64) && (t.select(4) == 0) && (t.select(0) == 0)
+				&& (t.rank(1) == 0) && (t.rank(40) == 2) && (t.rank(63) == 2) && (t.rank(100) == 3);
+	bool big = (wide.select(2) == 64) && (wide.select(3) == 65) && (wide.select(4) == 199)
+				&& (wide.rank(64) == 2) && (wide.rank(65) == 3) && (wide.rank(198) == 3) && (wide.rank(200) == 4);
+	if (small && big) {
+		std::cout << "passed test: testSelectRank" << std::endl;
+	} else {
+		std::cout << "failed test: testSelectRank, " << t.select(2) << " " << wide.select(3) << std::endl;
+	}
+	return;
+}
+
+void testNavigation() {
+	TinyBitSet<64> t;
+	t.insert(3);
+	t.insert(20);
+	t.insert(64);
+	TinyBitSet<200> wide;
+	wide.insert(10);
+	wide.insert(150);
+
+	bool small = (t.nextAfter(0) == 3) && (t.nextAfter(3) == 20) && (t.nextAfter(20) == 64) && (t.nextAfter(64) == 0)
+				&& (t.prevBefore(64) == 20) && (t.prevBefore(100) == 64) && (t.prevBefore(3) == 0) && (t.prevBefore(-5) == 0);
+	bool big = (wide.nextAfter(10) == 150) && (wide.nextAfter(150) == 0) && (wide.prevBefore(150) == 10) && (wide.prevBefore(10) == 0);
+	if (small && big) {
+		std::cout << "passed test: testNavigation" << std::endl;
+	} else {
+		std::cout << "failed test: testNavigation, " << t.nextAfter(3) << " " << wide.nextAfter(10) << std::endl;
+	}
+	return;
+}
+
+
+void testRanges() {
+	TinyBitSet<32> t;
+	t.insertRange(5, 12);
+	t.removeRange(8, 9);
+	TinyBitSet<256> wide;
+	wide.insertRange(60, 200);
+	wide.removeRange(64, 64);
+
+	bool small = (t.getIntegerElements() == std::vector<int>({5, 6, 7, 10, 11, 12})) && (t.countInRange(1, 7) == 3)
+				&& (t.countInRange(-10, 100) == 6) && (t.countInRange(9, 8) == 0)
+				&& t.containsAllInRange(10, 12) && !t.containsAllInRange(7, 10) && t.containsAllInRange(3, 2);
+	bool big = (wide.getSetSize() == 140) && (wide.countInRange(1, 64) == 4) && (wide.countInRange(65, 128) == 64)
+				&& wide.containsAllInRange(65, 200) && !wide.containsAllInRange(60, 200) && !wide.contains(201);
+	if (small && big) {
+		std::cout << "passed test: testRanges" << std::endl;
+	} else {
+		std::cout << "failed test: testRanges, " << t.getSetSize() << " " << wide.getSetSize() << std::endl;
+	}
+	return;
+}
+
 void testPopInt() {
 	TinyBitSet<17> t;
 	t.insert(5);
@@ -277,8 +634,9 @@ void testPopInt() {
 	t.insert(11);
 	t.insert(17);
 	int res = t.popInt(11);
+	int missing = t.popInt(12);
 
-	if((t.getSetSize() == 3) && (res == 11)) {
+	if((t.getSetSize() == 3) && (res == 11) && (missing == 0)) {
 		std::cout << "passed test: testPopInt" << std::endl;
 	} else {
 		std::cout << "failed test: testPopInt, res: " << res << ", size: " << t.getSetSize() << std::endl;
@@ -391,6 +749,84 @@ void testRightDiffBits() {
 
 
 
+// shifts, rotations and compress / expand against renumbering element by element
+template <int N>
+bool remapMatches(uint64_t seed) {
+	bool ok = true;
+	uint64_t state = seed;
+	auto next = [&]() {
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		return state >> 33;
+	};
+	for (int round = 0; round < 20; round++) {
+		TinyBitSet<N> s;
+		TinyBitSet<N> mask;
+		for (int i = 1; i <= N; i++) {
+			if (next() % 3 == 0) {
+				s.insert(i);
+			}
+			if (next() % (round % 4 + 2) == 0) {
+				mask.insert(i);
+			}
+		}
+		for (int k : {0, 1, 3, 31, 63, 64, 65, 127, N - 1, N, N + 5}) {
+			TinyBitSet<N> up;
+			TinyBitSet<N> down;
+			TinyBitSet<N> rotated;
+			for (int i : s) {
+				if (i + k <= N) {
+					up.insert(i + k);
+				}
+				if (i - k >= 1) {
+					down.insert(i - k);
+				}
+				rotated.insert((i - 1 + k) % N + 1);
+			}
+			ok = ok && (s.shiftUp(k) == up) && (s.shiftDown(k) == down) && (s.shiftUp(-k) == down) && (s.shiftDown(-k) == up)
+				 && (s.rotate(k) == rotated) && (s.rotate(k - 3 * N) == rotated);
+		}
+		// shifts that can't be negated, and every element moved out of range either way
+		ok = ok && s.shiftUp(INT_MIN).isempty() && s.shiftDown(INT_MIN).isempty() && s.shiftUp(INT_MAX).isempty()
+			 && s.shiftDown(INT_MAX).isempty() && s.shiftUp(-N).isempty() && s.shiftDown(-N).isempty()
+			 && (s.rotate(INT_MIN) == s.rotate(INT_MIN % N)) && (s.rotate(INT_MAX) == s.rotate(INT_MAX % N));
+		TinyBitSet<N> compressed;
+		int j = 0;
+		for (int i : mask) {
+			j++;
+			if (s.contains(i)) {
+				compressed.insert(j);
+			}
+		}
+		TinyBitSet<N> spread;
+		for (int i : s) {
+			if (i <= mask.getSetSize()) {
+				spread.insert(mask.select(i));
+			}
+		}
+		ok = ok && (s.compress(mask) == compressed) && (s.expand(mask) == spread) && (s.compress(mask).expand(mask) == (s & mask));
+	}
+	return ok;
+}
+
+
+void testRemap() {
+	constexpr TinyBitSet<8> rotated = TinyBitSet<8>(0b10000011).rotate(2);
+	constexpr TinyBitSet<64> packed = TinyBitSet<64>(0b101100).compress(TinyBitSet<64>(0b111000));
+	constexpr TinyBitSet<8> gone = TinyBitSet<8>(0b11111111).shiftUp(INT_MIN);
+	static_assert(noexcept(rotated.shiftUp(1)) && noexcept(packed.expand(packed)), "remapping is noexcept");
+	static_assert(gone.isempty() && (TinyBitSet<8>(0b10000000).shiftUp(-7) == TinyBitSet<8>(0b1)), "negative shifts are clamped");
+	bool ok = (rotated == TinyBitSet<8>(0b00001110)) && (packed.getIntegerElements() == std::vector<int>({1, 3}))
+			  && remapMatches<5>(1) && remapMatches<8>(2) && remapMatches<16>(3) && remapMatches<32>(4) && remapMatches<64>(5)
+			  && remapMatches<100>(6) && remapMatches<128>(7) && remapMatches<200>(8) && remapMatches<512>(9);
+	if (ok) {
+		std::cout << "passed test: testRemap" << std::endl;
+	} else {
+		std::cout << "failed test: testRemap" << std::endl;
+	}
+	return;
+}
+
+
 int main() {
 	testEqual();
 	testNotEqual();
@@ -398,17 +834,33 @@ int main() {
 	testAssignmentBitRep();
 	testContains();
 	testValidSize();
-	testInvalidSizeError();
+	testValidSizeWide();
+	testExactWidth();
+	testConstexpr();
 	testInsertOne();
 	testInsertTwo();
+	testInsertHighBits();
+	testInsertWide();
+	testOutOfRangeError();
+	testBoundsPolicies();
 	testRemoveOne();
 	testInvertSet();
+	testIterate();
 	testUnion();
 	testIntersection();
 	testFill();
+	testFillWide();
 	testRemoveAll();
+	testSetOpsWide();
+	testOperators();
+	testNaryOps();
+	testRemap();
 	testPopSmallest();
 	testPopLargest();
+	testPopWide();
+	testSelectRank();
+	testNavigation();
+	testRanges();
 	testPopInt();
 	testLeftDiff();
 	testRightDiff();
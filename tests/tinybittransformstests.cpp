@@ -0,0 +1,189 @@
+#include "../tinybittransforms.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+// brute force reference, O(4^n)
+template <int N, typename T>
+bool matchesBruteSubsetSum(TinySubsetTable<N, T> const &orig, TinySubsetTable<N, T> const &out, bool superset) {
+	for (size_t s = 0; s < orig.size(); s++) {
+		T sum = T();
+		for (size_t a = 0; a < orig.size(); a++) {
+			bool related = superset ? ((a & s) == s) : ((a & s) == a);
+			if (related) {
+				sum += orig[a];
+			}
+		}
+		if (sum != out[s]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+void testSubsetSum() {
+	TinySubsetTable<6, int64_t> f;
+	for (size_t i = 0; i < f.size(); i++) {
+		f[i] = int64_t(i * 7 % 11) - 3;
+	}
+	TinySubsetTable<6, int64_t> orig = f;
+	subsetSumTransform(f);
+	bool forward = matchesBruteSubsetSum(orig, f, false);
+	subsetSumInverse(f);
+
+	TinyBitSet<6> s;
+	s.insert(2);
+	s.insert(5);
+	if (forward && (f[s] == orig[s]) && (f.data()[63] == orig[63])) {
+		std::cout << "passed test: testSubsetSum" << std::endl;
+	} else {
+		std::cout << "failed test: testSubsetSum, forward:" << forward << std::endl;
+	}
+	return;
+}
+
+
+void testSupersetSum() {
+	TinySubsetTable<7, double> f;
+	for (size_t i = 0; i < f.size(); i++) {
+		f[i] = double(i % 5);
+	}
+	TinySubsetTable<7, double> orig = f;
+	supersetSumTransform(f);
+	bool forward = matchesBruteSubsetSum(orig, f, true);
+	supersetSumInverse(f);
+
+	bool back = true;
+	for (size_t i = 0; i < f.size(); i++) {
+		back = back && (f[i] == orig[i]);
+	}
+	if (forward && back) {
+		std::cout << "passed test: testSupersetSum" << std::endl;
+	} else {
+		std::cout << "failed test: testSupersetSum, forward:" << forward << " back:" << back << std::endl;
+	}
+	return;
+}
+
+
+void testConvolutions() {
+	TinySubsetTable<5, int32_t> a;
+	TinySubsetTable<5, int32_t> b;
+	for (size_t i = 0; i < a.size(); i++) {
+		a[i] = int32_t(i % 3);
+		b[i] = int32_t((i * 5) % 4);
+	}
+	TinySubsetTable<5, int32_t> cor = orConvolution(a, b);
+	TinySubsetTable<5, int32_t> cand = andConvolution(a, b);
+
+	bool ok = true;
+	for (size_t s = 0; s < a.size(); s++) {
+		int32_t wantOr = 0;
+		int32_t wantAnd = 0;
+		for (size_t x = 0; x < a.size(); x++) {
+			for (size_t y = 0; y < a.size(); y++) {
+				wantOr += ((x | y) == s) ? a[x] * b[y] : 0;
+				wantAnd += ((x & y) == s) ? a[x] * b[y] : 0;
+			}
+		}
+		ok = ok && (cor[s] == wantOr) && (cand[s] == wantAnd);
+	}
+	if (ok) {
+		std::cout << "passed test: testConvolutions" << std::endl;
+	} else {
+		std::cout << "failed test: testConvolutions" << std::endl;
+	}
+	return;
+}
+
+
+void testLargeThreaded() {
+	// 2^18 entries, past both the block size and the threading threshold
+	TinySubsetTable<18, int64_t> single;
+	for (size_t i = 0; i < single.size(); i++) {
+		single[i] = int64_t((i * 2654435761u) % 1000);
+	}
+	TinySubsetTable<18, int64_t> threaded = single;
+	TinySubsetTable<18, int64_t> orig = single;
+	subsetSumTransform(single);
+	subsetSumTransform(threaded, 4);
+
+	TinyBitSet<18> full;
+	full.fill();
+	int64_t total = 0;
+	for (size_t i = 0; i < orig.size(); i++) {
+		total += orig[i];
+	}
+
+	bool same = true;
+	for (size_t i = 0; i < single.size(); i++) {
+		same = same && (single[i] == threaded[i]);
+	}
+	subsetSumInverse(threaded, 4);
+	bool back = true;
+	for (size_t i = 0; i < orig.size(); i++) {
+		back = back && (orig[i] == threaded[i]);
+	}
+	if (same && back && (single[full] == total) && (single[size_t(0)] == orig[size_t(0)])) {
+		std::cout << "passed test: testLargeThreaded" << std::endl;
+	} else {
+		std::cout << "failed test: testLargeThreaded, same:" << same << " back:" << back << std::endl;
+	}
+	return;
+}
+
+
+// every dispatch path against the scalar one, for each width of vector lane and a type without one
+template <typename T>
+bool pathsAgree() {
+	TinySubsetTable<10, T> orig;
+	for (size_t i = 0; i < orig.size(); i++) {
+		orig[i] = T(int((i * 2654435761u) % 7) - 3);
+	}
+	std::vector<TinySubsetTable<10, T>> results;
+	for (TinyBitPath path : {TinyBitPath::Scalar, TinyBitPath::AVX2, TinyBitPath::AVX512}) {
+		if (tinybit::pathSupported(path)) {
+			tinybit::forcePath(path);
+			TinySubsetTable<10, T> f = orig;
+			subsetSumTransform(f);
+			supersetSumInverse(f);
+			results.push_back(f);
+			supersetSumTransform(f);
+			subsetSumInverse(f);
+			results.push_back(f);
+		}
+	}
+	tinybit::resetPath();
+	bool ok = (results[1].size() == orig.size());
+	for (size_t r = 0; r < results.size(); r++) {
+		for (size_t i = 0; i < orig.size(); i++) {
+			ok = ok && (results[r][i] == results[r % 2][i]) && (results[1][i] == orig[i]);
+		}
+	}
+	return ok;
+}
+
+
+void testEveryPath() {
+	bool ok = pathsAgree<int8_t>() && pathsAgree<uint16_t>() && pathsAgree<int32_t>() && pathsAgree<int64_t>()
+			  && pathsAgree<float>() && pathsAgree<double>() && pathsAgree<long double>();
+	if (ok) {
+		std::cout << "passed test: testEveryPath" << std::endl;
+	} else {
+		std::cout << "failed test: testEveryPath" << std::endl;
+	}
+	return;
+}
+
+
+
+int main() {
+	testSubsetSum();
+	testSupersetSum();
+	testConvolutions();
+	testLargeThreaded();
+	testEveryPath();
+	return 0;
+}
@@ -0,0 +1,315 @@
+/*
+slot allocator over 0 .. capacity-1 built from TinyBitSet<64> words, for connection / buffer pools.
+
+the leaf level has one bit per slot (set = free). every level above is a 64-ary summary of the one below,
+bit j of word k is set while child word 64k+j still has a free bit, so the root tells at a glance
+which subtrees have room:
+
+	level 2 (root):   1 word               covers 262144 slots
+	level 1:          capacity / 4096      words
+	level 0 (leaves): capacity / 64        words
+
+allocate(), release(i) and nextFree(after) touch one word per level, O(log64 capacity) -- 3 words for 262144
+slots, 4 for 16M. slots past capacity in the last leaf are never marked free.
+
+ShardedTinyBitSlotAllocator splits the slots into per-core shards, each its own allocator behind its own lock
+on its own cache lines. a thread allocates from its home shard and only moves on to the others when that one
+is full, so threads rarely share a cache line.
+
+*/
+
+#ifndef TINYBITALLOC_H
+#define TINYBITALLOC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tinybitset.h"
+
+
+class TinyBitSlotAllocator {
+	public:
+		explicit TinyBitSlotAllocator(size_t capacity);
+
+		// lowest free slot, marked used, or -1 if every slot is in use
+		long allocate();
+		// marks slot i free again, returns false if it already was
+		bool release(size_t i);
+		// marks slot i used, returns false if it already was
+		bool claim(size_t i);
+		// lowest free slot > after (any after, -1 for the first free slot), or -1 if there is none
+		long nextFree(long after) const;
+
+		bool isFree(size_t i) const;
+		size_t freeCount() const;
+		size_t capacity() const;
+
+	private:
+		using Word = TinyBitSet<64, TinyBitNoCheck>;
+
+		void checkSlot(size_t i, char const *fname) const;
+		void markUsed(size_t i);
+		void markFree(size_t i);
+		long leftmostFree(int level, size_t word) const;
+
+		// levels[0] is the leaves, levels.back() is the single root word
+		std::vector<std::vector<Word>> levels;
+		size_t slots;
+		size_t nfree;
+};
+
+
+
+inline TinyBitSlotAllocator::TinyBitSlotAllocator(size_t capacity) : slots(capacity), nfree(capacity) {
+	size_t nwords = (capacity + 63) / 64;
+	do {
+		nwords = (nwords > 0) ? nwords : 1;
+		this->levels.push_back(std::vector<Word>(nwords));
+		nwords = (nwords + 63) / 64;
+	} while (this->levels.back().size() > 1);
+
+	// leaves: the first `capacity` bits free, each summary bit set for a non-empty child
+	for (size_t w = 0; w < this->levels[0].size(); w++) {
+		size_t lo = 64 * w;
+		if (lo < capacity) {
+			this->levels[0][w].insertRange(1, int((capacity - lo < 64) ? capacity - lo : 64));
+		}
+	}
+	for (size_t level = 1; level < this->levels.size(); level++) {
+		for (size_t child = 0; child < this->levels[level - 1].size(); child++) {
+			if (!this->levels[level - 1][child].isempty()) {
+				this->levels[level][child / 64].insert(int(child % 64) + 1);
+			}
+		}
+	}
+}
+
+
+inline void TinyBitSlotAllocator::checkSlot(size_t i, char const *fname) const {
+	if (i >= this->slots) {
+		throw std::invalid_argument("TinyBitSlotAllocator has slots 0 to " + std::to_string(this->slots) + " - 1, but "
+									+ std::to_string(i) + " was passed to " + fname + "().");
+	}
+}
+
+
+inline void TinyBitSlotAllocator::markUsed(size_t i) {
+	// clear the leaf bit, then each summary bit whose child just became full
+	size_t index = i;
+	for (size_t level = 0; level < this->levels.size(); level++) {
+		Word &word = this->levels[level][index / 64];
+		word.remove(int(index % 64) + 1);
+		if (!word.isempty()) {
+			break;
+		}
+		index /= 64;
+	}
+	this->nfree--;
+}
+
+
+inline void TinyBitSlotAllocator::markFree(size_t i) {
+	// set the leaf bit, then each summary bit whose child was full until now
+	size_t index = i;
+	for (size_t level = 0; level < this->levels.size(); level++) {
+		Word &word = this->levels[level][index / 64];
+		bool wasEmpty = word.isempty();
+		word.insert(int(index % 64) + 1);
+		if (!wasEmpty) {
+			break;
+		}
+		index /= 64;
+	}
+	this->nfree++;
+}
+
+
+inline long TinyBitSlotAllocator::leftmostFree(int level, size_t word) const {
+	// follow the lowest set bit from a non-empty word down to its leaf
+	size_t index = word;
+	for (int l = level; l >= 0; l--) {
+		index = 64 * index + size_t(this->levels[l][index].nextAfter(0) - 1);
+	}
+	return long(index);
+}
+
+
+inline long TinyBitSlotAllocator::allocate() {
+	if (this->nfree == 0) {
+		return -1;
+	}
+	long slot = leftmostFree(int(this->levels.size()) - 1, 0);
+	markUsed(size_t(slot));
+	return slot;
+}
+
+
+inline bool TinyBitSlotAllocator::release(size_t i) {
+	checkSlot(i, "release");
+	if (isFree(i)) {
+		return false;
+	}
+	markFree(i);
+	return true;
+}
+
+
+inline bool TinyBitSlotAllocator::claim(size_t i) {
+	checkSlot(i, "claim");
+	if (!isFree(i)) {
+		return false;
+	}
+	markUsed(i);
+	return true;
+}
+
+
+inline long TinyBitSlotAllocator::nextFree(long after) const {
+	/*
+	   climb until some word has a set bit right of the path, then descend along its lowest bit
+	*/
+	if (after < -1) {
+		after = -1;
+	}
+	size_t start = size_t(after + 1);
+	if (start >= this->slots) {
+		return -1;
+	}
+	size_t index = start;
+	for (size_t level = 0; level < this->levels.size(); level++) {
+		// first set bit at position >= index % 64 in this word (elements are 1 based)
+		int next = this->levels[level][index / 64].nextAfter(int(index % 64));
+		if (next != 0) {
+			size_t child = 64 * (index / 64) + size_t(next - 1);
+			return (level == 0) ? long(child) : leftmostFree(int(level) - 1, child);
+		}
+		// nothing right of us in this word, continue from the next word one level up
+		index = index / 64 + 1;
+		if (index >= this->levels[level].size()) {
+			return -1;
+		}
+	}
+	return -1;
+}
+
+
+inline bool TinyBitSlotAllocator::isFree(size_t i) const {
+	return (i < this->slots) && this->levels[0][i / 64].contains(int(i % 64) + 1);
+}
+
+
+inline size_t TinyBitSlotAllocator::freeCount() const {
+	return this->nfree;
+}
+
+
+inline size_t TinyBitSlotAllocator::capacity() const {
+	return this->slots;
+}
+
+
+
+class ShardedTinyBitSlotAllocator {
+	public:
+		// nshards = 0 uses one shard per hardware thread
+		explicit ShardedTinyBitSlotAllocator(size_t capacity, size_t nshards = 0);
+
+		// a free slot, preferring the calling thread's home shard, or -1 if every slot is in use
+		long allocate();
+		// the same, starting from shard hint % shardCount() instead of the thread's home shard
+		long allocate(size_t hint);
+		bool release(size_t i);
+
+		size_t freeCount() const;
+		size_t capacity() const;
+		size_t shardCount() const;
+
+	private:
+		// own cache lines per shard so one shard's lock and words never false-share with another's
+		struct alignas(64) Shard {
+			explicit Shard(size_t capacity) : slots(capacity) {}
+			mutable std::mutex lock;
+			TinyBitSlotAllocator slots;
+		};
+
+		std::vector<std::unique_ptr<Shard>> shards;
+		size_t pershard;
+		size_t total;
+};
+
+
+
+inline ShardedTinyBitSlotAllocator::ShardedTinyBitSlotAllocator(size_t capacity, size_t nshards) : total(capacity) {
+	if (nshards == 0) {
+		nshards = std::thread::hardware_concurrency();
+	}
+	nshards = (nshards > 0) ? nshards : 1;
+	// whole leaf words per shard, the last shard takes what is left
+	this->pershard = 64 * ((capacity / nshards + 63) / 64);
+	this->pershard = (this->pershard > 0) ? this->pershard : 64;
+	for (size_t base = 0; base < capacity; base += this->pershard) {
+		size_t n = (capacity - base < this->pershard) ? capacity - base : this->pershard;
+		this->shards.push_back(std::unique_ptr<Shard>(new Shard(n)));
+	}
+}
+
+
+inline long ShardedTinyBitSlotAllocator::allocate() {
+	return allocate(std::hash<std::thread::id>()(std::this_thread::get_id()));
+}
+
+
+inline long ShardedTinyBitSlotAllocator::allocate(size_t hint) {
+	size_t nshards = this->shards.size();
+	for (size_t k = 0; k < nshards; k++) {
+		size_t s = (hint + k) % nshards;
+		Shard &shard = *this->shards[s];
+		std::lock_guard<std::mutex> guard(shard.lock);
+		long local = shard.slots.allocate();
+		if (local >= 0) {
+			return long(s * this->pershard) + local;
+		}
+	}
+	return -1;
+}
+
+
+inline bool ShardedTinyBitSlotAllocator::release(size_t i) {
+	if (i >= this->total) {
+		throw std::invalid_argument("ShardedTinyBitSlotAllocator has slots 0 to " + std::to_string(this->total) + " - 1, but "
+									+ std::to_string(i) + " was passed to release().");
+	}
+	Shard &shard = *this->shards[i / this->pershard];
+	std::lock_guard<std::mutex> guard(shard.lock);
+	return shard.slots.release(i % this->pershard);
+}
+
+
+inline size_t ShardedTinyBitSlotAllocator::freeCount() const {
+	size_t count = 0;
+	for (std::unique_ptr<Shard> const &shard : this->shards) {
+		std::lock_guard<std::mutex> guard(shard->lock);
+		count += shard->slots.freeCount();
+	}
+	return count;
+}
+
+
+inline size_t ShardedTinyBitSlotAllocator::capacity() const {
+	return this->total;
+}
+
+
+inline size_t ShardedTinyBitSlotAllocator::shardCount() const {
+	return this->shards.size();
+}
+
+
+#endif
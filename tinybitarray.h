@@ -0,0 +1,645 @@
+/*
+contiguous array of TinyBitSets with bulk set operations, for applying one operation across many sets
+(e.g. intersecting every row with a filter mask) without a call and a bounds-checked constructor per set.
+
+TinyBitSet has no members besides its word(s), so n sets are n * sizeof(RepType) bytes back to back and the
+bit-wise operations don't care where one set ends and the next begins:
+	- element-wise (a[i] op b[i]) runs over the whole buffer as bytes, 64 at a time with AVX-512,
+	  32 with AVX2, 8 in a plain scalar loop otherwise
+	- broadcast (a[i] op mask) does the same against a 64 byte pattern of the mask repeated,
+	  when the set size divides 64 bytes (every single word size, and 2, 4 or 8 words), and set by set otherwise
+	- getSetSizes() counts 8 (VPOPCNTDQ) or 4 (AVX2 nibble lookup) single word sets per instruction
+	- containsEach(i) / isemptyEach() write one byte per set, in loops simple enough for the compiler to vectorize
+	- elementCounts() counts, for every element, the sets that contain it (positional popcount). sets of 8 .. 512
+	  bits are read as a stream of words through a carry-save adder tree (Harley-Seal), which adds into the
+	  per bit counters once every 16 rows of 8 words. other widths are counted one set bit at a time
+	- | & ^ - ~ between arrays (or an array and one set, broadcast) build an expression instead of an array.
+	  assigning it to a TinyBitSetArray runs the whole expression in one loop, 8 sets a step, so
+	  (a | b) - (c & mask) reads each input once and writes once, with no temporary arrays. the loop is
+	  compiled for AVX2 and AVX-512 too and picked by the dispatch path
+
+the byte loops and set sizes go through tinybitdispatch.h, so the AVX2 / AVX-512 versions are picked at run time.
+
+*/
+
+#ifndef TINYBITARRAY_H
+#define TINYBITARRAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "tinybitset.h"
+
+
+namespace tinybit {
+
+	// elementCounts takes under 2ns a set (scripts/comparearray.cpp): 65536 sets are ~100us, and each thread
+	// also merges MaxElems + 1 counters
+	constexpr size_t elementCountsParallelMin = size_t(1) << 16;
+
+
+	// counts[k] += the number of the n sets that contain k, k = 1 .. maxElems
+	template <typename RepType>
+	void addElementCounts(uint64_t *counts, RepType const *sets, size_t n, int maxElems) {
+		constexpr size_t setBits = 8 * sizeof(RepType);
+		unsigned char const *bytes = reinterpret_cast<unsigned char const *>(sets);
+		size_t done = 0;
+		if constexpr (512 % setBits == 0) {
+			// every 8th word holds the same elements, so the 512 counters of the kernel fold onto them
+			size_t nwords = n * sizeof(RepType) / 8;
+			uint64_t lanes[512] = {};
+			kernels().positionCounts(lanes, bytes, nwords);
+			for (size_t p = 0; p < 512; p++) {
+				if (int(p % setBits) < maxElems) {
+					counts[p % setBits + 1] += lanes[p];
+				}
+			}
+			done = nwords * 8 / sizeof(RepType);
+		}
+		// sets past the last whole word, or every set for widths 512 isn't a multiple of
+		for (size_t i = done; i < n; i++) {
+			for (size_t w = 0; w < sizeof(RepType); w += 8) {
+				uint64_t x = 0;
+				std::memcpy(&x, bytes + i * sizeof(RepType) + w, (sizeof(RepType) < 8) ? sizeof(RepType) : 8);
+				// bits past maxElems (a set built from a raw rep may have them) have no counter
+				int low = maxElems - int(8 * w);
+				if (low < 64) {
+					x &= (low > 0) ? (uint64_t(1) << low) - 1 : 0;
+				}
+				for (; x != 0; x &= x - 1) {
+					counts[8 * w + size_t(__builtin_ctzll(x)) + 1]++;
+				}
+			}
+		}
+	}
+
+}
+
+
+
+// for every k in 1 .. MaxElems, how many of the n sets contain k. the result has MaxElems + 1 entries,
+// entry 0 is always 0. with nthreads > 1 and enough sets, each thread counts a contiguous range
+template <int MaxElems, typename BoundsCheck>
+std::vector<uint64_t> elementCounts(TinyBitSet<MaxElems, BoundsCheck> const *sets, size_t n, int nthreads = 1) {
+	using RepType = TinyBitRepType<MaxElems>;
+	static_assert(sizeof(TinyBitSet<MaxElems, BoundsCheck>) == sizeof(RepType), "elementCounts needs TinyBitSet to be exactly its words");
+	RepType const *reps = reinterpret_cast<RepType const *>(sets);
+	std::vector<uint64_t> counts(MaxElems + 1, 0);
+	if ((nthreads <= 1) || (n < tinybit::elementCountsParallelMin)) {
+		tinybit::addElementCounts(counts.data(), reps, n, MaxElems);
+		return counts;
+	}
+	std::mutex merge;
+	tinybit::parallelRanges(nthreads, n, [&](size_t begin, size_t end) {
+		std::vector<uint64_t> local(MaxElems + 1, 0);
+		tinybit::addElementCounts(local.data(), reps + begin, end - begin, MaxElems);
+		std::lock_guard<std::mutex> lock(merge);
+		for (int k = 1; k <= MaxElems; k++) {
+			counts[k] += local[k];
+		}
+	});
+	return counts;
+}
+
+
+namespace tinybit {
+
+	template <typename Set>
+	struct SetTraits;
+
+	template <int MaxElems, typename BoundsCheck>
+	struct SetTraits<TinyBitSet<MaxElems, BoundsCheck>> {
+		static constexpr int maxElems = MaxElems;
+		using RepType = TinyBitRepType<MaxElems>;
+	};
+
+
+	// expression nodes over arrays of one TinyBitSet type: at(i) is the bits of the i-th result set, size() the
+	// length of the arrays in it (wholeSize for a single set, which is broadcast to any length)
+	constexpr size_t wholeSize = ~size_t(0);
+
+	template <typename Set>
+	struct SpanExpr {
+		using value_type = Set;
+		using RepType = typename SetTraits<Set>::RepType;
+
+		RepType const *reps;
+		size_t n;
+
+		TINYBIT_ALWAYS_INLINE RepType at(size_t i) const { return this->reps[i]; }
+		size_t size() const { return this->n; }
+	};
+
+	template <typename Set>
+	struct BroadcastExpr {
+		using value_type = Set;
+		using RepType = typename SetTraits<Set>::RepType;
+
+		RepType rep;
+
+		TINYBIT_ALWAYS_INLINE RepType at(size_t) const { return this->rep; }
+		size_t size() const { return wholeSize; }
+	};
+
+	template <BitOp Op, typename L, typename R>
+	struct BinaryExpr {
+		static_assert(std::is_same<typename L::value_type, typename R::value_type>::value,
+					  "TinyBitSetArray expressions need the same TinyBitSet type throughout");
+		using value_type = typename L::value_type;
+		using RepType = typename SetTraits<value_type>::RepType;
+
+		L l;
+		R r;
+		size_t n;
+
+		BinaryExpr(L const &lhs, R const &rhs) : l(lhs), r(rhs), n((lhs.size() == wholeSize) ? rhs.size() : lhs.size()) {
+			if ((lhs.size() != rhs.size()) && (lhs.size() != wholeSize) && (rhs.size() != wholeSize)) {
+				throw std::invalid_argument("TinyBitSetArray expression over arrays of size " + std::to_string(lhs.size()) + " and "
+											+ std::to_string(rhs.size()) + ".");
+			}
+		}
+
+		TINYBIT_ALWAYS_INLINE RepType at(size_t i) const { return applyOp<Op>(this->l.at(i), this->r.at(i)); }
+		size_t size() const { return this->n; }
+	};
+
+	template <typename E>
+	struct ComplementExpr {
+		using value_type = typename E::value_type;
+		using RepType = typename SetTraits<value_type>::RepType;
+
+		E e;
+		RepType mask = TinyBitRepTraits<RepType>::lowMask(SetTraits<value_type>::maxElems);
+
+		explicit ComplementExpr(E const &inner) : e(inner) {}
+
+		// bits above MaxElems stay 0, as in TinyBitSet::operator~
+		TINYBIT_ALWAYS_INLINE RepType at(size_t i) const { return static_cast<RepType>(TinyBitRepTraits<RepType>::complement(this->e.at(i)) & this->mask); }
+		size_t size() const { return this->e.size(); }
+	};
+
+
+	template <typename T>
+	struct IsSetExpr : std::false_type {};
+	template <typename Set>
+	struct IsSetExpr<SpanExpr<Set>> : std::true_type {};
+	template <typename Set>
+	struct IsSetExpr<BroadcastExpr<Set>> : std::true_type {};
+	template <BitOp Op, typename L, typename R>
+	struct IsSetExpr<BinaryExpr<Op, L, R>> : std::true_type {};
+	template <typename E>
+	struct IsSetExpr<ComplementExpr<E>> : std::true_type {};
+
+
+	// out[i] = expr.at(i), 8 sets a step, all 8 read before any is written: out may be one of the arrays
+	// of the expression, and the compiler still keeps the 8 in vector registers
+	template <typename RepType, typename Expr>
+	TINYBIT_ALWAYS_INLINE void evaluateBody(RepType *out, Expr const &expr, size_t n) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			RepType v[8];
+			for (int k = 0; k < 8; k++) {
+				v[k] = expr.at(i + k);
+			}
+			for (int k = 0; k < 8; k++) {
+				out[i + k] = v[k];
+			}
+		}
+		for (; i < n; i++) {
+			out[i] = expr.at(i);
+		}
+	}
+
+#if defined(TINYBIT_DISPATCH)
+	template <typename RepType, typename Expr>
+	TINYBIT_TARGET("avx2") void evaluateAVX2(RepType *out, Expr const &expr, size_t n) {
+		evaluateBody(out, expr, n);
+	}
+
+	template <typename RepType, typename Expr>
+	TINYBIT_TARGET("avx512f") void evaluateAVX512(RepType *out, Expr const &expr, size_t n) {
+		evaluateBody(out, expr, n);
+	}
+#endif
+
+	// the whole expression in one pass over memory, compiled for the widest vectors the dispatch path allows
+	template <typename RepType, typename Expr>
+	void evaluate(RepType *out, Expr const &expr, size_t n) {
+#if defined(TINYBIT_DISPATCH)
+		TinyBitPath path = kernels().path;
+		if (path == TinyBitPath::AVX512) {
+			evaluateAVX512(out, expr, n);
+			return;
+		}
+		if (path == TinyBitPath::AVX2) {
+			evaluateAVX2(out, expr, n);
+			return;
+		}
+#endif
+		evaluateBody(out, expr, n);
+	}
+
+}
+
+
+
+template <int MaxElems, typename BoundsCheck = TinyBitThrowCheck>
+class TinyBitSetArray {
+	public:
+		using value_type = TinyBitSet<MaxElems, BoundsCheck>;
+		using RepType = TinyBitRepType<MaxElems>;
+		using iterator = typename std::vector<value_type>::iterator;
+		using const_iterator = typename std::vector<value_type>::const_iterator;
+
+		TinyBitSetArray() {}
+		explicit TinyBitSetArray(size_t n) : sets(n) {}
+		TinyBitSetArray(size_t n, value_type const &init) : sets(n, init) {}
+
+		// the result of an expression over arrays and sets, e.g. (a | b) - (c & d), built from the operators
+		// below the class and evaluated here in one pass
+		template <typename Expr, typename = std::enable_if_t<tinybit::IsSetExpr<Expr>::value>>
+		TinyBitSetArray(Expr const &expr) { this->assign(expr); }
+		template <typename Expr, typename = std::enable_if_t<tinybit::IsSetExpr<Expr>::value>>
+		TinyBitSetArray &operator=(Expr const &expr) { this->assign(expr); return *this; }
+
+		// container access, sets[i] is an ordinary TinyBitSet
+		value_type& operator[](size_t i) { return this->sets[i]; }
+		value_type const& operator[](size_t i) const { return this->sets[i]; }
+		value_type *data() { return this->sets.data(); }
+		value_type const *data() const { return this->sets.data(); }
+		size_t size() const { return this->sets.size(); }
+		void resize(size_t n) { this->sets.resize(n); }
+		void push_back(value_type const &set) { this->sets.push_back(set); }
+		iterator begin() { return this->sets.begin(); }
+		iterator end() { return this->sets.end(); }
+		const_iterator begin() const { return this->sets.begin(); }
+		const_iterator end() const { return this->sets.end(); }
+
+		// element-wise, other must have the same size: result[i] = this[i] op other[i]
+		TinyBitSetArray unionb(TinyBitSetArray const &other) const;
+		TinyBitSetArray intersectionb(TinyBitSetArray const &other) const;
+		TinyBitSetArray leftDifference(TinyBitSetArray const &other) const;    // this[i] - other[i]
+		TinyBitSetArray rightDifference(TinyBitSetArray const &other) const;   // other[i] - this[i]
+
+		// broadcast: result[i] = this[i] op mask
+		TinyBitSetArray unionb(value_type const &mask) const;
+		TinyBitSetArray intersectionb(value_type const &mask) const;
+		TinyBitSetArray leftDifference(value_type const &mask) const;         // this[i] - mask
+		TinyBitSetArray rightDifference(value_type const &mask) const;        // mask - this[i]
+
+		// in place versions of the above
+		void unionWith(TinyBitSetArray const &other);
+		void intersectWith(TinyBitSetArray const &other);
+		void removeEach(TinyBitSetArray const &other);
+		void unionWith(value_type const &mask);
+		void intersectWith(value_type const &mask);
+		void removeEach(value_type const &mask);
+
+		// compound forms of the operators below, other an array, an expression or one set for every entry
+		template <typename Operand>
+		TinyBitSetArray &operator|=(Operand const &other);
+		template <typename Operand>
+		TinyBitSetArray &operator&=(Operand const &other);
+		template <typename Operand>
+		TinyBitSetArray &operator^=(Operand const &other);
+		template <typename Operand>
+		TinyBitSetArray &operator-=(Operand const &other);
+
+		// one entry per set
+		std::vector<int> getSetSizes() const;
+		void getSetSizes(int *out) const;   // into a caller's buffer of size() ints
+		std::vector<uint8_t> containsEach(int i) const;
+		std::vector<uint8_t> isemptyEach() const;
+
+		// per element: entry k is the number of sets containing k, see elementCounts() above
+		std::vector<uint64_t> elementCounts(int nthreads = 1) const {
+			return ::elementCounts(this->sets.data(), this->size(), nthreads);
+		}
+
+	private:
+		template <typename Expr>
+		void assign(Expr const &expr);
+		template <tinybit::BitOp Op>
+		void applyInto(TinyBitSetArray &out, TinyBitSetArray const &other, char const *fname) const;
+		template <tinybit::BitOp Op>
+		void applyInto(TinyBitSetArray &out, value_type const &mask) const;
+
+		RepType const *reps() const {
+			return reinterpret_cast<RepType const *>(this->sets.data());
+		}
+
+		std::vector<value_type> sets;
+};
+
+
+
+template <int MaxElems, typename BoundsCheck>
+template <tinybit::BitOp Op>
+void TinyBitSetArray<MaxElems, BoundsCheck>::applyInto(TinyBitSetArray &out, TinyBitSetArray const &other, char const *fname) const {
+	static_assert(sizeof(value_type) == sizeof(RepType), "TinyBitSetArray needs TinyBitSet to be exactly its words");
+	if (other.size() != this->size()) {
+		throw std::invalid_argument("TinyBitSetArray of size " + std::to_string(this->size()) + " passed an array of size "
+									+ std::to_string(other.size()) + " to " + fname + "().");
+	}
+	out.sets.resize(this->size());
+	tinybit::kernels().bitBytes[int(Op)](reinterpret_cast<unsigned char *>(out.sets.data()), reinterpret_cast<unsigned char const *>(this->sets.data()),
+										 reinterpret_cast<unsigned char const *>(other.sets.data()), ~size_t(0), this->size() * sizeof(RepType));
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+template <tinybit::BitOp Op>
+void TinyBitSetArray<MaxElems, BoundsCheck>::applyInto(TinyBitSetArray &out, value_type const &mask) const {
+	out.sets.resize(this->size());
+	RepType m = mask.getBitInt();
+	if constexpr (64 % sizeof(RepType) == 0) {
+		// the mask repeated over 128 bytes, so a 64 byte load at any offset & 63 sees it in phase
+		alignas(64) unsigned char pattern[128];
+		for (size_t k = 0; k < sizeof(pattern); k += sizeof(RepType)) {
+			std::memcpy(pattern + k, &m, sizeof(RepType));
+		}
+		tinybit::kernels().bitBytes[int(Op)](reinterpret_cast<unsigned char *>(out.sets.data()), reinterpret_cast<unsigned char const *>(this->sets.data()),
+											 pattern, 63, this->size() * sizeof(RepType));
+	} else {
+		// odd word counts: one set at a time, each already a vector loop over its words
+		RepType const *in = reps();
+		for (size_t i = 0; i < this->size(); i++) {
+			out.sets[i] = value_type(tinybit::applyOp<Op>(in[i], m));
+		}
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSetArray<MaxElems, BoundsCheck> TinyBitSetArray<MaxElems, BoundsCheck>::unionb(TinyBitSetArray const &other) const {
+	TinyBitSetArray out;
+	applyInto<tinybit::BitOp::Or>(out, other, "unionb");
+	return out;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSetArray<MaxElems, BoundsCheck> TinyBitSetArray<MaxElems, BoundsCheck>::intersectionb(TinyBitSetArray const &other) const {
+	TinyBitSetArray out;
+	applyInto<tinybit::BitOp::And>(out, other, "intersectionb");
+	return out;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSetArray<MaxElems, BoundsCheck> TinyBitSetArray<MaxElems, BoundsCheck>::leftDifference(TinyBitSetArray const &other) const {
+	TinyBitSetArray out;
+	applyInto<tinybit::BitOp::AndNot>(out, other, "leftDifference");
+	return out;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSetArray<MaxElems, BoundsCheck> TinyBitSetArray<MaxElems, BoundsCheck>::rightDifference(TinyBitSetArray const &other) const {
+	TinyBitSetArray out;
+	applyInto<tinybit::BitOp::NotAnd>(out, other, "rightDifference");
+	return out;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSetArray<MaxElems, BoundsCheck> TinyBitSetArray<MaxElems, BoundsCheck>::unionb(value_type const &mask) const {
+	TinyBitSetArray out;
+	applyInto<tinybit::BitOp::Or>(out, mask);
+	return out;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSetArray<MaxElems, BoundsCheck> TinyBitSetArray<MaxElems, BoundsCheck>::intersectionb(value_type const &mask) const {
+	TinyBitSetArray out;
+	applyInto<tinybit::BitOp::And>(out, mask);
+	return out;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSetArray<MaxElems, BoundsCheck> TinyBitSetArray<MaxElems, BoundsCheck>::leftDifference(value_type const &mask) const {
+	TinyBitSetArray out;
+	applyInto<tinybit::BitOp::AndNot>(out, mask);
+	return out;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSetArray<MaxElems, BoundsCheck> TinyBitSetArray<MaxElems, BoundsCheck>::rightDifference(value_type const &mask) const {
+	TinyBitSetArray out;
+	applyInto<tinybit::BitOp::NotAnd>(out, mask);
+	return out;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitSetArray<MaxElems, BoundsCheck>::unionWith(TinyBitSetArray const &other) {
+	applyInto<tinybit::BitOp::Or>(*this, other, "unionWith");
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitSetArray<MaxElems, BoundsCheck>::intersectWith(TinyBitSetArray const &other) {
+	applyInto<tinybit::BitOp::And>(*this, other, "intersectWith");
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitSetArray<MaxElems, BoundsCheck>::removeEach(TinyBitSetArray const &other) {
+	applyInto<tinybit::BitOp::AndNot>(*this, other, "removeEach");
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitSetArray<MaxElems, BoundsCheck>::unionWith(value_type const &mask) {
+	applyInto<tinybit::BitOp::Or>(*this, mask);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitSetArray<MaxElems, BoundsCheck>::intersectWith(value_type const &mask) {
+	applyInto<tinybit::BitOp::And>(*this, mask);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitSetArray<MaxElems, BoundsCheck>::removeEach(value_type const &mask) {
+	applyInto<tinybit::BitOp::AndNot>(*this, mask);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<int> TinyBitSetArray<MaxElems, BoundsCheck>::getSetSizes() const {
+	std::vector<int> sizes(this->size());
+	getSetSizes(sizes.data());
+	return sizes;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitSetArray<MaxElems, BoundsCheck>::getSetSizes(int *out) const {
+	tinybit::kernels().popcountEach(out, this->sets.data(), this->size(), sizeof(RepType));
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<uint8_t> TinyBitSetArray<MaxElems, BoundsCheck>::containsEach(int i) const {
+	BoundsCheck::check(i, MaxElems, "containsEach");
+	std::vector<uint8_t> found(this->size());
+	RepType const *in = reps();
+	if constexpr (MaxElems <= 64) {
+		for (size_t j = 0; j < this->size(); j++) {
+			found[j] = static_cast<uint8_t>((in[j] >> (i-1)) & 1);
+		}
+	} else {
+		// only word (i-1) / 64 of each set matters
+		int w = (i-1) / 64;
+		int shift = (i-1) % 64;
+		for (size_t j = 0; j < this->size(); j++) {
+			found[j] = static_cast<uint8_t>((in[j].words[w] >> shift) & 1);
+		}
+	}
+	return found;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<uint8_t> TinyBitSetArray<MaxElems, BoundsCheck>::isemptyEach() const {
+	std::vector<uint8_t> empty(this->size());
+	RepType const *in = reps();
+	for (size_t j = 0; j < this->size(); j++) {
+		empty[j] = static_cast<uint8_t>(TinyBitRepTraits<RepType>::isZero(in[j]));
+	}
+	return empty;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+template <typename Expr>
+void TinyBitSetArray<MaxElems, BoundsCheck>::assign(Expr const &expr) {
+	static_assert(std::is_same<typename Expr::value_type, value_type>::value, "TinyBitSetArray assigned an expression over another TinyBitSet type");
+	static_assert(sizeof(value_type) == sizeof(RepType), "TinyBitSetArray needs TinyBitSet to be exactly its words");
+	// an array of the expression is this one only when the sizes already match, so resizing moves nothing it reads
+	this->sets.resize(expr.size());
+	tinybit::evaluate(reinterpret_cast<RepType *>(this->sets.data()), expr, expr.size());
+}
+
+
+
+namespace tinybit {
+
+	template <typename Expr, typename = std::enable_if_t<IsSetExpr<Expr>::value>>
+	Expr const &asExpr(Expr const &expr) {
+		return expr;
+	}
+
+	template <int MaxElems, typename BoundsCheck>
+	SpanExpr<TinyBitSet<MaxElems, BoundsCheck>> asExpr(TinyBitSetArray<MaxElems, BoundsCheck> const &array) {
+		return SpanExpr<TinyBitSet<MaxElems, BoundsCheck>>{reinterpret_cast<TinyBitRepType<MaxElems> const *>(array.data()), array.size()};
+	}
+
+	template <int MaxElems, typename BoundsCheck>
+	BroadcastExpr<TinyBitSet<MaxElems, BoundsCheck>> asExpr(TinyBitSet<MaxElems, BoundsCheck> const &set) {
+		return BroadcastExpr<TinyBitSet<MaxElems, BoundsCheck>>{set.getBitInt()};
+	}
+
+	// an array of n sets somewhere else, to use in expressions: setSpan(p, n) | mask
+	template <int MaxElems, typename BoundsCheck>
+	SpanExpr<TinyBitSet<MaxElems, BoundsCheck>> setSpan(TinyBitSet<MaxElems, BoundsCheck> const *sets, size_t n) {
+		static_assert(sizeof(TinyBitSet<MaxElems, BoundsCheck>) == sizeof(TinyBitRepType<MaxElems>), "setSpan needs TinyBitSet to be exactly its words");
+		return SpanExpr<TinyBitSet<MaxElems, BoundsCheck>>{reinterpret_cast<TinyBitRepType<MaxElems> const *>(sets), n};
+	}
+
+
+	// arrays and expressions are operands, a single set only next to one of them
+	template <typename T>
+	struct IsArrayOperand : IsSetExpr<T> {};
+	template <int MaxElems, typename BoundsCheck>
+	struct IsArrayOperand<TinyBitSetArray<MaxElems, BoundsCheck>> : std::true_type {};
+
+	template <typename T>
+	struct IsSetOperand : std::false_type {};
+	template <int MaxElems, typename BoundsCheck>
+	struct IsSetOperand<TinyBitSet<MaxElems, BoundsCheck>> : std::true_type {};
+
+	template <typename A, typename B>
+	constexpr bool exprOperands = (IsArrayOperand<A>::value && (IsArrayOperand<B>::value || IsSetOperand<B>::value))
+								  || (IsSetOperand<A>::value && IsArrayOperand<B>::value);
+
+	template <BitOp Op, typename A, typename B>
+	auto makeBinary(A const &a, B const &b) {
+		using L = std::decay_t<decltype(asExpr(a))>;
+		using R = std::decay_t<decltype(asExpr(b))>;
+		return BinaryExpr<Op, L, R>(asExpr(a), asExpr(b));
+	}
+
+}
+
+
+// element-wise set algebra over TinyBitSetArrays: nothing runs until the expression is assigned to an array,
+// then every operator of it runs in the same loop. the arrays must outlive the expression
+template <typename A, typename B, typename = std::enable_if_t<tinybit::exprOperands<A, B>>>
+auto operator|(A const &a, B const &b) {
+	return tinybit::makeBinary<tinybit::BitOp::Or>(a, b);
+}
+
+template <typename A, typename B, typename = std::enable_if_t<tinybit::exprOperands<A, B>>>
+auto operator&(A const &a, B const &b) {
+	return tinybit::makeBinary<tinybit::BitOp::And>(a, b);
+}
+
+template <typename A, typename B, typename = std::enable_if_t<tinybit::exprOperands<A, B>>>
+auto operator^(A const &a, B const &b) {
+	return tinybit::makeBinary<tinybit::BitOp::Xor>(a, b);
+}
+
+template <typename A, typename B, typename = std::enable_if_t<tinybit::exprOperands<A, B>>>
+auto operator-(A const &a, B const &b) {
+	return tinybit::makeBinary<tinybit::BitOp::AndNot>(a, b);
+}
+
+template <typename A, typename = std::enable_if_t<tinybit::IsArrayOperand<A>::value>>
+auto operator~(A const &a) {
+	using E = std::decay_t<decltype(tinybit::asExpr(a))>;
+	return tinybit::ComplementExpr<E>(tinybit::asExpr(a));
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+template <typename Operand>
+TinyBitSetArray<MaxElems, BoundsCheck> &TinyBitSetArray<MaxElems, BoundsCheck>::operator|=(Operand const &other) {
+	this->assign(*this | other);
+	return *this;
+}
+
+template <int MaxElems, typename BoundsCheck>
+template <typename Operand>
+TinyBitSetArray<MaxElems, BoundsCheck> &TinyBitSetArray<MaxElems, BoundsCheck>::operator&=(Operand const &other) {
+	this->assign(*this & other);
+	return *this;
+}
+
+template <int MaxElems, typename BoundsCheck>
+template <typename Operand>
+TinyBitSetArray<MaxElems, BoundsCheck> &TinyBitSetArray<MaxElems, BoundsCheck>::operator^=(Operand const &other) {
+	this->assign(*this ^ other);
+	return *this;
+}
+
+template <int MaxElems, typename BoundsCheck>
+template <typename Operand>
+TinyBitSetArray<MaxElems, BoundsCheck> &TinyBitSetArray<MaxElems, BoundsCheck>::operator-=(Operand const &other) {
+	this->assign(*this - other);
+	return *this;
+}
+
+
+#endif
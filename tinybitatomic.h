@@ -0,0 +1,168 @@
+/*
+lock-free TinyBitSet for sets shared between threads, e.g. a mask of free worker slots.
+
+wraps a std::atomic of the same exact-width integer TinyBitSet uses (so MaxElems <= 64):
+	- insert/remove are one fetch_or/fetch_and and report whether the integer was already there,
+	  so insert doubles as "claim this slot" and remove as "release it"
+	- tryPopSmallest/tryPopLargest claim the lowest/highest element with a compare-exchange loop,
+	  retrying only when another thread changed the word in between
+	- load() takes a plain TinyBitSet snapshot for everything else (iteration, set-wise ops, ...)
+
+read-modify-writes are acq_rel and loads are acquire, so whatever a thread wrote before
+releasing a slot is visible to the thread that claims it next.
+
+*/
+
+#ifndef TINYBITATOMIC_H
+#define TINYBITATOMIC_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "tinybitset.h"
+
+
+template <int MaxElems, typename BoundsCheck = TinyBitThrowCheck>
+class AtomicTinyBitSet {
+	static_assert(MaxElems <= 64, "AtomicTinyBitSet works on single word TinyBitSets (MaxElems <= 64)");
+
+	public:
+		using RepType = TinyBitRepType<MaxElems>;
+
+		AtomicTinyBitSet() : tinybitrep(0) {}
+		explicit AtomicTinyBitSet(TinyBitSet<MaxElems, BoundsCheck> const &init) : tinybitrep(init.getBitInt()) {}
+
+		AtomicTinyBitSet(AtomicTinyBitSet const &) = delete;
+		AtomicTinyBitSet& operator=(AtomicTinyBitSet const &) = delete;
+
+		// element-wise, each returns whether i was in the set before the call
+		bool insert(int i);
+		bool remove(int i);
+		bool contains(int i) const;
+
+		// claim an element, 0 if the set was empty
+		int tryPopSmallest();
+		int tryPopLargest();
+
+		// whole-set access
+		TinyBitSet<MaxElems, BoundsCheck> load() const;
+		void store(TinyBitSet<MaxElems, BoundsCheck> const &set);
+		TinyBitSet<MaxElems, BoundsCheck> exchange(TinyBitSet<MaxElems, BoundsCheck> const &set);
+		void fill();
+		void removeall();
+		int getSetSize() const;
+		bool isempty() const;
+
+		static constexpr bool isLockFree() {
+			return std::atomic<RepType>::is_always_lock_free;
+		}
+
+	private:
+		static RepType bit(int i) {
+			return static_cast<RepType>(static_cast<RepType>(1) << (i-1));
+		}
+
+		std::atomic<RepType> tinybitrep;
+};
+
+
+
+template <int MaxElems, typename BoundsCheck>
+bool AtomicTinyBitSet<MaxElems, BoundsCheck>::insert(int i) {
+	BoundsCheck::check(i, MaxElems, "insert");
+	RepType b = bit(i);
+	return (this->tinybitrep.fetch_or(b, std::memory_order_acq_rel) & b) != 0;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+bool AtomicTinyBitSet<MaxElems, BoundsCheck>::remove(int i) {
+	BoundsCheck::check(i, MaxElems, "remove");
+	RepType b = bit(i);
+	return (this->tinybitrep.fetch_and(static_cast<RepType>(~b), std::memory_order_acq_rel) & b) != 0;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+bool AtomicTinyBitSet<MaxElems, BoundsCheck>::contains(int i) const {
+	BoundsCheck::check(i, MaxElems, "contains");
+	return (this->tinybitrep.load(std::memory_order_acquire) & bit(i)) != 0;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+int AtomicTinyBitSet<MaxElems, BoundsCheck>::tryPopSmallest() {
+	/*
+	   returns 0 if empty, otherwise removes and returns the smallest element,
+	   on a failed compare-exchange cur is reloaded and the lowest bit recomputed
+	*/
+	RepType cur = this->tinybitrep.load(std::memory_order_acquire);
+	while (cur != 0) {
+		RepType next = static_cast<RepType>(cur & (cur - 1));
+		if (this->tinybitrep.compare_exchange_weak(cur, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+			return __builtin_ctzll(static_cast<unsigned long long>(cur)) + 1;
+		}
+	}
+	return 0;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+int AtomicTinyBitSet<MaxElems, BoundsCheck>::tryPopLargest() {
+	RepType cur = this->tinybitrep.load(std::memory_order_acquire);
+	while (cur != 0) {
+		int pos = 63 - __builtin_clzll(static_cast<unsigned long long>(cur));
+		RepType next = static_cast<RepType>(cur & ~(static_cast<RepType>(1) << pos));
+		if (this->tinybitrep.compare_exchange_weak(cur, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+			return pos + 1;
+		}
+	}
+	return 0;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSet<MaxElems, BoundsCheck> AtomicTinyBitSet<MaxElems, BoundsCheck>::load() const {
+	return TinyBitSet<MaxElems, BoundsCheck>(this->tinybitrep.load(std::memory_order_acquire));
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void AtomicTinyBitSet<MaxElems, BoundsCheck>::store(TinyBitSet<MaxElems, BoundsCheck> const &set) {
+	this->tinybitrep.store(set.getBitInt(), std::memory_order_release);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSet<MaxElems, BoundsCheck> AtomicTinyBitSet<MaxElems, BoundsCheck>::exchange(TinyBitSet<MaxElems, BoundsCheck> const &set) {
+	return TinyBitSet<MaxElems, BoundsCheck>(this->tinybitrep.exchange(set.getBitInt(), std::memory_order_acq_rel));
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void AtomicTinyBitSet<MaxElems, BoundsCheck>::fill() {
+	TinyBitSet<MaxElems, BoundsCheck> full;
+	full.fill();
+	store(full);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void AtomicTinyBitSet<MaxElems, BoundsCheck>::removeall() {
+	this->tinybitrep.store(0, std::memory_order_release);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+int AtomicTinyBitSet<MaxElems, BoundsCheck>::getSetSize() const {
+	return load().getSetSize();
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+bool AtomicTinyBitSet<MaxElems, BoundsCheck>::isempty() const {
+	return this->tinybitrep.load(std::memory_order_acquire) == 0;
+}
+
+
+#endif
@@ -0,0 +1,454 @@
+/*
+index over a changing collection of TinyBitSets for containment queries, e.g. rule requirement masks
+asked "which rules does this fact set satisfy":
+
+	subsetsOf(q)      ids of every stored set s with s <= q   (s - q empty)
+	supersetsOf(q)    ids of every stored set s with s >= q   (q - s empty)
+
+the sets are kept in a set-trie: a node at depth d stands for the sets whose d smallest elements are its path,
+and has one child per (d+1)-th element that occurs. the trie is "burst": a leaf keeps every set under its path
+in a flat array until it holds more than containmentLeafSize of them, and only then splits into children,
+so the bottom of the trie is a few short arrays instead of one node per element.
+
+subsetsOf follows only the children whose element is in q, so paths through any element outside q are never
+visited, and every set ending at an inner node is its path, so already a subset. the trie does little for
+supersets of a small q: the sets through a child below q's smallest element may still hold all of q, and a leaf
+of 512 short sets holds nearly every element between them. so every element also keeps a posting list of the
+sets that contain it, and supersetsOf scans the shortest list among q's elements: for a 2 element q over sets
+of 2 - 6 of 64 elements, about 1 / 16 of the sets instead of all of them. the lists hold each set once per
+element, so sets of k elements take k + 1 times the memory of the trie alone.
+
+leaves are checked in blocks of 256 sets with the dispatch overlap kernel: s <= q exactly when |s | q| == |q|,
+and s >= q when |s & q| == |q|. a posting list is checked with (s & q) == q inline, without a branch per set.
+a node's children are found by rank() in its mask of child elements.
+
+insert() returns an id, remove(id) frees it for reuse (emptied nodes stay). a removed set stays in its posting
+lists, skipped by the id's generation, until half of a list is stale and it is compacted. ids in query results
+are not sorted: sort them if the order matters. the batched queries split the queries across threads, the index
+itself is not locked, so insert / remove must not run while a query does.
+
+*/
+
+#ifndef TINYBITCONTAINMENT_H
+#define TINYBITCONTAINMENT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tinybitset.h"
+
+
+namespace tinybit {
+
+	// sets a leaf holds before it splits
+	constexpr size_t containmentLeafSize = 512;
+
+	// sets per call to the overlap kernel
+	constexpr size_t containmentBlock = 256;
+
+}
+
+
+
+template <int MaxElems, typename BoundsCheck = TinyBitThrowCheck>
+class TinyBitContainmentIndex {
+	public:
+		using value_type = TinyBitSet<MaxElems, BoundsCheck>;
+
+		TinyBitContainmentIndex();
+
+		size_t insert(value_type const &set);
+		// frees id, returns false if it was already removed
+		bool remove(size_t id);
+
+		bool contains(size_t id) const;
+		value_type get(size_t id) const;
+		size_t size() const;
+
+		std::vector<size_t> subsetsOf(value_type const &query) const;
+		std::vector<size_t> supersetsOf(value_type const &query) const;
+		// one result per query, split over nthreads threads
+		std::vector<std::vector<size_t>> subsetsOf(value_type const *queries, size_t n, int nthreads = 1) const;
+		std::vector<std::vector<size_t>> supersetsOf(value_type const *queries, size_t n, int nthreads = 1) const;
+
+	private:
+		using RepType = TinyBitRepType<MaxElems>;
+
+		struct Node {
+			value_type childElems;          // the (depth+1)-th elements that have a child
+			std::vector<size_t> children;   // node indexes, in element order
+			std::vector<RepType> sets;      // a leaf: every set under the path, otherwise the sets equal to the path
+			std::vector<size_t> ids;
+			int depth;
+			int last;                       // largest element of the path, 0 at the root
+			bool leaf;
+		};
+
+		// where an id is stored, node == removed once it is freed. generation counts the inserts under the id
+		struct Location {
+			size_t node;
+			size_t at;
+			size_t generation;
+		};
+
+		// the sets holding one element, and the generation of their id when they were added
+		struct Posting {
+			std::vector<RepType> sets;
+			std::vector<size_t> ids;
+			std::vector<size_t> generations;
+			size_t stale = 0;
+		};
+
+		static constexpr size_t removed = ~size_t(0);
+
+		void checkId(size_t id, char const *fname) const;
+		size_t childFor(size_t node, int elem);
+		void place(size_t node, RepType const &rep, size_t id);
+		void burst(size_t node);
+		void scanLeaf(std::vector<size_t> &out, Node const &node, RepType const &query, int querySize, bool subsets) const;
+		void collect(std::vector<size_t> &out, size_t node) const;
+		void subsetsFrom(std::vector<size_t> &out, size_t node, value_type const &q, RepType const &rep, int querySize) const;
+		bool current(size_t id, size_t generation) const;
+		void post(RepType const &rep, size_t id);
+		void unpost(RepType const &rep);
+		void scanPosting(std::vector<size_t> &out, Posting const &posting, RepType const &query) const;
+		void supersets(std::vector<size_t> &out, value_type const &q) const;
+		std::vector<size_t> query(value_type const &q, bool subsets) const;
+		std::vector<std::vector<size_t>> queryAll(value_type const *queries, size_t n, int nthreads, bool subsets) const;
+
+		std::vector<Node> nodes;   // nodes[0] is the root
+		std::vector<Location> locations;
+		std::vector<Posting> postings;   // postings[e - 1] for element e
+		std::vector<size_t> freeIds;
+		size_t count;
+};
+
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitContainmentIndex<MaxElems, BoundsCheck>::TinyBitContainmentIndex() : postings(MaxElems), count(0) {
+	this->nodes.push_back(Node{value_type(), {}, {}, {}, 0, 0, true});
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitContainmentIndex<MaxElems, BoundsCheck>::checkId(size_t id, char const *fname) const {
+	if (id >= this->locations.size()) {
+		throw std::invalid_argument("TinyBitContainmentIndex has given out ids 0 to " + std::to_string(this->locations.size()) + " - 1, but "
+									+ std::to_string(id) + " was passed to " + fname + "().");
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+size_t TinyBitContainmentIndex<MaxElems, BoundsCheck>::childFor(size_t node, int elem) {
+	/*
+	   the child of node for elem, made as an empty leaf if there isn't one yet
+	*/
+	size_t at = size_t(this->nodes[node].childElems.rank(elem));
+	if (this->nodes[node].childElems.contains(elem)) {
+		return this->nodes[node].children[at - 1];
+	}
+	size_t child = this->nodes.size();
+	this->nodes.push_back(Node{value_type(), {}, {}, {}, this->nodes[node].depth + 1, elem, true});
+	this->nodes[node].childElems.insert(elem);
+	this->nodes[node].children.insert(this->nodes[node].children.begin() + long(at), child);
+	return child;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitContainmentIndex<MaxElems, BoundsCheck>::place(size_t node, RepType const &rep, size_t id) {
+	Node &n = this->nodes[node];
+	this->locations[id].node = node;
+	this->locations[id].at = n.sets.size();
+	n.sets.push_back(rep);
+	n.ids.push_back(id);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitContainmentIndex<MaxElems, BoundsCheck>::burst(size_t node) {
+	/*
+	   turn a full leaf into an inner node: sets equal to the path stay, the rest move down by their next element
+	*/
+	std::vector<RepType> sets;
+	std::vector<size_t> ids;
+	sets.swap(this->nodes[node].sets);
+	ids.swap(this->nodes[node].ids);
+	this->nodes[node].leaf = false;
+	for (size_t i = 0; i < sets.size(); i++) {
+		value_type s(sets[i]);
+		if (s.getSetSize() == this->nodes[node].depth) {
+			place(node, sets[i], ids[i]);
+		} else {
+			place(childFor(node, s.nextAfter(this->nodes[node].last)), sets[i], ids[i]);
+		}
+	}
+	for (size_t j = 0; j < this->nodes[node].children.size(); j++) {
+		size_t child = this->nodes[node].children[j];
+		if (this->nodes[child].sets.size() > tinybit::containmentLeafSize) {
+			burst(child);
+		}
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+size_t TinyBitContainmentIndex<MaxElems, BoundsCheck>::insert(value_type const &set) {
+	size_t id;
+	if (this->freeIds.empty()) {
+		id = this->locations.size();
+		this->locations.push_back(Location{removed, 0, 0});
+	} else {
+		id = this->freeIds.back();
+		this->freeIds.pop_back();
+	}
+	this->locations[id].generation++;
+	int size = set.getSetSize();
+	size_t node = 0;
+	while (!this->nodes[node].leaf && (this->nodes[node].depth < size)) {
+		node = childFor(node, set.nextAfter(this->nodes[node].last));
+	}
+	place(node, set.getBitInt(), id);
+	if (this->nodes[node].leaf && (this->nodes[node].sets.size() > tinybit::containmentLeafSize)) {
+		burst(node);
+	}
+	post(set.getBitInt(), id);
+	this->count++;
+	return id;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+bool TinyBitContainmentIndex<MaxElems, BoundsCheck>::remove(size_t id) {
+	checkId(id, "remove");
+	Location where = this->locations[id];
+	if (where.node == removed) {
+		return false;
+	}
+	// the node's last set moves into the hole
+	Node &n = this->nodes[where.node];
+	RepType rep = n.sets[where.at];
+	n.sets[where.at] = n.sets.back();
+	n.ids[where.at] = n.ids.back();
+	this->locations[n.ids[where.at]].at = where.at;
+	n.sets.pop_back();
+	n.ids.pop_back();
+	this->locations[id].node = removed;
+	unpost(rep);
+	this->freeIds.push_back(id);
+	this->count--;
+	return true;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+bool TinyBitContainmentIndex<MaxElems, BoundsCheck>::contains(size_t id) const {
+	return (id < this->locations.size()) && (this->locations[id].node != removed);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSet<MaxElems, BoundsCheck> TinyBitContainmentIndex<MaxElems, BoundsCheck>::get(size_t id) const {
+	checkId(id, "get");
+	Location where = this->locations[id];
+	if (where.node == removed) {
+		throw std::invalid_argument("TinyBitContainmentIndex id " + std::to_string(id) + " was removed before get().");
+	}
+	return value_type(this->nodes[where.node].sets[where.at]);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+size_t TinyBitContainmentIndex<MaxElems, BoundsCheck>::size() const {
+	return this->count;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitContainmentIndex<MaxElems, BoundsCheck>::scanLeaf(std::vector<size_t> &out, Node const &node, RepType const &query, int querySize,
+															  bool subsets) const {
+	int common[tinybit::containmentBlock];
+	int combined[tinybit::containmentBlock];
+	size_t n = node.sets.size();
+	for (size_t b = 0; b < n; b += tinybit::containmentBlock) {
+		size_t len = std::min(tinybit::containmentBlock, n - b);
+		tinybit::kernels().overlapCounts(common, combined, node.sets.data() + b, len, sizeof(RepType), &query);
+		int const *hits = subsets ? combined : common;
+		for (size_t j = 0; j < len; j++) {
+			if (hits[j] == querySize) {
+				out.push_back(node.ids[b + j]);
+			}
+		}
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitContainmentIndex<MaxElems, BoundsCheck>::collect(std::vector<size_t> &out, size_t node) const {
+	Node const &n = this->nodes[node];
+	out.insert(out.end(), n.ids.begin(), n.ids.end());
+	for (size_t child : n.children) {
+		collect(out, child);
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitContainmentIndex<MaxElems, BoundsCheck>::subsetsFrom(std::vector<size_t> &out, size_t node, value_type const &q, RepType const &rep,
+																 int querySize) const {
+	// the path is already a subset of q
+	Node const &n = this->nodes[node];
+	if (n.leaf) {
+		scanLeaf(out, n, rep, querySize, true);
+		return;
+	}
+	out.insert(out.end(), n.ids.begin(), n.ids.end());
+	value_type next = n.childElems.intersectionb(q);
+	for (int e : next) {
+		subsetsFrom(out, n.children[size_t(n.childElems.rank(e)) - 1], q, rep, querySize);
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+bool TinyBitContainmentIndex<MaxElems, BoundsCheck>::current(size_t id, size_t generation) const {
+	return (this->locations[id].node != removed) && (this->locations[id].generation == generation);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitContainmentIndex<MaxElems, BoundsCheck>::post(RepType const &rep, size_t id) {
+	for (int e : value_type(rep)) {
+		Posting &p = this->postings[size_t(e) - 1];
+		p.sets.push_back(rep);
+		p.ids.push_back(id);
+		p.generations.push_back(this->locations[id].generation);
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitContainmentIndex<MaxElems, BoundsCheck>::unpost(RepType const &rep) {
+	/*
+	   the removed set's entries stay until half of a list is stale, then the list keeps only the current ones
+	*/
+	for (int e : value_type(rep)) {
+		Posting &p = this->postings[size_t(e) - 1];
+		p.stale++;
+		if (2 * p.stale <= p.ids.size()) {
+			continue;
+		}
+		size_t kept = 0;
+		for (size_t i = 0; i < p.ids.size(); i++) {
+			if (current(p.ids[i], p.generations[i])) {
+				p.sets[kept] = p.sets[i];
+				p.ids[kept] = p.ids[i];
+				p.generations[kept] = p.generations[i];
+				kept++;
+			}
+		}
+		p.sets.resize(kept);
+		p.ids.resize(kept);
+		p.generations.resize(kept);
+		p.stale = 0;
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitContainmentIndex<MaxElems, BoundsCheck>::scanPosting(std::vector<size_t> &out, Posting const &posting, RepType const &query) const {
+	// every position is written and kept only when its set holds the query, so the loop has no branch to miss
+	size_t n = posting.sets.size();
+	size_t base = out.size();
+	out.resize(base + n);
+	size_t k = base;
+	for (size_t i = 0; i < n; i++) {
+		out[k] = i;
+		k += ((posting.sets[i] & query) == query) ? 1 : 0;
+	}
+	// positions to ids, leaving out the sets removed since (the locations aren't read while nothing is stale)
+	size_t kept = base;
+	for (size_t j = base; j < k; j++) {
+		size_t i = out[j];
+		if ((posting.stale == 0) || current(posting.ids[i], posting.generations[i])) {
+			out[kept++] = posting.ids[i];
+		}
+	}
+	out.resize(kept);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitContainmentIndex<MaxElems, BoundsCheck>::supersets(std::vector<size_t> &out, value_type const &q) const {
+	// every stored set is a superset of the empty set, otherwise each superset is on the list of every element of q
+	if (q.isempty()) {
+		collect(out, 0);
+		return;
+	}
+	Posting const *shortest = nullptr;
+	for (int e : q) {
+		Posting const &p = this->postings[size_t(e) - 1];
+		if ((shortest == nullptr) || (p.ids.size() < shortest->ids.size())) {
+			shortest = &p;
+		}
+	}
+	scanPosting(out, *shortest, q.getBitInt());
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<size_t> TinyBitContainmentIndex<MaxElems, BoundsCheck>::query(value_type const &q, bool subsets) const {
+	std::vector<size_t> out;
+	if (subsets) {
+		subsetsFrom(out, 0, q, q.getBitInt(), q.getSetSize());
+	} else {
+		supersets(out, q);
+	}
+	return out;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<std::vector<size_t>> TinyBitContainmentIndex<MaxElems, BoundsCheck>::queryAll(value_type const *queries, size_t n, int nthreads,
+																							 bool subsets) const {
+	std::vector<std::vector<size_t>> results(n);
+	tinybit::parallelRanges(nthreads, n, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			results[i] = query(queries[i], subsets);
+		}
+	});
+	return results;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<size_t> TinyBitContainmentIndex<MaxElems, BoundsCheck>::subsetsOf(value_type const &q) const {
+	return query(q, true);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<size_t> TinyBitContainmentIndex<MaxElems, BoundsCheck>::supersetsOf(value_type const &q) const {
+	return query(q, false);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<std::vector<size_t>> TinyBitContainmentIndex<MaxElems, BoundsCheck>::subsetsOf(value_type const *queries, size_t n, int nthreads) const {
+	return queryAll(queries, n, nthreads, true);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<std::vector<size_t>> TinyBitContainmentIndex<MaxElems, BoundsCheck>::supersetsOf(value_type const *queries, size_t n, int nthreads) const {
+	return queryAll(queries, n, nthreads, false);
+}
+
+
+#endif
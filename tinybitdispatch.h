@@ -0,0 +1,828 @@
+/*
+runtime cpu dispatch for the kernels that depend most on the instruction set, for binaries built for
+a baseline x86-64 (no -mpopcnt / -march) that still need popcnt, pdep and AVX2 / AVX-512 where the cpu has them.
+
+each kernel is compiled several times with gcc/clang target attributes, one table of function pointers per path:
+
+	Scalar   plain C++, whatever the global flags allow
+	Popcnt   + popcnt
+	AVX2     + AVX2, BMI1/2, lzcnt (Haswell, Zen and later)
+	AVX512   + AVX-512F and VPOPCNTDQ (Ice Lake, Zen 4 and later)
+
+the best path the cpu (and os) supports is picked the first time kernels() is called. setting the environment
+variable TINYBIT_PATH to scalar / popcnt / avx2 / avx512 caps it at startup, and forcePath() switches it
+at any time, for testing and benchmarking every path on one machine. forcePath() is meant for test setup:
+it is safe to call while other threads use the kernels, but they may finish a call on the old path.
+
+TinyBitSet itself only goes through the table where the build can't do better at compile time: with
+-mpopcnt / -mbmi2 / -mavx2 the inline instructions are used directly. on zen 1 and 2 pdep / pext are
+microcoded (hundreds of cycles), so there the tables keep the software versions and fastPdep is false.
+
+on non-x86 targets or other compilers every path is the scalar one.
+
+*/
+
+#ifndef TINYBITDISPATCH_H
+#define TINYBITDISPATCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TINYBIT_DISPATCH 1
+#include <immintrin.h>
+#define TINYBIT_TARGET(isa) __attribute__((target(isa)))
+#define TINYBIT_ALWAYS_INLINE __attribute__((always_inline)) inline
+#else
+#define TINYBIT_TARGET(isa)
+#define TINYBIT_ALWAYS_INLINE inline
+#endif
+
+
+enum class TinyBitPath : int { Scalar = 0, Popcnt = 1, AVX2 = 2, AVX512 = 3 };
+
+
+namespace tinybit {
+
+	// the bitBytes kernels cover the first four, Xor is only used by the array expressions
+	enum class BitOp : int { Or = 0, And = 1, AndNot = 2, NotAnd = 3, Xor = 4 };
+
+	// a | b, a & b, a - b, b - a, a ^ b on integers and TinyBitWords
+	template <BitOp Op, typename T>
+	constexpr T applyOp(T a, T b) {
+		if constexpr (Op == BitOp::Or) {
+			return static_cast<T>(a | b);
+		} else if constexpr (Op == BitOp::And) {
+			return static_cast<T>(a & b);
+		} else if constexpr (Op == BitOp::AndNot) {
+			return static_cast<T>(a & ~b);
+		} else if constexpr (Op == BitOp::NotAnd) {
+			return static_cast<T>(~a & b);
+		} else {
+			return static_cast<T>(a ^ b);
+		}
+	}
+
+
+	// run fn(begin, end) over [0, total) split into nthreads contiguous ranges. starting and joining a thread
+	// costs about 10us (x86-64 linux), which is what the ParallelMin thresholds of the callers weigh their own
+	// per item cost against: below them a call runs on one thread whatever nthreads is
+	template <typename Fn>
+	void parallelRanges(int nthreads, size_t total, Fn fn) {
+		if ((nthreads <= 1) || (total < 2)) {
+			fn(size_t(0), total);
+			return;
+		}
+		std::vector<std::thread> workers;
+		size_t chunk = (total + nthreads - 1) / nthreads;
+		for (int t = 0; t < nthreads; t++) {
+			size_t begin = t * chunk;
+			size_t end = (begin + chunk < total) ? begin + chunk : total;
+			if (begin >= end) {
+				break;
+			}
+			workers.emplace_back(fn, begin, end);
+		}
+		for (std::thread &worker : workers) {
+			worker.join();
+		}
+	}
+
+
+	struct Kernels {
+		TinyBitPath path;
+		bool fastPdep;
+
+		int (*popcount)(uint64_t x);
+		uint64_t (*pdep)(uint64_t src, uint64_t mask);
+		uint64_t (*pext)(uint64_t src, uint64_t mask);
+
+		// total set bits of n words
+		uint64_t (*popcountWords)(uint64_t const *words, size_t n);
+		// out[i] = set bits of the i-th of n sets of setBytes bytes each (1, 2, 4 or a multiple of 8)
+		void (*popcountEach)(int *out, void const *sets, size_t n, size_t setBytes);
+		// out[i] = a[i] op b[i & bmask] over bytes bytes, indexed by BitOp. bmask is ~0 for two buffers,
+		// or 63 for b a 128 byte pattern repeating every 64 bytes. out may be a
+		void (*bitBytes[4])(unsigned char *out, unsigned char const *a, unsigned char const *b, size_t bmask, size_t bytes);
+		// counts[64 * (i % 8) + j] += bit j of word i, over n words (so 512 counters, added to)
+		void (*positionCounts)(uint64_t *counts, void const *words, size_t n);
+		// common[i] = set bits of (set i & query), combined[i] = of (set i | query), sets laid out as for popcountEach
+		void (*overlapCounts)(int *common, int *combined, void const *sets, size_t n, size_t setBytes, void const *query);
+		// out[i * ldo + j] = set bits of (a set i & b set j), for na x nb sets of setBytes bytes each
+		void (*joinCounts)(int *out, size_t ldo, void const *a, size_t na, void const *b, size_t nb, size_t setBytes);
+		// in place bit transpose of n groups of 8 blocks of width words each (width 8, 16, 32 or 64), word k of block l
+		// of a group at [8 * k + l]. lane q (width bits) of word k stands for row k + q * width of the block, and
+		// afterwards word c holds bit c of all 64 rows, row r at bit r
+		void (*transposeBits)(uint64_t *words, size_t n, int width);
+	};
+
+
+	// ---- bodies shared by every path, inlined into each target-specific wrapper below ----
+
+	// one step per bit of mask, without branches on the data
+	TINYBIT_ALWAYS_INLINE constexpr uint64_t pdepSoftware(uint64_t src, uint64_t mask) {
+		uint64_t r = 0;
+		for (; mask; mask &= mask - 1, src >>= 1) {
+			r |= mask & (~mask + 1) & (0 - (src & 1));
+		}
+		return r;
+	}
+
+	TINYBIT_ALWAYS_INLINE constexpr uint64_t pextSoftware(uint64_t src, uint64_t mask) {
+		uint64_t r = 0;
+		for (uint64_t bb = 1; mask; bb += bb) {
+			r |= bb & (0 - uint64_t((src & mask & (~mask + 1)) != 0));
+			mask &= mask - 1;
+		}
+		return r;
+	}
+
+
+	TINYBIT_ALWAYS_INLINE uint64_t popcountWordsBody(uint64_t const *words, size_t i, size_t n) {
+		uint64_t total = 0;
+		for (; i < n; i++) {
+			total += uint64_t(__builtin_popcountll(words[i]));
+		}
+		return total;
+	}
+
+	TINYBIT_ALWAYS_INLINE void popcountEachBody(int *out, unsigned char const *sets, size_t i, size_t n, size_t setBytes) {
+		if (setBytes == 1) {
+			for (; i < n; i++) {
+				out[i] = __builtin_popcount(sets[i]);
+			}
+		} else if (setBytes == 2) {
+			for (; i < n; i++) {
+				uint16_t x;
+				std::memcpy(&x, sets + 2 * i, 2);
+				out[i] = __builtin_popcount(x);
+			}
+		} else if (setBytes == 4) {
+			for (; i < n; i++) {
+				uint32_t x;
+				std::memcpy(&x, sets + 4 * i, 4);
+				out[i] = __builtin_popcount(x);
+			}
+		} else {
+			for (; i < n; i++) {
+				int count = 0;
+				for (size_t w = 0; w < setBytes; w += 8) {
+					uint64_t x;
+					std::memcpy(&x, sets + setBytes * i + w, 8);
+					count += __builtin_popcountll(x);
+				}
+				out[i] = count;
+			}
+		}
+	}
+
+	template <BitOp Op>
+	TINYBIT_ALWAYS_INLINE void bitBytesBody(unsigned char *out, unsigned char const *a, unsigned char const *b, size_t bmask, size_t i, size_t bytes) {
+		for (; i + 8 <= bytes; i += 8) {
+			uint64_t va;
+			uint64_t vb;
+			std::memcpy(&va, a + i, 8);
+			std::memcpy(&vb, b + (i & bmask), 8);
+			uint64_t r = applyOp<Op>(va, vb);
+			std::memcpy(out + i, &r, 8);
+		}
+		for (; i < bytes; i++) {
+			out[i] = applyOp<Op>(a[i], b[i & bmask]);
+		}
+	}
+
+
+	template <size_t Bytes>
+	TINYBIT_ALWAYS_INLINE void overlapCountsNarrow(int *common, int *combined, unsigned char const *sets, size_t i, size_t n, unsigned char const *query) {
+		uint64_t q = 0;
+		std::memcpy(&q, query, Bytes);
+		for (; i < n; i++) {
+			uint64_t x = 0;
+			std::memcpy(&x, sets + Bytes * i, Bytes);
+			common[i] = __builtin_popcountll(x & q);
+			combined[i] = __builtin_popcountll(x | q);
+		}
+	}
+
+	TINYBIT_ALWAYS_INLINE void overlapCountsBody(int *common, int *combined, unsigned char const *sets, size_t i, size_t n, size_t setBytes, unsigned char const *query) {
+		if (setBytes == 1) {
+			overlapCountsNarrow<1>(common, combined, sets, i, n, query);
+		} else if (setBytes == 2) {
+			overlapCountsNarrow<2>(common, combined, sets, i, n, query);
+		} else if (setBytes == 4) {
+			overlapCountsNarrow<4>(common, combined, sets, i, n, query);
+		} else {
+			for (; i < n; i++) {
+				int c = 0;
+				int u = 0;
+				for (size_t w = 0; w < setBytes; w += 8) {
+					uint64_t x;
+					uint64_t q;
+					std::memcpy(&x, sets + setBytes * i + w, 8);
+					std::memcpy(&q, query + w, 8);
+					c += __builtin_popcountll(x & q);
+					u += __builtin_popcountll(x | q);
+				}
+				common[i] = c;
+				combined[i] = u;
+			}
+		}
+	}
+
+	template <size_t Bytes>
+	TINYBIT_ALWAYS_INLINE void joinCountsNarrow(int *out, size_t ldo, unsigned char const *a, size_t na, unsigned char const *b, size_t j0, size_t nb) {
+		for (size_t i = 0; i < na; i++) {
+			uint64_t x = 0;
+			std::memcpy(&x, a + Bytes * i, Bytes);
+			for (size_t j = j0; j < nb; j++) {
+				uint64_t y = 0;
+				std::memcpy(&y, b + Bytes * j, Bytes);
+				out[i * ldo + j] = __builtin_popcountll(x & y);
+			}
+		}
+	}
+
+	// columns j0 .. nb-1 of every row
+	TINYBIT_ALWAYS_INLINE void joinCountsBody(int *out, size_t ldo, unsigned char const *a, size_t na, unsigned char const *b, size_t j0, size_t nb, size_t setBytes) {
+		if (setBytes == 1) {
+			joinCountsNarrow<1>(out, ldo, a, na, b, j0, nb);
+		} else if (setBytes == 2) {
+			joinCountsNarrow<2>(out, ldo, a, na, b, j0, nb);
+		} else if (setBytes == 4) {
+			joinCountsNarrow<4>(out, ldo, a, na, b, j0, nb);
+		} else if (setBytes == 8) {
+			joinCountsNarrow<8>(out, ldo, a, na, b, j0, nb);
+		} else {
+			for (size_t i = 0; i < na; i++) {
+				for (size_t j = j0; j < nb; j++) {
+					int c = 0;
+					for (size_t w = 0; w < setBytes; w += 8) {
+						uint64_t x;
+						uint64_t y;
+						std::memcpy(&x, a + setBytes * i + w, 8);
+						std::memcpy(&y, b + setBytes * j + w, 8);
+						c += __builtin_popcountll(x & y);
+					}
+					out[i * ldo + j] = c;
+				}
+			}
+		}
+	}
+
+	// carry-save adder, h:l = a + b + c bit by bit
+	template <typename V>
+	TINYBIT_ALWAYS_INLINE void csa(V &h, V &l, V const &a, V const &b, V const &c) {
+		V u = a ^ b;
+		h = (a & b) | (u & c);
+		l = u ^ c;
+	}
+
+	// positional popcount (Harley-Seal): each block of 16 rows of 8 words goes through a tree of carry-save
+	// adders, so only the sixteens are added into the per bit counters, once per block. the ones .. eights
+	// carry over to the next block. V holds 8 / R words of a row, uint64_t or a gcc vector of them
+	template <typename V, int R>
+	TINYBIT_ALWAYS_INLINE void positionCountsBody(uint64_t *counts, unsigned char const *bytes, size_t n) {
+		constexpr int lanes = int(sizeof(V) / 8);
+		V ones[R];
+		V twos[R];
+		V fours[R];
+		V eights[R];
+		V acc[R][64];
+		for (int k = 0; k < R; k++) {
+			ones[k] = twos[k] = fours[k] = eights[k] = V();
+			for (int j = 0; j < 64; j++) {
+				acc[k][j] = V();
+			}
+		}
+
+		size_t i = 0;
+		for (; i + 128 <= n; i += 128) {
+			for (int k = 0; k < R; k++) {
+				V d[16];
+				for (int r = 0; r < 16; r++) {
+					std::memcpy(&d[r], bytes + 8 * (i + 8 * r + k * lanes), sizeof(V));
+				}
+				V twosA, twosB, foursA, foursB, eightsA, eightsB, sixteens;
+				csa(twosA, ones[k], ones[k], d[0], d[1]);
+				csa(twosB, ones[k], ones[k], d[2], d[3]);
+				csa(foursA, twos[k], twos[k], twosA, twosB);
+				csa(twosA, ones[k], ones[k], d[4], d[5]);
+				csa(twosB, ones[k], ones[k], d[6], d[7]);
+				csa(foursB, twos[k], twos[k], twosA, twosB);
+				csa(eightsA, fours[k], fours[k], foursA, foursB);
+				csa(twosA, ones[k], ones[k], d[8], d[9]);
+				csa(twosB, ones[k], ones[k], d[10], d[11]);
+				csa(foursA, twos[k], twos[k], twosA, twosB);
+				csa(twosA, ones[k], ones[k], d[12], d[13]);
+				csa(twosB, ones[k], ones[k], d[14], d[15]);
+				csa(foursB, twos[k], twos[k], twosA, twosB);
+				csa(eightsB, fours[k], fours[k], foursA, foursB);
+				csa(sixteens, eights[k], eights[k], eightsA, eightsB);
+				for (int j = 0; j < 64; j++) {
+					acc[k][j] += (sixteens >> j) & 1;
+				}
+			}
+		}
+
+		for (int k = 0; k < R; k++) {
+			uint64_t o[lanes], t[lanes], f[lanes], e[lanes];
+			std::memcpy(o, &ones[k], sizeof(V));
+			std::memcpy(t, &twos[k], sizeof(V));
+			std::memcpy(f, &fours[k], sizeof(V));
+			std::memcpy(e, &eights[k], sizeof(V));
+			for (int j = 0; j < 64; j++) {
+				uint64_t s[lanes];
+				std::memcpy(s, &acc[k][j], sizeof(V));
+				for (int l = 0; l < lanes; l++) {
+					counts[64 * (k * lanes + l) + j] += 16 * s[l] + 8 * ((e[l] >> j) & 1) + 4 * ((f[l] >> j) & 1)
+														+ 2 * ((t[l] >> j) & 1) + ((o[l] >> j) & 1);
+				}
+			}
+		}
+		for (; i < n; i++) {
+			uint64_t x;
+			std::memcpy(&x, bytes + 8 * i, 8);
+			for (; x != 0; x &= x - 1) {
+				counts[64 * (i % 8) + size_t(__builtin_ctzll(x))]++;
+			}
+		}
+	}
+
+
+	// bit transpose by swap stages (Hacker's Delight 7-3): for j = width/2 .. 1, the bits of rows k + j whose
+	// column has bit j clear trade places with the bits of rows k whose column has it set. a row of a group is
+	// the same word of its 8 blocks, so every stage is 8 independent lanes. V holds 8 / R of them
+	template <typename V, int R>
+	TINYBIT_ALWAYS_INLINE void transposeBitsBody(uint64_t *words, size_t n, int width) {
+		unsigned char *bytes = reinterpret_cast<unsigned char *>(words);
+		for (size_t g = 0; g < n; g++) {
+			unsigned char *group = bytes + g * 64 * size_t(width);
+			for (int j = width / 2; j > 0; j /= 2) {
+				uint64_t m = ~uint64_t(0) / ((uint64_t(1) << j) + 1);   // columns with bit j clear: 0x5555.., 0x3333.., ..
+				for (int k = 0; k < width; k += 2 * j) {
+					for (int i = k; i < k + j; i++) {
+						for (int r = 0; r < R; r++) {
+							V lo, hi;
+							std::memcpy(&lo, group + 64 * i + r * sizeof(V), sizeof(V));
+							std::memcpy(&hi, group + 64 * (i + j) + r * sizeof(V), sizeof(V));
+							V t = ((lo >> j) ^ hi) & m;
+							lo ^= t << j;
+							hi ^= t;
+							std::memcpy(group + 64 * i + r * sizeof(V), &lo, sizeof(V));
+							std::memcpy(group + 64 * (i + j) + r * sizeof(V), &hi, sizeof(V));
+						}
+					}
+				}
+			}
+		}
+	}
+
+
+	// ---- Scalar ----
+
+	inline int popcountScalar(uint64_t x) { return __builtin_popcountll(x); }
+	inline uint64_t pdepScalar(uint64_t src, uint64_t mask) { return pdepSoftware(src, mask); }
+	inline uint64_t pextScalar(uint64_t src, uint64_t mask) { return pextSoftware(src, mask); }
+
+	inline uint64_t popcountWordsScalar(uint64_t const *words, size_t n) {
+		return popcountWordsBody(words, 0, n);
+	}
+
+	inline void popcountEachScalar(int *out, void const *sets, size_t n, size_t setBytes) {
+		popcountEachBody(out, static_cast<unsigned char const *>(sets), 0, n, setBytes);
+	}
+
+	template <BitOp Op>
+	void bitBytesScalar(unsigned char *out, unsigned char const *a, unsigned char const *b, size_t bmask, size_t bytes) {
+		bitBytesBody<Op>(out, a, b, bmask, 0, bytes);
+	}
+
+	inline void overlapCountsScalar(int *common, int *combined, void const *sets, size_t n, size_t setBytes, void const *query) {
+		overlapCountsBody(common, combined, static_cast<unsigned char const *>(sets), 0, n, setBytes, static_cast<unsigned char const *>(query));
+	}
+
+	inline void joinCountsScalar(int *out, size_t ldo, void const *a, size_t na, void const *b, size_t nb, size_t setBytes) {
+		joinCountsBody(out, ldo, static_cast<unsigned char const *>(a), na, static_cast<unsigned char const *>(b), 0, nb, setBytes);
+	}
+
+	inline void positionCountsScalar(uint64_t *counts, void const *words, size_t n) {
+		positionCountsBody<uint64_t, 8>(counts, static_cast<unsigned char const *>(words), n);
+	}
+
+	inline void transposeBitsScalar(uint64_t *words, size_t n, int width) {
+		transposeBitsBody<uint64_t, 8>(words, n, width);
+	}
+
+
+#if defined(TINYBIT_DISPATCH)
+
+	// 4 and 8 words as gcc vectors, the target attribute of the function they are used in picks the instructions
+	typedef uint64_t Words4 __attribute__((vector_size(32)));
+	typedef uint64_t Words8 __attribute__((vector_size(64)));
+
+
+	// ---- Popcnt ----
+
+	TINYBIT_TARGET("popcnt") inline int popcountPopcnt(uint64_t x) { return __builtin_popcountll(x); }
+
+	TINYBIT_TARGET("popcnt") inline uint64_t popcountWordsPopcnt(uint64_t const *words, size_t n) {
+		return popcountWordsBody(words, 0, n);
+	}
+
+	TINYBIT_TARGET("popcnt") inline void popcountEachPopcnt(int *out, void const *sets, size_t n, size_t setBytes) {
+		popcountEachBody(out, static_cast<unsigned char const *>(sets), 0, n, setBytes);
+	}
+
+	TINYBIT_TARGET("popcnt") inline void joinCountsPopcnt(int *out, size_t ldo, void const *a, size_t na, void const *b, size_t nb, size_t setBytes) {
+		joinCountsBody(out, ldo, static_cast<unsigned char const *>(a), na, static_cast<unsigned char const *>(b), 0, nb, setBytes);
+	}
+
+	TINYBIT_TARGET("popcnt") inline void overlapCountsPopcnt(int *common, int *combined, void const *sets, size_t n, size_t setBytes, void const *query) {
+		overlapCountsBody(common, combined, static_cast<unsigned char const *>(sets), 0, n, setBytes, static_cast<unsigned char const *>(query));
+	}
+
+
+	// ---- AVX2 ----
+
+	// per 64-bit lane popcount of a 256-bit vector, nibble lookup + sad (Mula et al.)
+	TINYBIT_TARGET("avx2") inline __m256i popcount256(__m256i v) {
+		__m256i const lookup = _mm256_setr_epi8(
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		__m256i const lowmask = _mm256_set1_epi8(0x0f);
+		__m256i lo = _mm256_and_si256(v, lowmask);
+		__m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowmask);
+		__m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+		return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+	}
+
+	TINYBIT_TARGET("bmi2") inline uint64_t pdepBmi2(uint64_t src, uint64_t mask) { return _pdep_u64(src, mask); }
+	TINYBIT_TARGET("bmi2") inline uint64_t pextBmi2(uint64_t src, uint64_t mask) { return _pext_u64(src, mask); }
+
+	TINYBIT_TARGET("avx2,popcnt") inline uint64_t popcountWordsAVX2(uint64_t const *words, size_t n) {
+		size_t i = 0;
+		__m256i acc = _mm256_setzero_si256();
+		for (; i + 4 <= n; i += 4) {
+			acc = _mm256_add_epi64(acc, popcount256(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(words + i))));
+		}
+		uint64_t total = uint64_t(_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1)
+								  + _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+		return total + popcountWordsBody(words, i, n);
+	}
+
+	TINYBIT_TARGET("avx2,popcnt") inline void popcountEachAVX2(int *out, void const *sets, size_t n, size_t setBytes) {
+		unsigned char const *bytes = static_cast<unsigned char const *>(sets);
+		size_t i = 0;
+		if (setBytes == 8) {
+			// the 4 lane counts sit in the low halves of the 64-bit lanes, gather them into 4 ints
+			__m256i const lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+			for (; i + 4 <= n; i += 4) {
+				__m256i counts = popcount256(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(bytes + 8 * i)));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+								 _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(counts, lowHalves)));
+			}
+		}
+		popcountEachBody(out, bytes, i, n, setBytes);
+	}
+
+	TINYBIT_TARGET("avx2,popcnt") inline void overlapCountsAVX2(int *common, int *combined, void const *sets, size_t n, size_t setBytes, void const *query) {
+		unsigned char const *bytes = static_cast<unsigned char const *>(sets);
+		unsigned char const *qbytes = static_cast<unsigned char const *>(query);
+		size_t i = 0;
+		if (setBytes == 8) {
+			uint64_t q;
+			std::memcpy(&q, qbytes, 8);
+			__m256i const vq = _mm256_set1_epi64x(static_cast<long long>(q));
+			__m256i const lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+			for (; i + 4 <= n; i += 4) {
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(bytes + 8 * i));
+				__m256i c = _mm256_permutevar8x32_epi32(popcount256(_mm256_and_si256(v, vq)), lowHalves);
+				__m256i u = _mm256_permutevar8x32_epi32(popcount256(_mm256_or_si256(v, vq)), lowHalves);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(common + i), _mm256_castsi256_si128(c));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(combined + i), _mm256_castsi256_si128(u));
+			}
+		}
+		overlapCountsBody(common, combined, bytes, i, n, setBytes, qbytes);
+	}
+
+	TINYBIT_TARGET("avx2,popcnt") inline void joinCountsAVX2(int *out, size_t ldo, void const *a, size_t na, void const *b, size_t nb, size_t setBytes) {
+		unsigned char const *abytes = static_cast<unsigned char const *>(a);
+		unsigned char const *bbytes = static_cast<unsigned char const *>(b);
+		size_t jv = 0;
+		if (setBytes == 8) {
+			// one a set against 4 b sets per step, the b tile is meant to stay in L1 across the rows
+			jv = nb - nb % 4;
+			__m256i const lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+			for (size_t i = 0; i < na; i++) {
+				uint64_t x;
+				std::memcpy(&x, abytes + 8 * i, 8);
+				__m256i vx = _mm256_set1_epi64x(static_cast<long long>(x));
+				int *row = out + i * ldo;
+				for (size_t j = 0; j < jv; j += 4) {
+					__m256i vb = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(bbytes + 8 * j));
+					__m256i c = _mm256_permutevar8x32_epi32(popcount256(_mm256_and_si256(vb, vx)), lowHalves);
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(row + j), _mm256_castsi256_si128(c));
+				}
+			}
+		}
+		joinCountsBody(out, ldo, abytes, na, bbytes, jv, nb, setBytes);
+	}
+
+	template <BitOp Op>
+	TINYBIT_TARGET("avx2") void bitBytesAVX2(unsigned char *out, unsigned char const *a, unsigned char const *b, size_t bmask, size_t bytes) {
+		size_t i = 0;
+		for (; i + 32 <= bytes; i += 32) {
+			__m256i va = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+			__m256i vb = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + (i & bmask)));
+			__m256i r;
+			if constexpr (Op == BitOp::Or) {
+				r = _mm256_or_si256(va, vb);
+			} else if constexpr (Op == BitOp::And) {
+				r = _mm256_and_si256(va, vb);
+			} else if constexpr (Op == BitOp::AndNot) {
+				r = _mm256_andnot_si256(vb, va);
+			} else {
+				r = _mm256_andnot_si256(va, vb);
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), r);
+		}
+		bitBytesBody<Op>(out, a, b, bmask, i, bytes);
+	}
+
+	TINYBIT_TARGET("avx2") inline void positionCountsAVX2(uint64_t *counts, void const *words, size_t n) {
+		positionCountsBody<Words4, 2>(counts, static_cast<unsigned char const *>(words), n);
+	}
+
+	TINYBIT_TARGET("avx2") inline void transposeBitsAVX2(uint64_t *words, size_t n, int width) {
+		transposeBitsBody<Words4, 2>(words, n, width);
+	}
+
+
+	// ---- AVX512 ----
+
+	TINYBIT_TARGET("avx512f,avx512vpopcntdq,popcnt") inline uint64_t popcountWordsAVX512(uint64_t const *words, size_t n) {
+		size_t i = 0;
+		__m512i acc = _mm512_setzero_si512();
+		for (; i + 8 <= n; i += 8) {
+			acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512(words + i)));
+		}
+		// summed through memory, gcc 12's _mm512_reduce_add_epi64 trips -Wuninitialized
+		uint64_t lanes[8];
+		_mm512_storeu_si512(lanes, acc);
+		uint64_t total = 0;
+		for (uint64_t lane : lanes) {
+			total += lane;
+		}
+		return total + popcountWordsBody(words, i, n);
+	}
+
+	TINYBIT_TARGET("avx512f,avx512vpopcntdq,popcnt") inline void popcountEachAVX512(int *out, void const *sets, size_t n, size_t setBytes) {
+		unsigned char const *bytes = static_cast<unsigned char const *>(sets);
+		size_t i = 0;
+		if (setBytes == 8) {
+			for (; i + 8 <= n; i += 8) {
+				__m512i counts = _mm512_popcnt_epi64(_mm512_loadu_si512(bytes + 8 * i));
+				// masked form of _mm512_cvtepi64_epi32, whose undefined pass-through trips gcc's -Wmaybe-uninitialized
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm512_mask_cvtepi64_epi32(_mm256_setzero_si256(), 0xff, counts));
+			}
+		}
+		popcountEachBody(out, bytes, i, n, setBytes);
+	}
+
+	TINYBIT_TARGET("avx512f,avx512vpopcntdq,popcnt") inline void overlapCountsAVX512(int *common, int *combined, void const *sets, size_t n, size_t setBytes, void const *query) {
+		unsigned char const *bytes = static_cast<unsigned char const *>(sets);
+		unsigned char const *qbytes = static_cast<unsigned char const *>(query);
+		size_t i = 0;
+		if (setBytes == 8) {
+			uint64_t q;
+			std::memcpy(&q, qbytes, 8);
+			__m512i const vq = _mm512_set1_epi64(static_cast<long long>(q));
+			for (; i + 8 <= n; i += 8) {
+				__m512i v = _mm512_loadu_si512(bytes + 8 * i);
+				__m512i c = _mm512_popcnt_epi64(_mm512_and_si512(v, vq));
+				__m512i u = _mm512_popcnt_epi64(_mm512_or_si512(v, vq));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(common + i), _mm512_mask_cvtepi64_epi32(_mm256_setzero_si256(), 0xff, c));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(combined + i), _mm512_mask_cvtepi64_epi32(_mm256_setzero_si256(), 0xff, u));
+			}
+		}
+		overlapCountsBody(common, combined, bytes, i, n, setBytes, qbytes);
+	}
+
+	TINYBIT_TARGET("avx512f,avx512vpopcntdq,popcnt") inline void joinCountsAVX512(int *out, size_t ldo, void const *a, size_t na, void const *b, size_t nb, size_t setBytes) {
+		unsigned char const *abytes = static_cast<unsigned char const *>(a);
+		unsigned char const *bbytes = static_cast<unsigned char const *>(b);
+		size_t jv = 0;
+		if (setBytes == 8) {
+			jv = nb - nb % 8;
+			for (size_t i = 0; i < na; i++) {
+				uint64_t x;
+				std::memcpy(&x, abytes + 8 * i, 8);
+				__m512i vx = _mm512_set1_epi64(static_cast<long long>(x));
+				int *row = out + i * ldo;
+				for (size_t j = 0; j < jv; j += 8) {
+					__m512i c = _mm512_popcnt_epi64(_mm512_and_si512(_mm512_loadu_si512(bbytes + 8 * j), vx));
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(row + j), _mm512_mask_cvtepi64_epi32(_mm256_setzero_si256(), 0xff, c));
+				}
+			}
+		}
+		joinCountsBody(out, ldo, abytes, na, bbytes, jv, nb, setBytes);
+	}
+
+	template <BitOp Op>
+	TINYBIT_TARGET("avx512f") void bitBytesAVX512(unsigned char *out, unsigned char const *a, unsigned char const *b, size_t bmask, size_t bytes) {
+		size_t i = 0;
+		__m512i const ones = _mm512_set1_epi64(-1);
+		for (; i + 64 <= bytes; i += 64) {
+			__m512i va = _mm512_loadu_si512(a + i);
+			__m512i vb = _mm512_loadu_si512(b + (i & bmask));
+			// and-nots spelled with xor, gcc 12's _mm512_andnot_si512 trips -Wmaybe-uninitialized (still one vpandnq)
+			__m512i r;
+			if constexpr (Op == BitOp::Or) {
+				r = _mm512_or_si512(va, vb);
+			} else if constexpr (Op == BitOp::And) {
+				r = _mm512_and_si512(va, vb);
+			} else if constexpr (Op == BitOp::AndNot) {
+				r = _mm512_and_si512(va, _mm512_xor_si512(vb, ones));
+			} else {
+				r = _mm512_and_si512(_mm512_xor_si512(va, ones), vb);
+			}
+			_mm512_storeu_si512(out + i, r);
+		}
+		bitBytesBody<Op>(out, a, b, bmask, i, bytes);
+	}
+
+	TINYBIT_TARGET("avx512f") inline void positionCountsAVX512(uint64_t *counts, void const *words, size_t n) {
+		positionCountsBody<Words8, 1>(counts, static_cast<unsigned char const *>(words), n);
+	}
+
+	TINYBIT_TARGET("avx512f") inline void transposeBitsAVX512(uint64_t *words, size_t n, int width) {
+		transposeBitsBody<Words8, 1>(words, n, width);
+	}
+
+#endif
+
+
+	// ---- path selection ----
+
+	// pdep / pext are microcoded on zen 1 and 2, slower than the software loops for most masks
+	inline bool slowPdep() {
+#if defined(TINYBIT_DISPATCH)
+		return __builtin_cpu_is("znver1") || __builtin_cpu_is("znver2");
+#else
+		return false;
+#endif
+	}
+
+
+	inline bool pathSupported(TinyBitPath path) {
+#if defined(TINYBIT_DISPATCH)
+		__builtin_cpu_init();
+		switch (path) {
+			case TinyBitPath::Scalar:
+				return true;
+			case TinyBitPath::Popcnt:
+				return __builtin_cpu_supports("popcnt");
+			case TinyBitPath::AVX2:
+				return __builtin_cpu_supports("popcnt") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi")
+					   && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("lzcnt");
+			case TinyBitPath::AVX512:
+				return pathSupported(TinyBitPath::AVX2) && __builtin_cpu_supports("avx512f")
+					   && __builtin_cpu_supports("avx512vpopcntdq");
+		}
+		return false;
+#else
+		return path == TinyBitPath::Scalar;
+#endif
+	}
+
+
+	// the widest path this cpu supports, ignoring TINYBIT_PATH and forcePath()
+	inline TinyBitPath bestPath() {
+		for (int p = int(TinyBitPath::AVX512); p > int(TinyBitPath::Scalar); p--) {
+			if (pathSupported(TinyBitPath(p))) {
+				return TinyBitPath(p);
+			}
+		}
+		return TinyBitPath::Scalar;
+	}
+
+
+	inline Kernels makeKernels(TinyBitPath path) {
+		Kernels k = {
+			TinyBitPath::Scalar, false,
+			popcountScalar, pdepScalar, pextScalar,
+			popcountWordsScalar, popcountEachScalar,
+			{ bitBytesScalar<BitOp::Or>, bitBytesScalar<BitOp::And>, bitBytesScalar<BitOp::AndNot>, bitBytesScalar<BitOp::NotAnd> },
+			positionCountsScalar, overlapCountsScalar, joinCountsScalar, transposeBitsScalar
+		};
+#if defined(TINYBIT_DISPATCH)
+		// each path keeps the kernels of the ones below it that it has nothing better for
+		if (path >= TinyBitPath::Popcnt) {
+			k.path = TinyBitPath::Popcnt;
+			k.popcount = popcountPopcnt;
+			k.popcountWords = popcountWordsPopcnt;
+			k.popcountEach = popcountEachPopcnt;
+			k.overlapCounts = overlapCountsPopcnt;
+			k.joinCounts = joinCountsPopcnt;
+		}
+		if (path >= TinyBitPath::AVX2) {
+			k.path = TinyBitPath::AVX2;
+			if (!slowPdep()) {
+				k.fastPdep = true;
+				k.pdep = pdepBmi2;
+				k.pext = pextBmi2;
+			}
+			k.popcountWords = popcountWordsAVX2;
+			k.popcountEach = popcountEachAVX2;
+			k.bitBytes[0] = bitBytesAVX2<BitOp::Or>;
+			k.bitBytes[1] = bitBytesAVX2<BitOp::And>;
+			k.bitBytes[2] = bitBytesAVX2<BitOp::AndNot>;
+			k.bitBytes[3] = bitBytesAVX2<BitOp::NotAnd>;
+			k.positionCounts = positionCountsAVX2;
+			k.overlapCounts = overlapCountsAVX2;
+			k.joinCounts = joinCountsAVX2;
+			k.transposeBits = transposeBitsAVX2;
+		}
+		if (path >= TinyBitPath::AVX512) {
+			k.path = TinyBitPath::AVX512;
+			k.popcountWords = popcountWordsAVX512;
+			k.popcountEach = popcountEachAVX512;
+			k.bitBytes[0] = bitBytesAVX512<BitOp::Or>;
+			k.bitBytes[1] = bitBytesAVX512<BitOp::And>;
+			k.bitBytes[2] = bitBytesAVX512<BitOp::AndNot>;
+			k.bitBytes[3] = bitBytesAVX512<BitOp::NotAnd>;
+			k.positionCounts = positionCountsAVX512;
+			k.overlapCounts = overlapCountsAVX512;
+			k.joinCounts = joinCountsAVX512;
+			k.transposeBits = transposeBitsAVX512;
+		}
+#endif
+		return k;
+	}
+
+
+	inline Kernels const &pathKernels(TinyBitPath path) {
+		static Kernels const tables[4] = {
+			makeKernels(TinyBitPath::Scalar), makeKernels(TinyBitPath::Popcnt),
+			makeKernels(TinyBitPath::AVX2), makeKernels(TinyBitPath::AVX512)
+		};
+		return tables[int(path)];
+	}
+
+
+	// bestPath(), lowered to TINYBIT_PATH if that names a path
+	inline TinyBitPath startupPath() {
+		TinyBitPath best = bestPath();
+		char const *env = std::getenv("TINYBIT_PATH");
+		if (env == nullptr) {
+			return best;
+		}
+		std::string name(env);
+		TinyBitPath asked = (name == "scalar") ? TinyBitPath::Scalar : (name == "popcnt") ? TinyBitPath::Popcnt
+						  : (name == "avx2") ? TinyBitPath::AVX2 : (name == "avx512") ? TinyBitPath::AVX512 : best;
+		return (asked < best) ? asked : best;
+	}
+
+
+	inline std::atomic<Kernels const *> &activeKernels() {
+		static std::atomic<Kernels const *> active(&pathKernels(startupPath()));
+		return active;
+	}
+
+
+	inline Kernels const &kernels() {
+		return *activeKernels().load(std::memory_order_relaxed);
+	}
+
+
+	inline TinyBitPath activePath() {
+		return kernels().path;
+	}
+
+
+	// throws std::invalid_argument if this cpu can't run path
+	inline void forcePath(TinyBitPath path) {
+		if (!pathSupported(path)) {
+			throw std::invalid_argument("TinyBitPath " + std::to_string(int(path)) + " is not supported by this cpu, the best is "
+										+ std::to_string(int(bestPath())) + ".");
+		}
+		activeKernels().store(&pathKernels(path), std::memory_order_relaxed);
+	}
+
+
+	// back to the path picked at startup
+	inline void resetPath() {
+		activeKernels().store(&pathKernels(startupPath()), std::memory_order_relaxed);
+	}
+
+}
+
+
+#endif
@@ -0,0 +1,442 @@
+/*
+small graphs of up to N vertices (1 .. n, n <= N) stored as one TinyBitSet<N> adjacency row per vertex,
+so the graph algorithms work on whole neighbourhoods at a time:
+
+	reachableFrom(v) / distancesFrom(v)   BFS a layer at a time: the next frontier is the union of the rows of the
+	                                      current one, minus everything seen
+	transitiveClosure()                   Warshall: for every k, every row containing k ors in row k
+	components()                          repeated reachability from the smallest vertex not yet labelled
+	maximumClique()                       Bron-Kerbosch with Tomita pivoting (P, X and R are sets, the pivot is the
+	                                      vertex of P | X with the most neighbours in P), cut off once |R| + |P|
+	                                      can't beat the best clique so far
+	forEachMaximalClique(fn)              the same recursion without the cut off
+	greedyColoring()                      first fit in vertex order, built a colour class at a time: the class takes
+	                                      the smallest remaining vertex and drops its neighbours, until none remain
+	dsaturColoring()                      DSATUR: colour the vertex with the most distinct neighbour colours next
+	                                      (ties: most uncoloured neighbours, then smallest), colours kept as sets
+
+edges added with addEdge() go both ways, addArc() adds one direction for the directed algorithms (reachability,
+distances, closure); cliques, colourings and components read the rows as they are, so they expect undirected
+graphs. none of the algorithms allocate: results are TinyBitSets or std::arrays indexed by vertex (entry 0
+unused), and the clique search recurses at most n deep.
+
+mapGraphs() runs one of them (or any function of a graph) over many graphs, split across threads.
+
+*/
+
+#ifndef TINYBITGRAPH_H
+#define TINYBITGRAPH_H
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "tinybitset.h"
+
+
+namespace tinybit {
+
+	// reachableFrom, transitiveClosure and maximumClique take 5 - 15us a graph of 64 vertices
+	// (scripts/comparegraph.cpp): 16 graphs are 80 - 240us
+	constexpr size_t graphParallelMin = 16;
+
+}
+
+
+// colours 1 .. count, of[v] the colour of vertex v
+template <int N>
+struct TinyBitColoring {
+	int count;
+	std::array<int, N + 1> of;
+};
+
+// components 1 .. count, numbered by their smallest vertex, of[v] the component of vertex v
+template <int N>
+struct TinyBitComponents {
+	int count;
+	std::array<int, N + 1> of;
+};
+
+
+
+template <int N, typename BoundsCheck = TinyBitThrowCheck>
+class TinyBitGraph {
+	public:
+		using row_type = TinyBitSet<N, BoundsCheck>;
+
+		// n vertices and no edges
+		explicit TinyBitGraph(int nvertices = N);
+		// n vertices, row v - 1 the neighbours of v, e.g. from a std::vector<TinyBitSet<N>>
+		TinyBitGraph(row_type const *adjacency, int nvertices);
+
+		int vertexCount() const { return this->n; }
+		row_type vertices() const;
+
+		// edge u - v both ways, arc u -> v one way. self loops are allowed but ignored by cliques and colourings
+		void addEdge(int u, int v);
+		void removeEdge(int u, int v);
+		void addArc(int u, int v);
+		void removeArc(int u, int v);
+		bool hasArc(int u, int v) const;
+		row_type const &neighbours(int v) const;
+		int degree(int v) const;
+
+		// every vertex reachable from v, v included, and the number of edges on a shortest path (-1 unreachable)
+		row_type reachableFrom(int v) const;
+		std::array<int, N + 1> distancesFrom(int v) const;
+		// u -> v wherever a path of one or more arcs leads from u to v
+		TinyBitGraph transitiveClosure() const;
+		TinyBitComponents<N> components() const;
+
+		row_type maximumClique() const;
+		template <typename Callback>
+		void forEachMaximalClique(Callback &&callback) const;
+
+		TinyBitColoring<N> greedyColoring() const;
+		TinyBitColoring<N> dsaturColoring() const;
+
+	private:
+		std::array<row_type, N> rows;
+		int n;
+
+		row_type const &row(int v) const { return this->rows[v - 1]; }
+		row_type &row(int v) { return this->rows[v - 1]; }
+		// the neighbours of v other than v, for the algorithms that ignore self loops
+		row_type others(int v) const { row_type r = this->rows[v - 1]; r.remove(v); return r; }
+		// the vertex of candidates with the most neighbours in p
+		int pivot(row_type const &candidates, row_type const &p) const;
+		void maxCliqueFrom(row_type &r, int rsize, row_type p, row_type x, row_type &best, int &bestSize) const;
+		template <typename Callback>
+		void maximalCliquesFrom(row_type &r, row_type p, row_type x, Callback &callback) const;
+};
+
+
+
+template <int N, typename BoundsCheck>
+TinyBitGraph<N, BoundsCheck>::TinyBitGraph(int nvertices) : rows(), n(nvertices) {
+	if ((nvertices < 0) || (nvertices > N)) {
+		throw std::invalid_argument("TinyBitGraph<" + std::to_string(N) + "> can't have " + std::to_string(nvertices) + " vertices.");
+	}
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitGraph<N, BoundsCheck>::TinyBitGraph(row_type const *adjacency, int nvertices) : TinyBitGraph(nvertices) {
+	row_type all = this->vertices();
+	for (int v = 1; v <= nvertices; v++) {
+		if (!(adjacency[v - 1] - all).isempty()) {
+			throw std::invalid_argument("TinyBitGraph of " + std::to_string(nvertices) + " vertices given a row " + std::to_string(v)
+										+ " with neighbours above " + std::to_string(nvertices) + ".");
+		}
+		this->row(v) = adjacency[v - 1];
+	}
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitSet<N, BoundsCheck> TinyBitGraph<N, BoundsCheck>::vertices() const {
+	row_type all;
+	if (this->n > 0) {
+		all.insertRange(1, this->n);
+	}
+	return all;
+}
+
+
+template <int N, typename BoundsCheck>
+void TinyBitGraph<N, BoundsCheck>::addEdge(int u, int v) {
+	BoundsCheck::check(u, this->n, "addEdge");
+	BoundsCheck::check(v, this->n, "addEdge");
+	this->row(u).insert(v);
+	this->row(v).insert(u);
+}
+
+
+template <int N, typename BoundsCheck>
+void TinyBitGraph<N, BoundsCheck>::removeEdge(int u, int v) {
+	BoundsCheck::check(u, this->n, "removeEdge");
+	BoundsCheck::check(v, this->n, "removeEdge");
+	this->row(u).remove(v);
+	this->row(v).remove(u);
+}
+
+
+template <int N, typename BoundsCheck>
+void TinyBitGraph<N, BoundsCheck>::addArc(int u, int v) {
+	BoundsCheck::check(u, this->n, "addArc");
+	BoundsCheck::check(v, this->n, "addArc");
+	this->row(u).insert(v);
+}
+
+
+template <int N, typename BoundsCheck>
+void TinyBitGraph<N, BoundsCheck>::removeArc(int u, int v) {
+	BoundsCheck::check(u, this->n, "removeArc");
+	BoundsCheck::check(v, this->n, "removeArc");
+	this->row(u).remove(v);
+}
+
+
+template <int N, typename BoundsCheck>
+bool TinyBitGraph<N, BoundsCheck>::hasArc(int u, int v) const {
+	BoundsCheck::check(u, this->n, "hasArc");
+	BoundsCheck::check(v, this->n, "hasArc");
+	return this->row(u).contains(v);
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitSet<N, BoundsCheck> const &TinyBitGraph<N, BoundsCheck>::neighbours(int v) const {
+	BoundsCheck::check(v, this->n, "neighbours");
+	return this->row(v);
+}
+
+
+template <int N, typename BoundsCheck>
+int TinyBitGraph<N, BoundsCheck>::degree(int v) const {
+	BoundsCheck::check(v, this->n, "degree");
+	return this->row(v).getSetSize();
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitSet<N, BoundsCheck> TinyBitGraph<N, BoundsCheck>::reachableFrom(int v) const {
+	BoundsCheck::check(v, this->n, "reachableFrom");
+	row_type seen;
+	seen.insert(v);
+	row_type frontier = seen;
+	while (!frontier.isempty()) {
+		row_type next;
+		for (int u : frontier) {
+			next |= this->row(u);
+		}
+		frontier = next - seen;
+		seen |= frontier;
+	}
+	return seen;
+}
+
+
+template <int N, typename BoundsCheck>
+std::array<int, N + 1> TinyBitGraph<N, BoundsCheck>::distancesFrom(int v) const {
+	BoundsCheck::check(v, this->n, "distancesFrom");
+	std::array<int, N + 1> dist;
+	dist.fill(-1);
+	row_type seen;
+	seen.insert(v);
+	row_type frontier = seen;
+	for (int d = 0; !frontier.isempty(); d++) {
+		row_type next;
+		for (int u : frontier) {
+			dist[u] = d;
+			next |= this->row(u);
+		}
+		frontier = next - seen;
+		seen |= frontier;
+	}
+	return dist;
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitGraph<N, BoundsCheck> TinyBitGraph<N, BoundsCheck>::transitiveClosure() const {
+	TinyBitGraph closure = *this;
+	for (int k = 1; k <= this->n; k++) {
+		row_type const through = closure.row(k);
+		for (int i = 1; i <= this->n; i++) {
+			// row k may change when i == k, but only by adding what it already holds
+			if (closure.row(i).contains(k)) {
+				closure.row(i) |= through;
+			}
+		}
+	}
+	return closure;
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitComponents<N> TinyBitGraph<N, BoundsCheck>::components() const {
+	TinyBitComponents<N> result;
+	result.count = 0;
+	result.of.fill(0);
+	row_type left = this->vertices();
+	while (!left.isempty()) {
+		row_type component = this->reachableFrom(left.select(1));
+		result.count++;
+		for (int v : component) {
+			result.of[v] = result.count;
+		}
+		left -= component;
+	}
+	return result;
+}
+
+
+template <int N, typename BoundsCheck>
+int TinyBitGraph<N, BoundsCheck>::pivot(row_type const &candidates, row_type const &p) const {
+	int best = 0;
+	int bestCount = -1;
+	for (int u : candidates) {
+		int count = (this->others(u) & p).getSetSize();
+		if (count > bestCount) {
+			best = u;
+			bestCount = count;
+		}
+	}
+	return best;
+}
+
+
+template <int N, typename BoundsCheck>
+void TinyBitGraph<N, BoundsCheck>::maxCliqueFrom(row_type &r, int rsize, row_type p, row_type x, row_type &best, int &bestSize) const {
+	if (p.isempty()) {
+		if (x.isempty() && (rsize > bestSize)) {
+			best = r;
+			bestSize = rsize;
+		}
+		return;
+	}
+	// neighbours of the pivot are reached through the branches of the others
+	row_type branches = p - this->others(this->pivot(p | x, p));
+	for (int v : branches) {
+		if (rsize + p.getSetSize() <= bestSize) {
+			return;
+		}
+		row_type nv = this->others(v);
+		r.insert(v);
+		this->maxCliqueFrom(r, rsize + 1, p & nv, x & nv, best, bestSize);
+		r.remove(v);
+		p.remove(v);
+		x.insert(v);
+	}
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitSet<N, BoundsCheck> TinyBitGraph<N, BoundsCheck>::maximumClique() const {
+	row_type r;
+	row_type best;
+	int bestSize = 0;
+	this->maxCliqueFrom(r, 0, this->vertices(), row_type(), best, bestSize);
+	return best;
+}
+
+
+template <int N, typename BoundsCheck>
+template <typename Callback>
+void TinyBitGraph<N, BoundsCheck>::maximalCliquesFrom(row_type &r, row_type p, row_type x, Callback &callback) const {
+	if (p.isempty()) {
+		if (x.isempty()) {
+			callback(static_cast<row_type const &>(r));
+		}
+		return;
+	}
+	row_type branches = p - this->others(this->pivot(p | x, p));
+	for (int v : branches) {
+		row_type nv = this->others(v);
+		r.insert(v);
+		this->maximalCliquesFrom(r, p & nv, x & nv, callback);
+		r.remove(v);
+		p.remove(v);
+		x.insert(v);
+	}
+}
+
+
+// callback(clique) for every maximal clique, as a TinyBitSet of its vertices
+template <int N, typename BoundsCheck>
+template <typename Callback>
+void TinyBitGraph<N, BoundsCheck>::forEachMaximalClique(Callback &&callback) const {
+	if (this->n == 0) {
+		return;
+	}
+	row_type r;
+	this->maximalCliquesFrom(r, this->vertices(), row_type(), callback);
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitColoring<N> TinyBitGraph<N, BoundsCheck>::greedyColoring() const {
+	TinyBitColoring<N> coloring;
+	coloring.count = 0;
+	coloring.of.fill(0);
+	row_type uncolored = this->vertices();
+	while (!uncolored.isempty()) {
+		coloring.count++;
+		row_type open = uncolored;
+		while (!open.isempty()) {
+			int v = open.popSmallest();
+			coloring.of[v] = coloring.count;
+			uncolored.remove(v);
+			open -= this->row(v);
+		}
+	}
+	return coloring;
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitColoring<N> TinyBitGraph<N, BoundsCheck>::dsaturColoring() const {
+	TinyBitColoring<N> coloring;
+	coloring.count = 0;
+	coloring.of.fill(0);
+	// colours already on the neighbours of each vertex, colours fit in 1 .. N
+	std::array<row_type, N> near{};
+	row_type uncolored = this->vertices();
+	while (!uncolored.isempty()) {
+		int v = 0;
+		int bestSaturation = -1;
+		int bestDegree = -1;
+		for (int u : uncolored) {
+			int saturation = near[u - 1].getSetSize();
+			if (saturation < bestSaturation) {
+				continue;
+			}
+			int degree = (this->others(u) & uncolored).getSetSize();
+			if ((saturation > bestSaturation) || (degree > bestDegree)) {
+				v = u;
+				bestSaturation = saturation;
+				bestDegree = degree;
+			}
+		}
+		int color = (~near[v - 1]).select(1);
+		coloring.of[v] = color;
+		coloring.count = (color > coloring.count) ? color : coloring.count;
+		uncolored.remove(v);
+		for (int u : this->row(v) & uncolored) {
+			near[u - 1].insert(color);
+		}
+	}
+	return coloring;
+}
+
+
+
+// out[i] = fn(graphs[i]) for n graphs, split across nthreads when there are enough. fn is called concurrently
+template <int N, typename BoundsCheck, typename Result, typename Fn>
+void mapGraphs(Result *out, TinyBitGraph<N, BoundsCheck> const *graphs, size_t n, Fn fn, int nthreads = 1) {
+	if (n < tinybit::graphParallelMin) {
+		nthreads = 1;
+	}
+	tinybit::parallelRanges(nthreads, n, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			out[i] = fn(graphs[i]);
+		}
+	});
+}
+
+
+// e.g. mapGraphs(graphs.data(), graphs.size(), [](auto const &g) { return g.maximumClique(); }, 8)
+template <int N, typename BoundsCheck, typename Fn>
+auto mapGraphs(TinyBitGraph<N, BoundsCheck> const *graphs, size_t n, Fn fn, int nthreads = 1) {
+	using Result = std::decay_t<decltype(fn(graphs[0]))>;
+	std::vector<Result> out(n);
+	mapGraphs(out.data(), graphs, n, fn, nthreads);
+	return out;
+}
+
+
+#endif
@@ -0,0 +1,144 @@
+/*
+all-pairs join between two collections of TinyBitSets: |a[i] & b[j]| for every i, j.
+
+	intersectionCounts(out, a, na, b, nb)           the dense na x nb matrix, row i is a[i] against every b
+	intersectingPairs(a, na, b, nb, minCommon)      only the (i, j) with |a[i] & b[j]| >= minCommon
+
+both walk the matrix in tiles. a block of a (joinBlockBytes, meant for L2) is held against one tile of b at a
+time (joinTileBytes, meant for L1), and the dispatch kernel runs every a set of the block over the b tile:
+8 pairs per instruction with VPOPCNTDQ, 4 with the AVX2 nibble lookup, one set at a time otherwise.
+so each b set is read from memory once per a block instead of once per a set.
+
+with nthreads > 1 and enough pairs, the rows of a are split across threads, each writing its own rows
+(or collecting its own pairs, merged and sorted at the end).
+
+*/
+
+#ifndef TINYBITJOIN_H
+#define TINYBITJOIN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "tinybitset.h"
+
+
+struct TinyBitPair {
+	size_t a;     // index into the first collection
+	size_t b;     // index into the second
+	int common;   // |a & b|
+};
+
+
+
+namespace tinybit {
+
+	// half of a 32KB L1 for the b tile, a few hundred KB of L2 for the a block
+	constexpr size_t joinTileBytes = 16384;
+	constexpr size_t joinBlockBytes = 262144;
+
+	// rows per kernel call when collecting pairs, so the counts of one tile stay in L2
+	constexpr size_t joinPairRows = 16;
+
+	// the tiles count a pair in about 0.7ns (scripts/comparejoin.cpp): 65536 pairs are ~45us
+	constexpr size_t joinParallelMin = size_t(1) << 16;
+
+
+	// fn(i0, i1, j0, j1) for every tile of rows begin .. end-1 against all of b, a blocks outside, b tiles inside
+	template <typename RepType, typename Fn>
+	void forEachTile(size_t begin, size_t end, size_t nb, Fn fn) {
+		size_t blockRows = std::max<size_t>(1, joinBlockBytes / sizeof(RepType));
+		size_t tileCols = std::max<size_t>(8, joinTileBytes / sizeof(RepType));
+		for (size_t i0 = begin; i0 < end; i0 += blockRows) {
+			size_t i1 = std::min(end, i0 + blockRows);
+			for (size_t j0 = 0; j0 < nb; j0 += tileCols) {
+				fn(i0, i1, j0, std::min(nb, j0 + tileCols));
+			}
+		}
+	}
+
+
+	template <typename RepType>
+	void joinCounts(int *out, RepType const *a, size_t na, RepType const *b, size_t nb, int nthreads) {
+		if ((na * nb) < joinParallelMin) {
+			nthreads = 1;
+		}
+		parallelRanges(nthreads, na, [=](size_t begin, size_t end) {
+			forEachTile<RepType>(begin, end, nb, [=](size_t i0, size_t i1, size_t j0, size_t j1) {
+				kernels().joinCounts(out + i0 * nb + j0, nb, a + i0, i1 - i0, b + j0, j1 - j0, sizeof(RepType));
+			});
+		});
+	}
+
+
+	template <typename RepType>
+	std::vector<TinyBitPair> joinPairs(RepType const *a, size_t na, RepType const *b, size_t nb, int minCommon, int nthreads) {
+		if ((na * nb) < joinParallelMin) {
+			nthreads = 1;
+		}
+		std::vector<TinyBitPair> pairs;
+		std::mutex merge;
+		parallelRanges(nthreads, na, [&](size_t begin, size_t end) {
+			std::vector<TinyBitPair> local;
+			std::vector<int> counts(joinPairRows * std::max<size_t>(8, joinTileBytes / sizeof(RepType)));
+			forEachTile<RepType>(begin, end, nb, [&](size_t i0, size_t i1, size_t j0, size_t j1) {
+				size_t cols = j1 - j0;
+				for (size_t r0 = i0; r0 < i1; r0 += joinPairRows) {
+					size_t rows = std::min(joinPairRows, i1 - r0);
+					kernels().joinCounts(counts.data(), cols, a + r0, rows, b + j0, cols, sizeof(RepType));
+					for (size_t r = 0; r < rows; r++) {
+						for (size_t c = 0; c < cols; c++) {
+							if (counts[r * cols + c] >= minCommon) {
+								local.push_back(TinyBitPair{r0 + r, j0 + c, counts[r * cols + c]});
+							}
+						}
+					}
+				}
+			});
+			std::lock_guard<std::mutex> lock(merge);
+			pairs.insert(pairs.end(), local.begin(), local.end());
+		});
+		// tiles (and threads) finish out of order
+		std::sort(pairs.begin(), pairs.end(), [](TinyBitPair const &x, TinyBitPair const &y) {
+			return (x.a != y.a) ? (x.a < y.a) : (x.b < y.b);
+		});
+		return pairs;
+	}
+
+}
+
+
+
+// out[i * nb + j] = |a[i] & b[j]|, out must hold na * nb ints
+template <int MaxElems, typename BoundsCheck>
+void intersectionCounts(int *out, TinyBitSet<MaxElems, BoundsCheck> const *a, size_t na, TinyBitSet<MaxElems, BoundsCheck> const *b, size_t nb,
+						int nthreads = 1) {
+	using RepType = TinyBitRepType<MaxElems>;
+	static_assert(sizeof(TinyBitSet<MaxElems, BoundsCheck>) == sizeof(RepType), "intersectionCounts needs TinyBitSet to be exactly its words");
+	tinybit::joinCounts(out, reinterpret_cast<RepType const *>(a), na, reinterpret_cast<RepType const *>(b), nb, nthreads);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<int> intersectionCounts(TinyBitSet<MaxElems, BoundsCheck> const *a, size_t na, TinyBitSet<MaxElems, BoundsCheck> const *b, size_t nb,
+									int nthreads = 1) {
+	std::vector<int> out(na * nb);
+	intersectionCounts(out.data(), a, na, b, nb, nthreads);
+	return out;
+}
+
+
+// every (i, j) with |a[i] & b[j]| >= minCommon, ordered by i then j
+template <int MaxElems, typename BoundsCheck>
+std::vector<TinyBitPair> intersectingPairs(TinyBitSet<MaxElems, BoundsCheck> const *a, size_t na, TinyBitSet<MaxElems, BoundsCheck> const *b, size_t nb,
+										   int minCommon, int nthreads = 1) {
+	using RepType = TinyBitRepType<MaxElems>;
+	static_assert(sizeof(TinyBitSet<MaxElems, BoundsCheck>) == sizeof(RepType), "intersectingPairs needs TinyBitSet to be exactly its words");
+	return tinybit::joinPairs(reinterpret_cast<RepType const *>(a), na, reinterpret_cast<RepType const *>(b), nb, minCommon, nthreads);
+}
+
+
+#endif
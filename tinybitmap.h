@@ -0,0 +1,343 @@
+/*
+flat open-addressing hash map and set keyed by TinyBitSet, for memoizing on sets without going
+through std::unordered_map's one-node-per-entry layout.
+
+the layout follows the "swiss table" scheme:
+	- slots live in plain arrays (keys, values) with one control byte per slot,
+	  empty = 0x80, deleted = 0xFE, full = the low 7 bits of the key's hash
+	- slots are probed 16 at a time, a group of control bytes is compared against the 7 bit tag with
+	  one SSE2 compare + movemask, so most lookups touch one group and compare one key
+	- groups are probed triangularly (g, g+1, g+3, g+6, ...) which visits every group of a power of 2 table
+	- the table grows (doubles) past 7/8 full, counting tombstones
+
+hashes come from TinyBitSet::hash() (murmur3's finalizer), so the 7 bit tag and the group index
+are both well mixed even for sets with only a few low bits set.
+
+*/
+
+#ifndef TINYBITMAP_H
+#define TINYBITMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "tinybitset.h"
+
+
+namespace tinybit {
+
+	constexpr int8_t ctrlEmpty = -128;   // 0x80
+	constexpr int8_t ctrlDeleted = -2;   // 0xFE
+	constexpr size_t groupWidth = 16;
+
+	// bit i set where ctrl[i] == tag
+	inline uint32_t matchTag(int8_t const *ctrl, int8_t tag) {
+#if defined(__SSE2__)
+		__m128i group = _mm_loadu_si128(reinterpret_cast<__m128i const *>(ctrl));
+		return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag))));
+#else
+		uint32_t mask = 0;
+		for (size_t i = 0; i < groupWidth; i++) {
+			mask |= uint32_t(ctrl[i] == tag) << i;
+		}
+		return mask;
+#endif
+	}
+
+	// bit i set where ctrl[i] is empty or deleted (the only control bytes with the top bit set)
+	inline uint32_t matchFree(int8_t const *ctrl) {
+#if defined(__SSE2__)
+		return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(ctrl))));
+#else
+		uint32_t mask = 0;
+		for (size_t i = 0; i < groupWidth; i++) {
+			mask |= uint32_t(ctrl[i] < 0) << i;
+		}
+		return mask;
+#endif
+	}
+
+	struct Unit {};
+
+}
+
+
+
+template <int MaxElems, typename V, typename BoundsCheck = TinyBitThrowCheck>
+class TinyBitSetMap {
+	public:
+		using key_type = TinyBitSet<MaxElems, BoundsCheck>;
+		using mapped_type = V;
+
+		TinyBitSetMap() : ctrl(tinybit::groupWidth, tinybit::ctrlEmpty), keys(tinybit::groupWidth), values(tinybit::groupWidth),
+						  count(0), tombstones(0) {}
+
+		// pointer to the value for key, nullptr if absent
+		V *find(key_type const &key);
+		V const *find(key_type const &key) const;
+		bool contains(key_type const &key) const;
+
+		// inserts a value-initialized V if key is absent
+		V& operator[](key_type const &key);
+		// returns false (and leaves the old value) if key was already present
+		bool insert(key_type const &key, V const &value);
+		bool erase(key_type const &key);
+
+		void reserve(size_t n);
+		void clear();
+		size_t size() const;
+		bool empty() const;
+
+		// calls callback(key, value) for every entry, in table order
+		template <typename Callback>
+		void forEach(Callback &&callback) const;
+
+	private:
+		static constexpr size_t npos = ~size_t(0);
+
+		size_t findSlot(key_type const &key, uint64_t h) const;
+		size_t claimSlot(uint64_t h);
+		void rehash(size_t newcapacity);
+
+		size_t capacity() const {
+			return this->ctrl.size();
+		}
+
+		static int8_t tag(uint64_t h) {
+			return static_cast<int8_t>(h & 0x7f);
+		}
+
+		std::vector<int8_t> ctrl;
+		std::vector<key_type> keys;
+		std::vector<V> values;
+		size_t count;
+		size_t tombstones;
+};
+
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+size_t TinyBitSetMap<MaxElems, V, BoundsCheck>::findSlot(key_type const &key, uint64_t h) const {
+	size_t groupmask = this->capacity() / tinybit::groupWidth - 1;
+	size_t g = (h >> 7) & groupmask;
+	for (size_t step = 1; ; step++) {
+		int8_t const *group = this->ctrl.data() + g * tinybit::groupWidth;
+		for (uint32_t match = tinybit::matchTag(group, tag(h)); match; match &= match - 1) {
+			size_t slot = g * tinybit::groupWidth + __builtin_ctz(match);
+			if (this->keys[slot] == key) {
+				return slot;
+			}
+		}
+		if (tinybit::matchTag(group, tinybit::ctrlEmpty)) {
+			return npos;
+		}
+		g = (g + step) & groupmask;
+	}
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+size_t TinyBitSetMap<MaxElems, V, BoundsCheck>::claimSlot(uint64_t h) {
+	/*
+	   first empty or deleted slot on h's probe sequence, growing first if needed
+	*/
+	if ((this->count + this->tombstones + 1) * 8 > this->capacity() * 7) {
+		// mostly tombstones: rebuild at the same size, otherwise double
+		rehash(((this->count + 1) * 16 > this->capacity() * 7) ? 2 * this->capacity() : this->capacity());
+	}
+	size_t groupmask = this->capacity() / tinybit::groupWidth - 1;
+	size_t g = (h >> 7) & groupmask;
+	for (size_t step = 1; ; step++) {
+		uint32_t free = tinybit::matchFree(this->ctrl.data() + g * tinybit::groupWidth);
+		if (free) {
+			size_t slot = g * tinybit::groupWidth + __builtin_ctz(free);
+			if (this->ctrl[slot] == tinybit::ctrlDeleted) {
+				this->tombstones--;
+			}
+			this->ctrl[slot] = tag(h);
+			this->count++;
+			return slot;
+		}
+		g = (g + step) & groupmask;
+	}
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+void TinyBitSetMap<MaxElems, V, BoundsCheck>::rehash(size_t newcapacity) {
+	std::vector<int8_t> oldctrl(newcapacity, tinybit::ctrlEmpty);
+	std::vector<key_type> oldkeys(newcapacity);
+	std::vector<V> oldvalues(newcapacity);
+	oldctrl.swap(this->ctrl);
+	oldkeys.swap(this->keys);
+	oldvalues.swap(this->values);
+	this->count = 0;
+	this->tombstones = 0;
+	for (size_t i = 0; i < oldctrl.size(); i++) {
+		if (oldctrl[i] >= 0) {
+			size_t slot = claimSlot(oldkeys[i].hash());
+			this->keys[slot] = oldkeys[i];
+			this->values[slot] = std::move(oldvalues[i]);
+		}
+	}
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+V *TinyBitSetMap<MaxElems, V, BoundsCheck>::find(key_type const &key) {
+	size_t slot = findSlot(key, key.hash());
+	return (slot == npos) ? nullptr : &this->values[slot];
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+V const *TinyBitSetMap<MaxElems, V, BoundsCheck>::find(key_type const &key) const {
+	size_t slot = findSlot(key, key.hash());
+	return (slot == npos) ? nullptr : &this->values[slot];
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+bool TinyBitSetMap<MaxElems, V, BoundsCheck>::contains(key_type const &key) const {
+	return findSlot(key, key.hash()) != npos;
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+V& TinyBitSetMap<MaxElems, V, BoundsCheck>::operator[](key_type const &key) {
+	uint64_t h = key.hash();
+	size_t slot = findSlot(key, h);
+	if (slot == npos) {
+		slot = claimSlot(h);
+		this->keys[slot] = key;
+		this->values[slot] = V();
+	}
+	return this->values[slot];
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+bool TinyBitSetMap<MaxElems, V, BoundsCheck>::insert(key_type const &key, V const &value) {
+	uint64_t h = key.hash();
+	if (findSlot(key, h) != npos) {
+		return false;
+	}
+	size_t slot = claimSlot(h);
+	this->keys[slot] = key;
+	this->values[slot] = value;
+	return true;
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+bool TinyBitSetMap<MaxElems, V, BoundsCheck>::erase(key_type const &key) {
+	size_t slot = findSlot(key, key.hash());
+	if (slot == npos) {
+		return false;
+	}
+	this->ctrl[slot] = tinybit::ctrlDeleted;
+	this->values[slot] = V();
+	this->count--;
+	this->tombstones++;
+	return true;
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+void TinyBitSetMap<MaxElems, V, BoundsCheck>::reserve(size_t n) {
+	size_t newcapacity = this->capacity();
+	while (n * 8 > newcapacity * 7) {
+		newcapacity *= 2;
+	}
+	if (newcapacity != this->capacity()) {
+		rehash(newcapacity);
+	}
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+void TinyBitSetMap<MaxElems, V, BoundsCheck>::clear() {
+	std::fill(this->ctrl.begin(), this->ctrl.end(), tinybit::ctrlEmpty);
+	std::fill(this->values.begin(), this->values.end(), V());
+	this->count = 0;
+	this->tombstones = 0;
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+size_t TinyBitSetMap<MaxElems, V, BoundsCheck>::size() const {
+	return this->count;
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+bool TinyBitSetMap<MaxElems, V, BoundsCheck>::empty() const {
+	return this->count == 0;
+}
+
+
+template <int MaxElems, typename V, typename BoundsCheck>
+template <typename Callback>
+void TinyBitSetMap<MaxElems, V, BoundsCheck>::forEach(Callback &&callback) const {
+	for (size_t i = 0; i < this->capacity(); i++) {
+		if (this->ctrl[i] >= 0) {
+			callback(this->keys[i], this->values[i]);
+		}
+	}
+}
+
+
+
+// the same table with no values
+template <int MaxElems, typename BoundsCheck = TinyBitThrowCheck>
+class TinyBitSetSet {
+	public:
+		using key_type = TinyBitSet<MaxElems, BoundsCheck>;
+
+		// returns false if key was already present
+		bool insert(key_type const &key) {
+			return this->table.insert(key, tinybit::Unit());
+		}
+
+		bool erase(key_type const &key) {
+			return this->table.erase(key);
+		}
+
+		bool contains(key_type const &key) const {
+			return this->table.contains(key);
+		}
+
+		void reserve(size_t n) {
+			this->table.reserve(n);
+		}
+
+		void clear() {
+			this->table.clear();
+		}
+
+		size_t size() const {
+			return this->table.size();
+		}
+
+		bool empty() const {
+			return this->table.empty();
+		}
+
+		template <typename Callback>
+		void forEach(Callback &&callback) const {
+			this->table.forEach([&callback](key_type const &key, tinybit::Unit const &) { callback(key); });
+		}
+
+	private:
+		TinyBitSetMap<MaxElems, tinybit::Unit, BoundsCheck> table;
+};
+
+
+#endif
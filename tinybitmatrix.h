@@ -0,0 +1,331 @@
+/*
+N x N boolean matrices (relations on 1 .. N) stored as N TinyBitSet<N> rows, row i the j with i -> j.
+
+	a * b                   composition: row i of the product is the union of the rows k of b for every k in row i of a,
+	                        i.e. i -> j when i -> k in a and k -> j in b
+	transitiveClosure()     repeated squaring, c = c | c * c until nothing changes (at most log2(N) + 1 products)
+	multiplyRows(...)       the product over plain arrays of N rows, e.g. a std::vector<TinyBitSet<64>>
+	multiplyAll(...)        many products at once, and transitiveClosureAll(...), split across threads
+
+the product is the method of four Russians: b's rows are taken a group of 4 (8 for N >= 256) at a time, all 16
+(256) unions of the group go in a table, and each row of a picks its one entry with the group's bits of that row.
+so every row of a costs N / 4 (N / 8) row ORs whatever its density, instead of one per set bit, and the table is
+small enough to stay in L1. when a has fewer set bits than that costs in all (about N / 3 a row for N = 64), one
+row OR per set bit is cheaper and is used instead. rows of more than one word are ORed by TinyBitWords, with the
+vector width the header is compiled for (-mavx2 for 4 words at a time); there are no run time picked copies of
+the loops, as the OR of a row is too short for one to pay for its call.
+
+*/
+
+#ifndef TINYBITMATRIX_H
+#define TINYBITMATRIX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "tinybitset.h"
+
+
+namespace tinybit {
+
+	// a 64 x 64 product takes about 2us (scripts/comparematrix.cpp), a closure 3 - 4 of them: 64 matrices are
+	// 100 - 500us, enough for a few threads
+	constexpr size_t matrixParallelMin = 64;
+
+	// bits of a row of a per table lookup. a table of 2^bits rows takes 2^bits ORs to fill and saves N / bits
+	// ORs per row of a, so 4 wins up to a few hundred rows and 8 beyond. either divides 64, so no group
+	// straddles two words
+	constexpr int matrixGroupBits(int n) {
+		return (n >= 256) ? 8 : 4;
+	}
+
+
+	// set bits in all N rows of a. rows of whole words are counted in one popcountWords over the matrix, so a
+	// build without popcnt makes one dispatched call per matrix rather than one per row
+	template <int N, typename RepType>
+	TINYBIT_ALWAYS_INLINE int matrixOnes(RepType const *a) {
+		int ones = 0;
+		if constexpr (sizeof(RepType) % 8 == 0) {
+			ones = tinybit::popcountWords(reinterpret_cast<uint64_t const *>(a), N * int(sizeof(RepType) / 8));
+		} else {
+			for (int i = 0; i < N; i++) {
+				ones += __builtin_popcountll(TinyBitRepTraits<RepType>::word(a[i], 0));
+			}
+		}
+		return ones;
+	}
+
+
+	// c = a * b for N x N matrices of rows. c may be a or b
+	template <int N, typename RepType>
+	TINYBIT_ALWAYS_INLINE void multiplyBody(RepType *c, RepType const *a, RepType const *b) {
+		using Traits = TinyBitRepTraits<RepType>;
+		constexpr int bits = matrixGroupBits(N);
+		RepType product[N];
+		for (int i = 0; i < N; i++) {
+			product[i] = RepType();
+		}
+		int ones = matrixOnes<N>(a);
+		// a sparse a is cheaper one row OR per set bit than filling the tables
+		if (ones <= (N / bits) * ((1 << bits) + N)) {
+			for (int i = 0; i < N; i++) {
+				for (TinyBitIterator<RepType> k(&a[i], 0), end(&a[i], Traits::nwords); k != end; ++k) {
+					product[i] |= b[*k - 1];
+				}
+			}
+		} else {
+			RepType table[1 << bits];
+			for (int k0 = 0; k0 < N; k0 += bits) {
+				int width = (N - k0 < bits) ? N - k0 : bits;
+				// every subset x of rows k0 .. k0 + width - 1 of b, each one OR from a smaller subset
+				table[0] = RepType();
+				for (int x = 1; x < (1 << width); x++) {
+					table[x] = table[x & (x - 1)] | b[k0 + __builtin_ctz(x)];
+				}
+				int w = k0 >> 6;
+				int shift = k0 & 63;
+				uint64_t mask = (uint64_t(1) << width) - 1;
+				for (int i = 0; i < N; i++) {
+					product[i] |= table[(Traits::word(a[i], w) >> shift) & mask];
+				}
+			}
+		}
+		for (int i = 0; i < N; i++) {
+			c[i] = product[i];
+		}
+	}
+
+
+	// c = the transitive closure of a, c may be a
+	template <int N, typename RepType>
+	TINYBIT_ALWAYS_INLINE void closureBody(RepType *c, RepType const *a) {
+		RepType squared[N];
+		for (int i = 0; i < N; i++) {
+			c[i] = a[i];
+		}
+		// after k rounds c holds every path of 1 .. 2^k arcs
+		bool changed = true;
+		while (changed) {
+			multiplyBody<N>(squared, c, c);
+			changed = false;
+			for (int i = 0; i < N; i++) {
+				RepType grown = c[i] | squared[i];
+				changed = changed || (grown != c[i]);
+				c[i] = grown;
+			}
+		}
+	}
+
+
+	// count products (closures when b is null) of consecutive N x N matrices
+	template <int N, typename RepType>
+	void matrixBatch(RepType *c, RepType const *a, RepType const *b, size_t count) {
+		for (size_t m = 0; m < count; m++) {
+			if (b != nullptr) {
+				multiplyBody<N>(c + m * N, a + m * N, b + m * N);
+			} else {
+				closureBody<N>(c + m * N, a + m * N);
+			}
+		}
+	}
+
+
+	template <int N, typename RepType>
+	void matrixBatchThreads(RepType *c, RepType const *a, RepType const *b, size_t count, int nthreads) {
+		if (count < matrixParallelMin) {
+			nthreads = 1;
+		}
+		parallelRanges(nthreads, count, [=](size_t begin, size_t end) {
+			matrixBatch<N>(c + begin * N, a + begin * N, (b != nullptr) ? b + begin * N : nullptr, end - begin);
+		});
+	}
+
+}
+
+
+
+template <int N, typename BoundsCheck = TinyBitThrowCheck>
+class TinyBitMatrix {
+	public:
+		using row_type = TinyBitSet<N, BoundsCheck>;
+
+		// the empty relation
+		TinyBitMatrix() : rows() {}
+		// row i - 1 of rows is row i
+		explicit TinyBitMatrix(row_type const *rows);
+		// i -> i for every i
+		static TinyBitMatrix identity();
+
+		void insert(int i, int j);
+		void remove(int i, int j);
+		bool contains(int i, int j) const;
+		row_type &row(int i);
+		row_type const &row(int i) const;
+		// the N rows, row 1 first
+		row_type *data() { return this->rows.data(); }
+		row_type const *data() const { return this->rows.data(); }
+
+		bool operator==(TinyBitMatrix const &other) const { return this->rows == other.rows; }
+		bool operator!=(TinyBitMatrix const &other) const { return this->rows != other.rows; }
+
+		TinyBitMatrix operator*(TinyBitMatrix const &other) const;
+		TinyBitMatrix &operator*=(TinyBitMatrix const &other);
+		TinyBitMatrix operator|(TinyBitMatrix const &other) const;
+		TinyBitMatrix &operator|=(TinyBitMatrix const &other);
+
+		// j -> i wherever i -> j
+		TinyBitMatrix transpose() const;
+		// i -> j wherever a path of one or more arcs leads from i to j, identity() | closure for zero or more
+		TinyBitMatrix transitiveClosure() const;
+
+	private:
+		using RepType = TinyBitRepType<N>;
+		static_assert(sizeof(row_type) == sizeof(RepType), "TinyBitMatrix needs TinyBitSet to be exactly its words");
+
+		std::array<row_type, N> rows;
+
+		RepType *reps() { return reinterpret_cast<RepType *>(this->rows.data()); }
+		RepType const *reps() const { return reinterpret_cast<RepType const *>(this->rows.data()); }
+};
+
+
+
+template <int N, typename BoundsCheck>
+TinyBitMatrix<N, BoundsCheck>::TinyBitMatrix(row_type const *rows) : rows() {
+	for (int i = 0; i < N; i++) {
+		this->rows[i] = rows[i];
+	}
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitMatrix<N, BoundsCheck> TinyBitMatrix<N, BoundsCheck>::identity() {
+	TinyBitMatrix m;
+	for (int i = 1; i <= N; i++) {
+		m.rows[i - 1].insert(i);
+	}
+	return m;
+}
+
+
+template <int N, typename BoundsCheck>
+void TinyBitMatrix<N, BoundsCheck>::insert(int i, int j) {
+	BoundsCheck::check(i, N, "insert");
+	this->rows[i - 1].insert(j);
+}
+
+
+template <int N, typename BoundsCheck>
+void TinyBitMatrix<N, BoundsCheck>::remove(int i, int j) {
+	BoundsCheck::check(i, N, "remove");
+	this->rows[i - 1].remove(j);
+}
+
+
+template <int N, typename BoundsCheck>
+bool TinyBitMatrix<N, BoundsCheck>::contains(int i, int j) const {
+	BoundsCheck::check(i, N, "contains");
+	return this->rows[i - 1].contains(j);
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitSet<N, BoundsCheck> &TinyBitMatrix<N, BoundsCheck>::row(int i) {
+	BoundsCheck::check(i, N, "row");
+	return this->rows[i - 1];
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitSet<N, BoundsCheck> const &TinyBitMatrix<N, BoundsCheck>::row(int i) const {
+	BoundsCheck::check(i, N, "row");
+	return this->rows[i - 1];
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitMatrix<N, BoundsCheck> TinyBitMatrix<N, BoundsCheck>::operator*(TinyBitMatrix const &other) const {
+	TinyBitMatrix product;
+	tinybit::matrixBatch<N>(product.reps(), this->reps(), other.reps(), 1);
+	return product;
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitMatrix<N, BoundsCheck> &TinyBitMatrix<N, BoundsCheck>::operator*=(TinyBitMatrix const &other) {
+	tinybit::matrixBatch<N>(this->reps(), this->reps(), other.reps(), 1);
+	return *this;
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitMatrix<N, BoundsCheck> TinyBitMatrix<N, BoundsCheck>::operator|(TinyBitMatrix const &other) const {
+	TinyBitMatrix result = *this;
+	result |= other;
+	return result;
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitMatrix<N, BoundsCheck> &TinyBitMatrix<N, BoundsCheck>::operator|=(TinyBitMatrix const &other) {
+	for (int i = 0; i < N; i++) {
+		this->rows[i] |= other.rows[i];
+	}
+	return *this;
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitMatrix<N, BoundsCheck> TinyBitMatrix<N, BoundsCheck>::transpose() const {
+	TinyBitMatrix t;
+	for (int i = 1; i <= N; i++) {
+		for (int j : this->rows[i - 1]) {
+			t.row(j).insert(i);
+		}
+	}
+	return t;
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitMatrix<N, BoundsCheck> TinyBitMatrix<N, BoundsCheck>::transitiveClosure() const {
+	TinyBitMatrix closure;
+	tinybit::matrixBatch<N>(closure.reps(), this->reps(), static_cast<RepType const *>(nullptr), 1);
+	return closure;
+}
+
+
+
+// out = a * b over arrays of N rows each, row i - 1 the row of i. out may be a or b
+template <int N, typename BoundsCheck>
+void multiplyRows(TinyBitSet<N, BoundsCheck> *out, TinyBitSet<N, BoundsCheck> const *a, TinyBitSet<N, BoundsCheck> const *b) {
+	using RepType = TinyBitRepType<N>;
+	static_assert(sizeof(TinyBitSet<N, BoundsCheck>) == sizeof(RepType), "multiplyRows needs TinyBitSet to be exactly its words");
+	tinybit::matrixBatch<N>(reinterpret_cast<RepType *>(out), reinterpret_cast<RepType const *>(a), reinterpret_cast<RepType const *>(b), 1);
+}
+
+
+// out[m] = a[m] * b[m] for count matrices, split across nthreads when there are enough. out may be a or b
+template <int N, typename BoundsCheck>
+void multiplyAll(TinyBitMatrix<N, BoundsCheck> *out, TinyBitMatrix<N, BoundsCheck> const *a, TinyBitMatrix<N, BoundsCheck> const *b, size_t count,
+				 int nthreads = 1) {
+	using RepType = TinyBitRepType<N>;
+	static_assert(sizeof(TinyBitMatrix<N, BoundsCheck>) == N * sizeof(RepType), "multiplyAll needs TinyBitMatrix to be exactly its rows");
+	tinybit::matrixBatchThreads<N>(reinterpret_cast<RepType *>(out), reinterpret_cast<RepType const *>(a), reinterpret_cast<RepType const *>(b), count,
+								   nthreads);
+}
+
+
+// out[m] = in[m].transitiveClosure() for count matrices. out may be in
+template <int N, typename BoundsCheck>
+void transitiveClosureAll(TinyBitMatrix<N, BoundsCheck> *out, TinyBitMatrix<N, BoundsCheck> const *in, size_t count, int nthreads = 1) {
+	using RepType = TinyBitRepType<N>;
+	static_assert(sizeof(TinyBitMatrix<N, BoundsCheck>) == N * sizeof(RepType), "transitiveClosureAll needs TinyBitMatrix to be exactly its rows");
+	tinybit::matrixBatchThreads<N>(reinterpret_cast<RepType *>(out), reinterpret_cast<RepType const *>(in), static_cast<RepType const *>(nullptr), count,
+								   nthreads);
+}
+
+
+#endif
@@ -0,0 +1,217 @@
+/*
+a fixed permutation of 1 .. N, precomputed so that applying it to a TinyBitSet<N> takes a few table lookups
+instead of a contains / insert per element:
+
+	TinyBitPermutation<N> p(images)   i -> images[i - 1], images must hold each of 1 .. N once
+	p(i)                              the image of one element
+	p(s)                              the set of images of the elements of s
+	p.apply(out, in, n)               p(s) for n sets
+	p.inverse(), p.then(q)            the inverse, and p followed by q
+	canonicalForm(s, group, n)        the smallest of s and its images under n permutations (by <), the usual
+	                                  representative of s when searching up to symmetry
+
+the set is cut into groups of 8 elements (4 for N > 64), and for every group a table holds the image of each
+of its 256 (16) subsets, so p(s) is one lookup and OR per group: 8 for a TinyBitSet<64>, against a contains /
+insert per element, or the 11 masked swap stages of a Benes network on the word. the tables are held by the
+permutation and built once: 16KB for N = 64, half of a 32 - 48KB L1d, and N / 4 tables of 16 sets above that
+(32KB for N = 256).
+
+*/
+
+#ifndef TINYBITPERMUTATION_H
+#define TINYBITPERMUTATION_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tinybitset.h"
+
+
+namespace tinybit {
+
+	// elements per table lookup, so the tables of a TinyBitSet<64> take half of L1d and those of wider sets
+	// stay within it up to N = 256
+	constexpr int permutationGroupBits(int n) {
+		return (n <= 64) ? 8 : 4;
+	}
+
+}
+
+
+
+template <int N, typename BoundsCheck = TinyBitThrowCheck>
+class TinyBitPermutation {
+	public:
+		using set_type = TinyBitSet<N, BoundsCheck>;
+
+		// the identity
+		TinyBitPermutation();
+		// i -> images[i - 1] for i = 1 .. N
+		explicit TinyBitPermutation(int const *images);
+		explicit TinyBitPermutation(std::vector<int> const &images);
+
+		int operator()(int i) const;
+		set_type operator()(set_type const &s) const;
+		// out[k] = (*this)(in[k]) for n sets, out may be in
+		void apply(set_type *out, set_type const *in, size_t n) const;
+
+		TinyBitPermutation inverse() const;
+		// i -> other(this(i))
+		TinyBitPermutation then(TinyBitPermutation const &other) const;
+
+		bool operator==(TinyBitPermutation const &other) const { return this->images == other.images; }
+		bool operator!=(TinyBitPermutation const &other) const { return this->images != other.images; }
+
+	private:
+		using RepType = TinyBitRepType<N>;
+		using Traits = TinyBitRepTraits<RepType>;
+		static_assert(sizeof(set_type) == sizeof(RepType), "TinyBitPermutation needs TinyBitSet to be exactly its words");
+
+		static constexpr int groupBits = tinybit::permutationGroupBits(N);
+		static constexpr int groups = (N + groupBits - 1) / groupBits;
+
+		std::array<int, N> images;
+		// entry (g << groupBits) + x is the image of subset x of elements g * groupBits + 1 .. (g + 1) * groupBits
+		std::vector<RepType> tables;
+
+		static int const *sizedImages(std::vector<int> const &images);
+		void build();
+		RepType map(RepType const &rep) const;
+};
+
+
+
+template <int N, typename BoundsCheck>
+TinyBitPermutation<N, BoundsCheck>::TinyBitPermutation() : images() {
+	for (int i = 0; i < N; i++) {
+		this->images[i] = i + 1;
+	}
+	this->build();
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitPermutation<N, BoundsCheck>::TinyBitPermutation(int const *images) : images() {
+	std::array<bool, N> seen{};
+	for (int i = 0; i < N; i++) {
+		int image = images[i];
+		if ((image < 1) || (image > N) || seen[image - 1]) {
+			throw std::invalid_argument("TinyBitPermutation<" + std::to_string(N) + "> needs each of 1 .. " + std::to_string(N)
+										+ " once as an image, but " + std::to_string(i + 1) + " was sent to " + std::to_string(image) + ".");
+		}
+		seen[image - 1] = true;
+		this->images[i] = image;
+	}
+	this->build();
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitPermutation<N, BoundsCheck>::TinyBitPermutation(std::vector<int> const &images) : TinyBitPermutation(sizedImages(images)) {}
+
+
+template <int N, typename BoundsCheck>
+int const *TinyBitPermutation<N, BoundsCheck>::sizedImages(std::vector<int> const &images) {
+	if (images.size() != size_t(N)) {
+		throw std::invalid_argument("TinyBitPermutation<" + std::to_string(N) + "> needs " + std::to_string(N) + " images, but was given "
+									+ std::to_string(images.size()) + ".");
+	}
+	return images.data();
+}
+
+
+template <int N, typename BoundsCheck>
+void TinyBitPermutation<N, BoundsCheck>::build() {
+	this->tables.assign(size_t(groups) << groupBits, RepType());
+	for (int g = 0; g < groups; g++) {
+		RepType *table = this->tables.data() + (size_t(g) << groupBits);
+		int first = g * groupBits;
+		int width = (N - first < groupBits) ? N - first : groupBits;
+		// each subset is a smaller one plus its lowest element
+		for (int x = 1; x < (1 << width); x++) {
+			table[x] = table[x & (x - 1)];
+			Traits::set(table[x], this->images[first + __builtin_ctz(x)] - 1);
+		}
+	}
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitRepType<N> TinyBitPermutation<N, BoundsCheck>::map(RepType const &rep) const {
+	RepType out = RepType();
+	RepType const *table = this->tables.data();
+	for (int g = 0; g < groups; g++) {
+		int first = g * groupBits;
+		uint64_t x = (Traits::word(rep, first >> 6) >> (first & 63)) & ((uint64_t(1) << groupBits) - 1);
+		out |= table[(size_t(g) << groupBits) + x];
+	}
+	return out;
+}
+
+
+template <int N, typename BoundsCheck>
+int TinyBitPermutation<N, BoundsCheck>::operator()(int i) const {
+	BoundsCheck::check(i, N, "TinyBitPermutation");
+	return this->images[i - 1];
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitSet<N, BoundsCheck> TinyBitPermutation<N, BoundsCheck>::operator()(set_type const &s) const {
+	set_type out;
+	this->apply(&out, &s, 1);
+	return out;
+}
+
+
+template <int N, typename BoundsCheck>
+void TinyBitPermutation<N, BoundsCheck>::apply(set_type *out, set_type const *in, size_t n) const {
+	RepType *outReps = reinterpret_cast<RepType *>(out);
+	RepType const *inReps = reinterpret_cast<RepType const *>(in);
+	for (size_t k = 0; k < n; k++) {
+		outReps[k] = this->map(inReps[k]);
+	}
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitPermutation<N, BoundsCheck> TinyBitPermutation<N, BoundsCheck>::inverse() const {
+	std::array<int, N> back;
+	for (int i = 0; i < N; i++) {
+		back[this->images[i] - 1] = i + 1;
+	}
+	return TinyBitPermutation(back.data());
+}
+
+
+template <int N, typename BoundsCheck>
+TinyBitPermutation<N, BoundsCheck> TinyBitPermutation<N, BoundsCheck>::then(TinyBitPermutation const &other) const {
+	std::array<int, N> composed;
+	for (int i = 0; i < N; i++) {
+		composed[i] = other.images[this->images[i] - 1];
+	}
+	return TinyBitPermutation(composed.data());
+}
+
+
+
+// the smallest of s and its images under group[0 .. n-1], by TinyBitSet's <. the same for every set in an
+// orbit when group holds the whole symmetry group (the identity may be left out)
+template <int N, typename BoundsCheck>
+TinyBitSet<N, BoundsCheck> canonicalForm(TinyBitSet<N, BoundsCheck> const &s, TinyBitPermutation<N, BoundsCheck> const *group, size_t n) {
+	TinyBitSet<N, BoundsCheck> best = s;
+	for (size_t k = 0; k < n; k++) {
+		TinyBitSet<N, BoundsCheck> image = group[k](s);
+		if (image < best) {
+			best = image;
+		}
+	}
+	return best;
+}
+
+
+#endif
@@ -0,0 +1,637 @@
+/*
+compressed set of 32-bit integers for id spaces too large for one TinyBitSet, in the "roaring bitmap" layout.
+
+the high 16 bits of a value pick a chunk, the low 16 bits go into that chunk's container, which is one of
+	- array:  sorted uint16_t values, used while the chunk holds at most 4096 values (<= 8KB)
+	- bitmap: 1024 TinyBitSet<64> words covering all 65536 values (8KB), used above that
+	- run:    sorted [start, last] intervals, only produced by runOptimize() when they are smaller than both
+
+so sparse chunks cost 2 bytes a value, dense chunks 1 bit a value and long stretches 4 bytes a run,
+instead of the ~40 bytes a value of std::unordered_set.
+
+union / intersection / difference walk the two chunk lists together and combine matching containers:
+	- bitmap with bitmap goes word by word through TinyBitSet's unionb / intersectionb / leftDifference
+	- array with bitmap probes the bitmap once per array value
+	- array with array intersects / subtracts 8 values against 8 at a time with SSE2 compares,
+	  union merges (or goes through a bitmap when the result could pass 4096)
+	- run containers are expanded to array or bitmap form first
+results are kept in canonical form: array at <= 4096 values, bitmap above.
+
+chunks are kept in one sorted list, so a new chunk shifts the ones after it: sets whose values are scattered
+over thousands of chunks build fastest in increasing order.
+
+values here are 0 based (0 .. 2^32-1), unlike TinyBitSet's 1 based elements.
+
+*/
+
+#ifndef TINYBITROARING_H
+#define TINYBITROARING_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "tinybitset.h"
+
+
+namespace tinybit {
+
+	constexpr uint32_t arrayMax = 4096;
+	constexpr size_t bitmapWords = 1024;
+
+	using ChunkWord = TinyBitSet<64, TinyBitNoCheck>;
+
+	// inclusive interval of low 16 bit values
+	struct RoaringRun {
+		uint16_t start;
+		uint16_t last;
+	};
+
+	struct RoaringContainer {
+		enum Kind : uint8_t { ArrayKind, BitmapKind, RunKind };
+
+		Kind kind = ArrayKind;
+		uint32_t card = 0;
+		std::vector<uint16_t> array;     // ArrayKind
+		std::vector<ChunkWord> bitmap;   // BitmapKind, bitmapWords words, value v is element v % 64 + 1 of word v / 64
+		std::vector<RoaringRun> runs;    // RunKind, sorted, disjoint and not touching
+	};
+
+
+#if defined(__SSE2__)
+	// bit 2k set where a[k] equals any of b[0..7], comparing against all 8 rotations of b
+	inline uint32_t matchAny8(uint16_t const *a, uint16_t const *b) {
+		__m128i va = _mm_loadu_si128(reinterpret_cast<__m128i const *>(a));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<__m128i const *>(b));
+		__m128i eq = _mm_cmpeq_epi16(va, vb);
+		for (int r = 1; r < 8; r++) {
+			vb = _mm_or_si128(_mm_srli_si128(vb, 2), _mm_slli_si128(vb, 14));
+			eq = _mm_or_si128(eq, _mm_cmpeq_epi16(va, vb));
+		}
+		return static_cast<uint32_t>(_mm_movemask_epi8(eq)) & 0x5555u;
+	}
+#endif
+
+
+	inline void intersectArrays(std::vector<uint16_t> const &a, std::vector<uint16_t> const &b, std::vector<uint16_t> &out) {
+		/*
+		   blocks of 8 are compared all against all, then the block with the smaller maximum moves on,
+		   values are unique so nothing is found twice. the scalar merge finishes the tails
+		*/
+		out.clear();
+		size_t i = 0;
+		size_t j = 0;
+#if defined(__SSE2__)
+		while ((i + 8 <= a.size()) && (j + 8 <= b.size())) {
+			for (uint32_t m = matchAny8(&a[i], &b[j]); m; m &= m - 1) {
+				out.push_back(a[i + __builtin_ctz(m) / 2]);
+			}
+			uint16_t amax = a[i + 7];
+			uint16_t bmax = b[j + 7];
+			i += (amax <= bmax) ? 8 : 0;
+			j += (bmax <= amax) ? 8 : 0;
+		}
+#endif
+		while ((i < a.size()) && (j < b.size())) {
+			if (a[i] < b[j]) {
+				i++;
+			} else if (b[j] < a[i]) {
+				j++;
+			} else {
+				out.push_back(a[i]);
+				i++;
+				j++;
+			}
+		}
+	}
+
+
+	inline void differenceArrays(std::vector<uint16_t> const &a, std::vector<uint16_t> const &b, std::vector<uint16_t> &out) {
+		/*
+		   a - b. like intersectArrays, but the matches of the current a block are collected over every
+		   b block it meets and the unmatched values written once the a block is done
+		*/
+		out.clear();
+		size_t i = 0;
+		size_t j = 0;
+		uint32_t matched = 0;
+#if defined(__SSE2__)
+		while ((i + 8 <= a.size()) && (j + 8 <= b.size())) {
+			matched |= matchAny8(&a[i], &b[j]);
+			uint16_t amax = a[i + 7];
+			uint16_t bmax = b[j + 7];
+			if (amax <= bmax) {
+				for (uint32_t m = ~matched & 0x5555u; m; m &= m - 1) {
+					out.push_back(a[i + __builtin_ctz(m) / 2]);
+				}
+				i += 8;
+				matched = 0;
+			}
+			j += (bmax <= amax) ? 8 : 0;
+		}
+#endif
+		// values of a half-done block that already matched an earlier b block are skipped
+		size_t block = i;
+		for (; i < a.size(); i++) {
+			if ((i - block < 8) && ((matched >> (2 * (i - block))) & 1)) {
+				continue;
+			}
+			while ((j < b.size()) && (b[j] < a[i])) {
+				j++;
+			}
+			if ((j == b.size()) || (b[j] != a[i])) {
+				out.push_back(a[i]);
+			}
+		}
+	}
+
+
+	template <typename Callback>
+	void containerForEach(RoaringContainer const &c, Callback &&callback) {
+		if (c.kind == RoaringContainer::ArrayKind) {
+			for (uint16_t v : c.array) {
+				callback(v);
+			}
+		} else if (c.kind == RoaringContainer::BitmapKind) {
+			for (size_t w = 0; w < bitmapWords; w++) {
+				c.bitmap[w].forEach([&callback, w](int i) { callback(static_cast<uint16_t>(64 * w + size_t(i - 1))); });
+			}
+		} else {
+			for (RoaringRun const &run : c.runs) {
+				for (uint32_t v = run.start; v <= run.last; v++) {
+					callback(static_cast<uint16_t>(v));
+				}
+			}
+		}
+	}
+
+
+	inline void toBitmap(RoaringContainer &c) {
+		std::vector<ChunkWord> words(bitmapWords);
+		if (c.kind == RoaringContainer::RunKind) {
+			for (RoaringRun const &run : c.runs) {
+				for (uint32_t w = run.start / 64u; w <= run.last / 64u; w++) {
+					int lo = (w == run.start / 64u) ? run.start % 64 + 1 : 1;
+					int hi = (w == run.last / 64u) ? run.last % 64 + 1 : 64;
+					words[w].insertRange(lo, hi);
+				}
+			}
+		} else {
+			containerForEach(c, [&words](uint16_t v) { words[v / 64].insert(v % 64 + 1); });
+		}
+		c.bitmap.swap(words);
+		c.array = std::vector<uint16_t>();
+		c.runs = std::vector<RoaringRun>();
+		c.kind = RoaringContainer::BitmapKind;
+	}
+
+
+	inline void toArray(RoaringContainer &c) {
+		std::vector<uint16_t> values;
+		values.reserve(c.card);
+		containerForEach(c, [&values](uint16_t v) { values.push_back(v); });
+		c.array.swap(values);
+		c.bitmap = std::vector<ChunkWord>();
+		c.runs = std::vector<RoaringRun>();
+		c.kind = RoaringContainer::ArrayKind;
+	}
+
+
+	// array at <= arrayMax values, bitmap above
+	inline void normalize(RoaringContainer &c) {
+		if ((c.card <= arrayMax) && (c.kind != RoaringContainer::ArrayKind)) {
+			toArray(c);
+		} else if ((c.card > arrayMax) && (c.kind != RoaringContainer::BitmapKind)) {
+			toBitmap(c);
+		}
+	}
+
+
+	inline bool containerContains(RoaringContainer const &c, uint16_t v) {
+		if (c.kind == RoaringContainer::ArrayKind) {
+			return std::binary_search(c.array.begin(), c.array.end(), v);
+		} else if (c.kind == RoaringContainer::BitmapKind) {
+			return c.bitmap[v / 64].contains(v % 64 + 1);
+		}
+		auto after = std::upper_bound(c.runs.begin(), c.runs.end(), v, [](uint16_t x, RoaringRun const &run) { return x < run.start; });
+		return (after != c.runs.begin()) && (std::prev(after)->last >= v);
+	}
+
+
+	// returns whether v was added
+	inline bool containerInsert(RoaringContainer &c, uint16_t v) {
+		if (containerContains(c, v)) {
+			return false;
+		}
+		if (c.kind == RoaringContainer::RunKind) {
+			normalize(c);
+		}
+		if ((c.kind == RoaringContainer::ArrayKind) && (c.card == arrayMax)) {
+			toBitmap(c);
+		}
+		if (c.kind == RoaringContainer::ArrayKind) {
+			c.array.insert(std::lower_bound(c.array.begin(), c.array.end(), v), v);
+		} else {
+			c.bitmap[v / 64].insert(v % 64 + 1);
+		}
+		c.card++;
+		return true;
+	}
+
+
+	// returns whether v was removed
+	inline bool containerRemove(RoaringContainer &c, uint16_t v) {
+		if (!containerContains(c, v)) {
+			return false;
+		}
+		if (c.kind == RoaringContainer::RunKind) {
+			normalize(c);
+		}
+		if (c.kind == RoaringContainer::ArrayKind) {
+			c.array.erase(std::lower_bound(c.array.begin(), c.array.end(), v));
+		} else {
+			c.bitmap[v / 64].remove(v % 64 + 1);
+		}
+		c.card--;
+		normalize(c);
+		return true;
+	}
+
+
+	inline std::vector<RoaringRun> collectRuns(RoaringContainer const &c) {
+		std::vector<RoaringRun> runs;
+		containerForEach(c, [&runs](uint16_t v) {
+			if (!runs.empty() && (uint32_t(runs.back().last) + 1 == v)) {
+				runs.back().last = v;
+			} else {
+				runs.push_back(RoaringRun{v, v});
+			}
+		});
+		return runs;
+	}
+
+
+	// switches to runs when they take fewer bytes than the array / bitmap form, and back when they don't
+	inline void runOptimize(RoaringContainer &c) {
+		std::vector<RoaringRun> runs = collectRuns(c);
+		size_t runBytes = runs.size() * sizeof(RoaringRun);
+		size_t otherBytes = (c.card <= arrayMax) ? c.card * sizeof(uint16_t) : bitmapWords * sizeof(uint64_t);
+		if (runBytes < otherBytes) {
+			c.runs.swap(runs);
+			c.array = std::vector<uint16_t>();
+			c.bitmap = std::vector<ChunkWord>();
+			c.kind = RoaringContainer::RunKind;
+		} else {
+			normalize(c);
+		}
+	}
+
+
+	inline size_t containerBytes(RoaringContainer const &c) {
+		return c.array.size() * sizeof(uint16_t) + c.bitmap.size() * sizeof(ChunkWord) + c.runs.size() * sizeof(RoaringRun);
+	}
+
+
+	inline RoaringContainer expandedCopy(RoaringContainer const &c) {
+		RoaringContainer copy = c;
+		if (copy.kind == RoaringContainer::RunKind) {
+			normalize(copy);
+		}
+		return copy;
+	}
+
+
+	inline RoaringContainer containerUnion(RoaringContainer const &a, RoaringContainer const &b) {
+		if ((a.kind == RoaringContainer::RunKind) || (b.kind == RoaringContainer::RunKind)) {
+			return containerUnion(expandedCopy(a), expandedCopy(b));
+		}
+		RoaringContainer out;
+		if ((a.kind == RoaringContainer::ArrayKind) && (b.kind == RoaringContainer::ArrayKind) && (a.card + b.card <= arrayMax)) {
+			out.array.reserve(a.card + b.card);
+			std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(out.array));
+			out.card = uint32_t(out.array.size());
+			return out;
+		}
+		if ((a.kind == RoaringContainer::BitmapKind) && (b.kind == RoaringContainer::BitmapKind)) {
+			out.kind = RoaringContainer::BitmapKind;
+			out.bitmap.resize(bitmapWords);
+			for (size_t w = 0; w < bitmapWords; w++) {
+				out.bitmap[w] = a.bitmap[w].unionb(b.bitmap[w]);
+				out.card += uint32_t(out.bitmap[w].getSetSize());
+			}
+			return out;
+		}
+		// at least one side is (or the result may need) a bitmap: copy the bitmap side, add the other side's values
+		RoaringContainer const &dense = (a.kind == RoaringContainer::BitmapKind) ? a : b;
+		RoaringContainer const &sparse = (a.kind == RoaringContainer::BitmapKind) ? b : a;
+		out = dense;
+		if (out.kind != RoaringContainer::BitmapKind) {
+			toBitmap(out);
+		}
+		for (uint16_t v : sparse.array) {
+			ChunkWord &word = out.bitmap[v / 64];
+			out.card += word.contains(v % 64 + 1) ? 0 : 1;
+			word.insert(v % 64 + 1);
+		}
+		normalize(out);
+		return out;
+	}
+
+
+	inline RoaringContainer containerIntersection(RoaringContainer const &a, RoaringContainer const &b) {
+		if ((a.kind == RoaringContainer::RunKind) || (b.kind == RoaringContainer::RunKind)) {
+			return containerIntersection(expandedCopy(a), expandedCopy(b));
+		}
+		RoaringContainer out;
+		if ((a.kind == RoaringContainer::ArrayKind) && (b.kind == RoaringContainer::ArrayKind)) {
+			intersectArrays(a.array, b.array, out.array);
+		} else if ((a.kind == RoaringContainer::BitmapKind) && (b.kind == RoaringContainer::BitmapKind)) {
+			out.kind = RoaringContainer::BitmapKind;
+			out.bitmap.resize(bitmapWords);
+			for (size_t w = 0; w < bitmapWords; w++) {
+				out.bitmap[w] = a.bitmap[w].intersectionb(b.bitmap[w]);
+				out.card += uint32_t(out.bitmap[w].getSetSize());
+			}
+			normalize(out);
+			return out;
+		} else {
+			RoaringContainer const &dense = (a.kind == RoaringContainer::BitmapKind) ? a : b;
+			RoaringContainer const &sparse = (a.kind == RoaringContainer::BitmapKind) ? b : a;
+			for (uint16_t v : sparse.array) {
+				if (dense.bitmap[v / 64].contains(v % 64 + 1)) {
+					out.array.push_back(v);
+				}
+			}
+		}
+		out.card = uint32_t(out.array.size());
+		return out;
+	}
+
+
+	// a - b
+	inline RoaringContainer containerDifference(RoaringContainer const &a, RoaringContainer const &b) {
+		if ((a.kind == RoaringContainer::RunKind) || (b.kind == RoaringContainer::RunKind)) {
+			return containerDifference(expandedCopy(a), expandedCopy(b));
+		}
+		RoaringContainer out;
+		if (a.kind == RoaringContainer::ArrayKind) {
+			if (b.kind == RoaringContainer::ArrayKind) {
+				differenceArrays(a.array, b.array, out.array);
+			} else {
+				for (uint16_t v : a.array) {
+					if (!b.bitmap[v / 64].contains(v % 64 + 1)) {
+						out.array.push_back(v);
+					}
+				}
+			}
+			out.card = uint32_t(out.array.size());
+			return out;
+		}
+		out = a;
+		if (b.kind == RoaringContainer::BitmapKind) {
+			out.card = 0;
+			for (size_t w = 0; w < bitmapWords; w++) {
+				out.bitmap[w] = a.bitmap[w].leftDifference(b.bitmap[w]);
+				out.card += uint32_t(out.bitmap[w].getSetSize());
+			}
+		} else {
+			for (uint16_t v : b.array) {
+				ChunkWord &word = out.bitmap[v / 64];
+				out.card -= word.contains(v % 64 + 1) ? 1 : 0;
+				word.remove(v % 64 + 1);
+			}
+		}
+		normalize(out);
+		return out;
+	}
+
+
+	inline bool containerEquals(RoaringContainer const &a, RoaringContainer const &b) {
+		if (a.card != b.card) {
+			return false;
+		}
+		if ((a.kind == b.kind) && (a.kind == RoaringContainer::ArrayKind)) {
+			return a.array == b.array;
+		}
+		if ((a.kind == b.kind) && (a.kind == RoaringContainer::BitmapKind)) {
+			return a.bitmap == b.bitmap;
+		}
+		return containerIntersection(a, b).card == a.card;
+	}
+
+}
+
+
+
+class TinyRoaringSet {
+	public:
+		TinyRoaringSet() {}
+
+		void insert(uint32_t x);
+		void remove(uint32_t x);
+		bool contains(uint32_t x) const;
+
+		// chunk by chunk, matching containers combined by kind
+		TinyRoaringSet unionb(TinyRoaringSet const &other) const;
+		TinyRoaringSet intersectionb(TinyRoaringSet const &other) const;
+		TinyRoaringSet leftDifference(TinyRoaringSet const &other) const;    // this - other
+		TinyRoaringSet rightDifference(TinyRoaringSet const &other) const;   // other - this
+
+		bool operator==(TinyRoaringSet const &other) const;
+		bool operator!=(TinyRoaringSet const &other) const;
+
+		// converts containers to runs where that is smaller, worth calling once a set is built
+		void runOptimize();
+
+		// calls callback(x) for every value in increasing order
+		template <typename Callback>
+		void forEach(Callback &&callback) const;
+
+		std::vector<uint32_t> getIntegerElements() const;
+		uint64_t getSetSize() const;
+		bool isempty() const;
+		// bytes held by the containers' values, not counting vector headers
+		size_t getSizeInBytes() const;
+
+	private:
+		using Container = tinybit::RoaringContainer;
+
+		// index of chunk key in keys, or keys.size() if absent
+		size_t findChunk(uint16_t key) const;
+
+		template <typename Combine>
+		static TinyRoaringSet merge(TinyRoaringSet const &a, TinyRoaringSet const &b, bool keepA, bool keepB, Combine &&combine);
+
+		std::vector<uint16_t> keys;            // sorted high 16 bits
+		std::vector<Container> containers;     // containers[i] holds the low 16 bits of chunk keys[i]
+};
+
+
+
+inline size_t TinyRoaringSet::findChunk(uint16_t key) const {
+	auto it = std::lower_bound(this->keys.begin(), this->keys.end(), key);
+	return ((it != this->keys.end()) && (*it == key)) ? size_t(it - this->keys.begin()) : this->keys.size();
+}
+
+
+inline void TinyRoaringSet::insert(uint32_t x) {
+	uint16_t key = static_cast<uint16_t>(x >> 16);
+	auto it = std::lower_bound(this->keys.begin(), this->keys.end(), key);
+	size_t i = size_t(it - this->keys.begin());
+	if ((it == this->keys.end()) || (*it != key)) {
+		this->keys.insert(it, key);
+		this->containers.insert(this->containers.begin() + long(i), Container());
+	}
+	tinybit::containerInsert(this->containers[i], static_cast<uint16_t>(x));
+}
+
+
+inline void TinyRoaringSet::remove(uint32_t x) {
+	size_t i = findChunk(static_cast<uint16_t>(x >> 16));
+	if (i == this->keys.size()) {
+		return;
+	}
+	tinybit::containerRemove(this->containers[i], static_cast<uint16_t>(x));
+	if (this->containers[i].card == 0) {
+		this->keys.erase(this->keys.begin() + long(i));
+		this->containers.erase(this->containers.begin() + long(i));
+	}
+}
+
+
+inline bool TinyRoaringSet::contains(uint32_t x) const {
+	size_t i = findChunk(static_cast<uint16_t>(x >> 16));
+	return (i != this->keys.size()) && tinybit::containerContains(this->containers[i], static_cast<uint16_t>(x));
+}
+
+
+template <typename Combine>
+TinyRoaringSet TinyRoaringSet::merge(TinyRoaringSet const &a, TinyRoaringSet const &b, bool keepA, bool keepB, Combine &&combine) {
+	/*
+	   walks both chunk lists in key order, chunks on one side only are copied if keepA / keepB,
+	   chunks on both sides are combined, empty results dropped
+	*/
+	TinyRoaringSet out;
+	size_t i = 0;
+	size_t j = 0;
+	while ((i < a.keys.size()) || (j < b.keys.size())) {
+		bool fromA = (j == b.keys.size()) || ((i < a.keys.size()) && (a.keys[i] < b.keys[j]));
+		bool fromB = (i == a.keys.size()) || ((j < b.keys.size()) && (b.keys[j] < a.keys[i]));
+		if (fromA) {
+			if (keepA) {
+				out.keys.push_back(a.keys[i]);
+				out.containers.push_back(a.containers[i]);
+			}
+			i++;
+		} else if (fromB) {
+			if (keepB) {
+				out.keys.push_back(b.keys[j]);
+				out.containers.push_back(b.containers[j]);
+			}
+			j++;
+		} else {
+			Container c = combine(a.containers[i], b.containers[j]);
+			if (c.card != 0) {
+				out.keys.push_back(a.keys[i]);
+				out.containers.push_back(std::move(c));
+			}
+			i++;
+			j++;
+		}
+	}
+	return out;
+}
+
+
+inline TinyRoaringSet TinyRoaringSet::unionb(TinyRoaringSet const &other) const {
+	return merge(*this, other, true, true, tinybit::containerUnion);
+}
+
+
+inline TinyRoaringSet TinyRoaringSet::intersectionb(TinyRoaringSet const &other) const {
+	return merge(*this, other, false, false, tinybit::containerIntersection);
+}
+
+
+inline TinyRoaringSet TinyRoaringSet::leftDifference(TinyRoaringSet const &other) const {
+	return merge(*this, other, true, false, tinybit::containerDifference);
+}
+
+
+inline TinyRoaringSet TinyRoaringSet::rightDifference(TinyRoaringSet const &other) const {
+	return other.leftDifference(*this);
+}
+
+
+inline bool TinyRoaringSet::operator==(TinyRoaringSet const &other) const {
+	if (this->keys != other.keys) {
+		return false;
+	}
+	for (size_t i = 0; i < this->keys.size(); i++) {
+		if (!tinybit::containerEquals(this->containers[i], other.containers[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+inline bool TinyRoaringSet::operator!=(TinyRoaringSet const &other) const {
+	return !(*this == other);
+}
+
+
+inline void TinyRoaringSet::runOptimize() {
+	for (Container &c : this->containers) {
+		tinybit::runOptimize(c);
+	}
+}
+
+
+template <typename Callback>
+void TinyRoaringSet::forEach(Callback &&callback) const {
+	for (size_t i = 0; i < this->keys.size(); i++) {
+		uint32_t high = uint32_t(this->keys[i]) << 16;
+		tinybit::containerForEach(this->containers[i], [&callback, high](uint16_t low) { callback(high | low); });
+	}
+}
+
+
+inline std::vector<uint32_t> TinyRoaringSet::getIntegerElements() const {
+	std::vector<uint32_t> elems;
+	elems.reserve(size_t(getSetSize()));
+	forEach([&elems](uint32_t x) { elems.push_back(x); });
+	return elems;
+}
+
+
+inline uint64_t TinyRoaringSet::getSetSize() const {
+	uint64_t size = 0;
+	for (Container const &c : this->containers) {
+		size += c.card;
+	}
+	return size;
+}
+
+
+inline bool TinyRoaringSet::isempty() const {
+	return this->keys.empty();
+}
+
+
+inline size_t TinyRoaringSet::getSizeInBytes() const {
+	size_t bytes = this->keys.size() * sizeof(uint16_t);
+	for (Container const &c : this->containers) {
+		bytes += tinybit::containerBytes(c);
+	}
+	return bytes;
+}
+
+
+#endif
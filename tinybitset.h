@@ -7,6 +7,9 @@ as each bit in a 64 bit integer represents a number in the set. n -> 2^(n-1)
 
 This allows for insertion, removal, and set operations to be done in O(1) time.
 
+Sets with MaxElems > 64 are stored as an array of 64 bit words (see tinybitwords.h),
+the set-wise operations then run as SIMD loops over (MaxElems + 63) / 64 words.
+
 Q: one question you might ask is, why didn't you just use std::bitset?
 A: contrary to the name, bitset didn't support any set operations, and I wanted to implement them myself,
    as well as have a more intuitive interface for the user. I thought maybe I could make it lighter weight.
@@ -14,296 +17,954 @@ A: contrary to the name, bitset didn't support any set operations, and I wanted
 
 */
 
+#ifndef TINYBITSET_H
+#define TINYBITSET_H
+
+#include <cassert>
 #include <cstdint>
 #include <stdexcept>
 #include <vector>
 #include <string>
 #include <bitset>
+#include <iterator>
 #include <bits/stdc++.h>
 
 #include <iostream>
 
+#include "tinybitwords.h"
+
 
+// exact-width types, so a TinyBitSet<N> is exactly as big as the smallest integer holding N bits
+// (the uint_fastN_t types are 8 bytes for N=16,32 on glibc)
 template <int MaxElems>
-	using TinyBitRepType = typename std::conditional<MaxElems < 9, uint_fast8_t, 
-					typename std::conditional<MaxElems < 17, uint_fast16_t,
-					typename std::conditional<MaxElems < 33, uint_fast32_t,
-					uint_fast64_t>::type>::type>::type;
+	using TinyBitRepType = typename std::conditional<MaxElems < 9, uint8_t, 
+					typename std::conditional<MaxElems < 17, uint16_t,
+					typename std::conditional<MaxElems < 33, uint32_t,
+					typename std::conditional<MaxElems < 65, uint64_t,
+					TinyBitWords<(MaxElems + 63) / 64>>::type>::type>::type>::type;
 
 
 
-template <int MaxElems>
+// bit level helpers for each TinyBitRepType, positions are 0 based (integer n lives at bit n-1)
+template <typename RepType>
+struct TinyBitRepTraits {
+	static constexpr RepType bit(int pos) {
+		return static_cast<RepType>(static_cast<RepType>(1) << pos);
+	}
+
+	static constexpr RepType lowMask(int nbits) {
+		// all ones in the low nbits, nbits == width must not shift by the full width
+		return (nbits >= int(8 * sizeof(RepType))) ? static_cast<RepType>(~static_cast<RepType>(0))
+												   : static_cast<RepType>((static_cast<RepType>(1) << nbits) - 1);
+	}
+
+	// ones at positions from .. to-1
+	static constexpr RepType rangeMask(int from, int to) {
+		return static_cast<RepType>(lowMask(to) & ~lowMask(from));
+	}
+
+	static constexpr RepType complement(RepType rep) {
+		return static_cast<RepType>(~rep);
+	}
+
+	static constexpr bool test(RepType rep, int pos) {
+		return ((rep >> pos) & 1) != 0;
+	}
+
+	static constexpr void set(RepType &rep, int pos) {
+		rep = static_cast<RepType>(rep | bit(pos));
+	}
+
+	static constexpr void reset(RepType &rep, int pos) {
+		rep = static_cast<RepType>(rep & ~bit(pos));
+	}
+
+	static constexpr bool isZero(RepType rep) {
+		return rep == 0;
+	}
+
+	// bits moved k >= 0 places up / down, whatever passes either end is dropped
+	static constexpr RepType shiftUp(RepType rep, int k) {
+		return (k >= int(8 * sizeof(RepType))) ? static_cast<RepType>(0) : static_cast<RepType>(static_cast<uint64_t>(rep) << k);
+	}
+
+	static constexpr RepType shiftDown(RepType rep, int k) {
+		return (k >= int(8 * sizeof(RepType))) ? static_cast<RepType>(0) : static_cast<RepType>(static_cast<uint64_t>(rep) >> k);
+	}
+
+	// the bits of rep under mask packed into the low bits, and the low bits of rep spread over mask
+	static constexpr RepType extract(RepType rep, RepType mask) {
+		return static_cast<RepType>(tinybit::pextWord(static_cast<uint64_t>(rep), static_cast<uint64_t>(mask)));
+	}
+
+	static constexpr RepType deposit(RepType rep, RepType mask) {
+		return static_cast<RepType>(tinybit::pdepWord(static_cast<uint64_t>(rep), static_cast<uint64_t>(mask)));
+	}
+
+	static constexpr bool less(RepType a, RepType b) {
+		return a < b;
+	}
+
+	static constexpr uint64_t hash(RepType rep) {
+		return tinybit::mix64(static_cast<uint64_t>(rep));
+	}
+
+	static constexpr int popcount(RepType rep) {
+#if defined(TINYBIT_DISPATCH) && !defined(__POPCNT__)
+		// built without popcnt, let the cpu dispatch find it
+		if (!TINYBIT_CONSTANT_EVALUATED()) {
+			return tinybit::kernels().popcount(static_cast<uint64_t>(rep));
+		}
+#endif
+		return __builtin_popcountll(static_cast<unsigned long long>(rep));
+	}
+
+	// rep must be non-zero for lowest/highest/select
+	static constexpr int lowest(RepType rep) {
+		return __builtin_ctzll(static_cast<unsigned long long>(rep));
+	}
+
+	static constexpr int highest(RepType rep) {
+		return 63 - __builtin_clzll(static_cast<unsigned long long>(rep));
+	}
+
+	static constexpr int select(RepType rep, int k) {
+		return tinybit::selectWord(static_cast<uint64_t>(rep), k);
+	}
+
+	// number of set bits below position nbits
+	static constexpr int rank(RepType rep, int nbits) {
+		return popcount(static_cast<RepType>(rep & lowMask(nbits)));
+	}
+
+	// the rep viewed as 64 bit words, for the bit-scan iterators
+	static constexpr int nwords = 1;
+
+	static constexpr uint64_t word(RepType const &rep, int) {
+		return static_cast<uint64_t>(rep);
+	}
+
+	template <size_t NBits>
+	static std::bitset<NBits> toBitset(RepType rep) {
+		return std::bitset<NBits>(static_cast<unsigned long long>(rep));
+	}
+};
+
+
+template <int NWords>
+struct TinyBitRepTraits<TinyBitWords<NWords>> {
+	static constexpr TinyBitWords<NWords> bit(int pos) {
+		TinyBitWords<NWords> rep = TinyBitWords<NWords>();
+		rep.words[pos >> 6] = uint64_t(1) << (pos & 63);
+		return rep;
+	}
+
+	static constexpr TinyBitWords<NWords> lowMask(int nbits) {
+		TinyBitWords<NWords> rep = TinyBitWords<NWords>();
+		for (int w = 0; w < NWords; w++) {
+			int bits = nbits - 64 * w;
+			rep.words[w] = (bits >= 64) ? ~uint64_t(0) : (bits <= 0) ? 0 : (uint64_t(1) << bits) - 1;
+		}
+		return rep;
+	}
+
+	static constexpr TinyBitWords<NWords> rangeMask(int from, int to) {
+		TinyBitWords<NWords> rep = TinyBitWords<NWords>();
+		for (int w = from >> 6; (w < NWords) && (64 * w < to); w++) {
+			int lo = (from > 64 * w) ? from - 64 * w : 0;
+			int hi = (to < 64 * (w + 1)) ? to - 64 * w : 64;
+			uint64_t upto = (hi == 64) ? ~uint64_t(0) : (uint64_t(1) << hi) - 1;
+			rep.words[w] = upto & ~((uint64_t(1) << lo) - 1);
+		}
+		return rep;
+	}
+
+	static constexpr TinyBitWords<NWords> complement(TinyBitWords<NWords> const &rep) {
+		return ~rep;
+	}
+
+	static constexpr bool test(TinyBitWords<NWords> const &rep, int pos) {
+		return ((rep.words[pos >> 6] >> (pos & 63)) & 1) != 0;
+	}
+
+	static constexpr void set(TinyBitWords<NWords> &rep, int pos) {
+		rep.words[pos >> 6] |= uint64_t(1) << (pos & 63);
+	}
+
+	static constexpr void reset(TinyBitWords<NWords> &rep, int pos) {
+		rep.words[pos >> 6] &= ~(uint64_t(1) << (pos & 63));
+	}
+
+	static constexpr bool isZero(TinyBitWords<NWords> const &rep) {
+		return rep == TinyBitWords<NWords>();
+	}
+
+	// whole words move k / 64 places, the rest of k carries between neighbouring words
+	static constexpr TinyBitWords<NWords> shiftUp(TinyBitWords<NWords> const &rep, int k) {
+		TinyBitWords<NWords> out = TinyBitWords<NWords>();
+		int ws = k >> 6;
+		int bs = k & 63;
+		for (int w = NWords - 1; w >= ws; w--) {
+			out.words[w] = rep.words[w - ws] << bs;
+			if ((bs != 0) && (w - ws > 0)) {
+				out.words[w] |= rep.words[w - ws - 1] >> (64 - bs);
+			}
+		}
+		return out;
+	}
+
+	static constexpr TinyBitWords<NWords> shiftDown(TinyBitWords<NWords> const &rep, int k) {
+		TinyBitWords<NWords> out = TinyBitWords<NWords>();
+		int ws = k >> 6;
+		int bs = k & 63;
+		for (int w = 0; w + ws < NWords; w++) {
+			out.words[w] = rep.words[w + ws] >> bs;
+			if ((bs != 0) && (w + ws + 1 < NWords)) {
+				out.words[w] |= rep.words[w + ws + 1] << (64 - bs);
+			}
+		}
+		return out;
+	}
+
+	// a pext / pdep per word, the packed side read or written at a running offset of the bits of mask so far
+	static constexpr TinyBitWords<NWords> extract(TinyBitWords<NWords> const &rep, TinyBitWords<NWords> const &mask) {
+		TinyBitWords<NWords> out = TinyBitWords<NWords>();
+		int at = 0;
+		for (int w = 0; w < NWords; w++) {
+			uint64_t bits = tinybit::pextWord(rep.words[w], mask.words[w]);
+			int count = __builtin_popcountll(mask.words[w]);
+			int shift = at & 63;
+			out.words[at >> 6] |= bits << shift;
+			if ((shift != 0) && (shift + count > 64)) {
+				out.words[(at >> 6) + 1] |= bits >> (64 - shift);
+			}
+			at += count;
+		}
+		return out;
+	}
+
+	static constexpr TinyBitWords<NWords> deposit(TinyBitWords<NWords> const &rep, TinyBitWords<NWords> const &mask) {
+		TinyBitWords<NWords> out = TinyBitWords<NWords>();
+		int at = 0;
+		for (int w = 0; w < NWords; w++) {
+			int count = __builtin_popcountll(mask.words[w]);
+			if (count == 0) {
+				continue;
+			}
+			int shift = at & 63;
+			uint64_t bits = rep.words[at >> 6] >> shift;
+			if ((shift != 0) && ((at >> 6) + 1 < NWords)) {
+				bits |= rep.words[(at >> 6) + 1] << (64 - shift);
+			}
+			out.words[w] = tinybit::pdepWord(bits, mask.words[w]);
+			at += count;
+		}
+		return out;
+	}
+
+	// compares the bit patterns as one big number, highest word first
+	static constexpr bool less(TinyBitWords<NWords> const &a, TinyBitWords<NWords> const &b) {
+		for (int w = NWords - 1; w >= 0; w--) {
+			if (a.words[w] != b.words[w]) {
+				return a.words[w] < b.words[w];
+			}
+		}
+		return false;
+	}
+
+	static constexpr uint64_t hash(TinyBitWords<NWords> const &rep) {
+		uint64_t h = 0;
+		for (int w = 0; w < NWords; w++) {
+			h = tinybit::mix64(h ^ rep.words[w]) + w;
+		}
+		return h;
+	}
+
+	static constexpr int popcount(TinyBitWords<NWords> const &rep) {
+		return tinybit::popcountWords(rep.words, NWords);
+	}
+
+	static constexpr int lowest(TinyBitWords<NWords> const &rep) {
+		int w = 0;
+		while (rep.words[w] == 0) {
+			w++;
+		}
+		return 64 * w + __builtin_ctzll(rep.words[w]);
+	}
+
+	static constexpr int highest(TinyBitWords<NWords> const &rep) {
+		int w = NWords - 1;
+		while (rep.words[w] == 0) {
+			w--;
+		}
+		return 64 * w + 63 - __builtin_clzll(rep.words[w]);
+	}
+
+	static constexpr int select(TinyBitWords<NWords> const &rep, int k) {
+		int w = 0;
+		for (int count = __builtin_popcountll(rep.words[0]); count <= k; count = __builtin_popcountll(rep.words[++w])) {
+			k -= count;
+		}
+		return 64 * w + tinybit::selectWord(rep.words[w], k);
+	}
+
+	static constexpr int rank(TinyBitWords<NWords> const &rep, int nbits) {
+		int total = 0;
+		int w = 0;
+		for (; (w < NWords) && (nbits >= 64 * (w + 1)); w++) {
+			total += __builtin_popcountll(rep.words[w]);
+		}
+		if ((w < NWords) && (nbits > 64 * w)) {
+			total += __builtin_popcountll(rep.words[w] & ((uint64_t(1) << (nbits - 64 * w)) - 1));
+		}
+		return total;
+	}
+
+	static constexpr int nwords = NWords;
+
+	static constexpr uint64_t word(TinyBitWords<NWords> const &rep, int w) {
+		return rep.words[w];
+	}
+
+	template <size_t NBits>
+	static std::bitset<NBits> toBitset(TinyBitWords<NWords> const &rep) {
+		std::bitset<NBits> bits;
+		for (size_t i = 0; i < NBits; i++) {
+			bits[i] = test(rep, int(i));
+		}
+		return bits;
+	}
+};
+
+
+
+// bounds check policies for insert/remove/contains/popInt, picked by TinyBitSet's second template parameter
+//   TinyBitThrowCheck  - throws std::invalid_argument for integers outside 1..MaxElems (default)
+//   TinyBitAssertCheck - assert() only, so the check disappears with NDEBUG
+//   TinyBitNoCheck     - no check at all, out of range integers are undefined behaviour
+[[noreturn]] __attribute__((noinline, cold)) inline void tinyBitThrowOutOfRange(int i, int maxElems, char const *fname) {
+	throw std::invalid_argument("TinyBitSet can only contain numbers between 1 and " + std::to_string(maxElems) + ", but " + std::to_string(i) + " was passed to " + fname + "().");
+}
+
+struct TinyBitThrowCheck {
+	static constexpr void check(int i, int maxElems, char const *fname) {
+		// one unsigned compare covers both i < 1 and i > maxElems
+		if (static_cast<unsigned>(i) - 1u >= static_cast<unsigned>(maxElems)) {
+			tinyBitThrowOutOfRange(i, maxElems, fname);
+		}
+	}
+};
+
+struct TinyBitAssertCheck {
+	static constexpr void check(int i, int maxElems, char const *fname) {
+		(void)fname;
+		(void)i;
+		(void)maxElems;
+		assert((i >= 1) && (i <= maxElems));
+	}
+};
+
+struct TinyBitNoCheck {
+	static constexpr void check(int, int, char const *) {}
+};
+
+
+
+// forward iterator over the integers in a TinyBitSet, smallest first.
+// jumps straight to the next set bit with count-trailing-zeros and clears it with x & (x - 1),
+// so a full pass costs O(set size + words) and never allocates.
+template <typename RepType>
+class TinyBitIterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = int;
+		using difference_type = std::ptrdiff_t;
+		using pointer = int const *;
+		using reference = int;
+
+		constexpr TinyBitIterator() : rep(nullptr), w(Traits::nwords), cur(0) {}
+
+		constexpr TinyBitIterator(RepType const *rep, int w) : rep(rep), w(w), cur(0) {
+			if (w < Traits::nwords) {
+				this->cur = Traits::word(*rep, w);
+				skipEmptyWords();
+			}
+		}
+
+		constexpr int operator*() const {
+			return 64 * this->w + __builtin_ctzll(this->cur) + 1;
+		}
+
+		constexpr TinyBitIterator& operator++() {
+			this->cur &= this->cur - 1;
+			skipEmptyWords();
+			return *this;
+		}
+
+		constexpr TinyBitIterator operator++(int) {
+			TinyBitIterator old = *this;
+			++*this;
+			return old;
+		}
+
+		constexpr bool operator==(TinyBitIterator const &other) const {
+			return (this->w == other.w) && (this->cur == other.cur);
+		}
+
+		constexpr bool operator!=(TinyBitIterator const &other) const {
+			return !(*this == other);
+		}
+
+	private:
+		using Traits = TinyBitRepTraits<RepType>;
+
+		constexpr void skipEmptyWords() {
+			while ((this->cur == 0) && (++this->w < Traits::nwords)) {
+				this->cur = Traits::word(*this->rep, this->w);
+			}
+		}
+
+		RepType const *rep;
+		int w;          // word being scanned, Traits::nwords once exhausted
+		uint64_t cur;   // bits of that word not visited yet
+};
+
+
+
+template <int MaxElems, typename BoundsCheck = TinyBitThrowCheck>
 class TinyBitSet {
+	static_assert(MaxElems > 0, "TinyBitSet must hold at least the integer 1");
+
 	public:
 		// constructors
-		TinyBitSet();
-		TinyBitSet(TinyBitRepType<MaxElems> const initbitrep);
+		constexpr TinyBitSet();
+		constexpr TinyBitSet(TinyBitRepType<MaxElems> const initbitrep);
 
 		// overloaded object operators
-		bool operator==(TinyBitSet<MaxElems> const &otherset) const;
-		bool operator!=(TinyBitSet<MaxElems> const &otherset) const;
-		TinyBitSet<MaxElems>& operator=(TinyBitSet<MaxElems> const &otherset); 
+		constexpr bool operator==(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const;
+		constexpr bool operator!=(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const;
+		constexpr bool operator<(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const;
 
 
 		// element-wise set operations
-		void insert(int i);
-		void remove(int i);
-		bool contains(int i);
+		constexpr void insert(int i);
+		constexpr void remove(int i);
+		constexpr bool contains(int i) const;
 
 		// set-wise set operations to return new TinyBitSet
-		TinyBitSet<MaxElems> unionb(TinyBitSet<MaxElems> const &otherset);
-		TinyBitSet<MaxElems> intersectionb(TinyBitSet<MaxElems> const &otherset);
-		TinyBitSet<MaxElems> leftDifference(TinyBitSet<MaxElems> const &otherset);
-		TinyBitSet<MaxElems> leftDifference(TinyBitRepType<MaxElems> const otherbitrep);
-		TinyBitSet<MaxElems> rightDifference(TinyBitSet<MaxElems> const &otherset);
-		TinyBitSet<MaxElems> rightDifference(TinyBitRepType<MaxElems> const otherbitrep);
-		
+		constexpr TinyBitSet<MaxElems, BoundsCheck> unionb(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> intersectionb(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> leftDifference(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> leftDifference(TinyBitRepType<MaxElems> const otherbitrep) const;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> rightDifference(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> rightDifference(TinyBitRepType<MaxElems> const otherbitrep) const;
+
+		// the same as operators: | union, & intersection, ^ symmetric difference, - left difference,
+		// ~ complement within 1..MaxElems. nothing to bounds check, so none of them throw
+		constexpr TinyBitSet<MaxElems, BoundsCheck> operator|(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> operator&(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> operator^(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> operator-(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> operator~() const noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck>& operator|=(TinyBitSet<MaxElems, BoundsCheck> const &otherset) noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck>& operator&=(TinyBitSet<MaxElems, BoundsCheck> const &otherset) noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck>& operator^=(TinyBitSet<MaxElems, BoundsCheck> const &otherset) noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck>& operator-=(TinyBitSet<MaxElems, BoundsCheck> const &otherset) noexcept;
+
+		// renumbering: every element i -> i + k (shiftUp) or i - k (shiftDown), dropping what leaves 1..MaxElems
+		// (a negative k shifts the other way), or i -> i + k wrapping around past MaxElems (rotate, any k).
+		// compress keeps the elements in mask, the j-th smallest element of mask becoming j, and expand sends
+		// j back to the j-th smallest element of mask, so s.compress(m).expand(m) == (s & m). one pext / pdep
+		// per word with BMI2, a step per element of mask without
+		constexpr TinyBitSet<MaxElems, BoundsCheck> shiftUp(int k) const noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> shiftDown(int k) const noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> rotate(int k) const noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> compress(TinyBitSet<MaxElems, BoundsCheck> const &mask) const noexcept;
+		constexpr TinyBitSet<MaxElems, BoundsCheck> expand(TinyBitSet<MaxElems, BoundsCheck> const &mask) const noexcept;
+
 
 		// set operations to modify this TinyBitSet
-		void fill();
-		void removeall();
-		void invertSet();
-		int popSmallest();
-		int popLargest();
-		int popInt(int i);
+		constexpr void fill();
+		constexpr void removeall();
+		constexpr void invertSet();
+		constexpr int popSmallest();
+		constexpr int popLargest();
+		constexpr int popInt(int i);
+
+		// order statistics
+		constexpr int select(int k) const;
+		constexpr int rank(int x) const;
+
+		// ordered navigation and ranges, [lo, hi] is inclusive
+		constexpr int nextAfter(int x) const;
+		constexpr int prevBefore(int x) const;
+		constexpr int countInRange(int lo, int hi) const;
+		constexpr void insertRange(int lo, int hi);
+		constexpr void removeRange(int lo, int hi);
+		constexpr bool containsAllInRange(int lo, int hi) const;
+
+		// allocation-free iteration over the elements, smallest first
+		using iterator = TinyBitIterator<TinyBitRepType<MaxElems>>;
+		using const_iterator = iterator;
+		constexpr iterator begin() const;
+		constexpr iterator end() const;
+		template <typename Callback>
+		constexpr void forEach(Callback &&callback) const;
 
 		// get methods
 		std::vector<int> getIntegerElements() const;
 		std::string getBitString() const;
-		TinyBitRepType<MaxElems> getBitInt() const;
-		int getMaxElements() const; 
-		int getSetSize() const;
-		bool isempty() const;
+		constexpr TinyBitRepType<MaxElems> getBitInt() const;
+		constexpr int getMaxElements() const; 
+		constexpr int getSetSize() const;
+		constexpr bool isempty() const;
+		constexpr uint64_t hash() const;
 	
 
 	private:
+		using Traits = TinyBitRepTraits<TinyBitRepType<MaxElems>>;
+
+		// the only data member, MaxElems lives in the type
 		TinyBitRepType<MaxElems> tinybitrep;
-		int maxElems;
 
 };
 
 
 
-template <int MaxElems> 
-TinyBitSet<MaxElems>::TinyBitSet() {
-	if (MaxElems > 64) {
-        throw std::invalid_argument("TinyBitSet can only hold up to the first 64 integers");
-    }	
-	this->maxElems = MaxElems;	
-	this->tinybitrep = 0;
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck>::TinyBitSet() : tinybitrep() {
+	static_assert(sizeof(TinyBitSet<MaxElems, BoundsCheck>) == sizeof(TinyBitRepType<MaxElems>), "TinyBitSet must be exactly as wide as its bit representation");
+	static_assert(std::is_trivially_copyable<TinyBitSet<MaxElems, BoundsCheck>>::value, "TinyBitSet must be trivially copyable");
 }
 
 
-template <int MaxElems> 
-TinyBitSet<MaxElems>::TinyBitSet(TinyBitRepType<MaxElems> const initbitrep) {
-	if (MaxElems > 64) {
-        throw std::invalid_argument("TinyBitSet can only hold up to the first 64 integers");
-    }	
-	this->maxElems = MaxElems;	
-	this->tinybitrep = initbitrep;
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck>::TinyBitSet(TinyBitRepType<MaxElems> const initbitrep) : tinybitrep(initbitrep) {
+	static_assert(sizeof(TinyBitSet<MaxElems, BoundsCheck>) == sizeof(TinyBitRepType<MaxElems>), "TinyBitSet must be exactly as wide as its bit representation");
+	static_assert(std::is_trivially_copyable<TinyBitSet<MaxElems, BoundsCheck>>::value, "TinyBitSet must be trivially copyable");
 }
 
 
 
 
-template <int MaxElems> 
-TinyBitSet<MaxElems>& TinyBitSet<MaxElems>::operator=(TinyBitSet<MaxElems> const &otherset) {
-	if (otherset.getMaxElements() != this->maxElems) {
-		throw std::invalid_argument("left TinyBitSet maxElems != right TinyBitSet maxElems");
-	}
-	this->maxElems =  otherset.getMaxElements();
-	this->tinybitrep = otherset.tinybitrep;
-	return *this;
-}
-
-
-template <int MaxElems> 
-bool TinyBitSet<MaxElems>::operator==(TinyBitSet<MaxElems> const &otherset) const {
+template <int MaxElems, typename BoundsCheck>
+constexpr bool TinyBitSet<MaxElems, BoundsCheck>::operator==(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const {
 	return this->tinybitrep == otherset.tinybitrep;
 }
 
-template <int MaxElems> 
-bool TinyBitSet<MaxElems>::operator!=(TinyBitSet<MaxElems> const &otherset) const {
+template <int MaxElems, typename BoundsCheck>
+constexpr bool TinyBitSet<MaxElems, BoundsCheck>::operator!=(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const {
 	return this->tinybitrep != otherset.tinybitrep;
 }
 
+template <int MaxElems, typename BoundsCheck>
+constexpr bool TinyBitSet<MaxElems, BoundsCheck>::operator<(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const {
+	// orders by bit pattern, so sets can key std::map or be sorted
+	return Traits::less(this->tinybitrep, otherset.tinybitrep);
+}
 
 
 
 
 
-template <int MaxElems>
-TinyBitSet<MaxElems> TinyBitSet<MaxElems>::unionb(TinyBitSet<MaxElems> const &otherset) {
-	TinyBitSet<MaxElems> t;
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::unionb(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const {
+	TinyBitSet<MaxElems, BoundsCheck> t;
 	t.tinybitrep = this->tinybitrep | otherset.tinybitrep;
 	return t;
 }
 
-template <int MaxElems>
-TinyBitSet<MaxElems> TinyBitSet<MaxElems>::intersectionb(TinyBitSet<MaxElems> const &otherset) {
-	TinyBitSet<MaxElems> t;
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::intersectionb(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const {
+	TinyBitSet<MaxElems, BoundsCheck> t;
 	t.tinybitrep = this->tinybitrep & otherset.tinybitrep;
 	return t;
 }
 
-template <int MaxElems>
-TinyBitSet<MaxElems> TinyBitSet<MaxElems>::leftDifference(TinyBitSet<MaxElems> const &otherset) {
-	TinyBitSet<MaxElems> t;
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::leftDifference(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const {
+	TinyBitSet<MaxElems, BoundsCheck> t;
 	t.tinybitrep = this->tinybitrep ^ (this->tinybitrep & otherset.tinybitrep);
 	return t;
 }
 
-template <int MaxElems>
-TinyBitSet<MaxElems> TinyBitSet<MaxElems>::leftDifference(TinyBitRepType<MaxElems> const otherbitrep) {
-	TinyBitSet<MaxElems> t;
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::leftDifference(TinyBitRepType<MaxElems> const otherbitrep) const {
+	TinyBitSet<MaxElems, BoundsCheck> t;
 	t.tinybitrep = this->tinybitrep ^ (this->tinybitrep & otherbitrep);
 	return t;
 }
 
 
-template <int MaxElems>
-TinyBitSet<MaxElems> TinyBitSet<MaxElems>::rightDifference(TinyBitSet<MaxElems> const &otherset) {
-	TinyBitSet<MaxElems> t;
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::rightDifference(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const {
+	TinyBitSet<MaxElems, BoundsCheck> t;
 	t.tinybitrep = otherset.tinybitrep ^ (this->tinybitrep & otherset.tinybitrep);
 	return t;
 }
 
-template <int MaxElems>
-TinyBitSet<MaxElems> TinyBitSet<MaxElems>::rightDifference(TinyBitRepType<MaxElems> const otherbitrep) {
-	TinyBitSet<MaxElems> t;
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::rightDifference(TinyBitRepType<MaxElems> const otherbitrep) const {
+	TinyBitSet<MaxElems, BoundsCheck> t;
 	t.tinybitrep = otherbitrep ^ (this->tinybitrep & otherbitrep);
 	return t;
 }
 
 
-template <int MaxElems>
-void TinyBitSet<MaxElems>::insert(int i) {
-	if ((i > this->maxElems) || (i < 1)) {
-		throw std::invalid_argument("TinyBitSet can only contain numbers between 1 and " + std::to_string(this->maxElems) + ", but " + std::to_string(i) + " was passed to insert().");
-	}
-	this->tinybitrep |= (1 << (i-1));
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::operator|(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const noexcept {
+	TinyBitSet<MaxElems, BoundsCheck> t;
+	t.tinybitrep = this->tinybitrep | otherset.tinybitrep;
+	return t;
+}
 
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::operator&(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const noexcept {
+	TinyBitSet<MaxElems, BoundsCheck> t;
+	t.tinybitrep = this->tinybitrep & otherset.tinybitrep;
+	return t;
 }
 
-template <int MaxElems>
-void TinyBitSet<MaxElems>::remove(int i) {
-	if ((i > this->maxElems) || (i < 1)) {
-		throw std::invalid_argument("TinyBitSet can only contain numbers between 1 and " + std::to_string(this->maxElems) + ", but " + std::to_string(i) + " was passed to remove().");
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::operator^(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const noexcept {
+	TinyBitSet<MaxElems, BoundsCheck> t;
+	t.tinybitrep = this->tinybitrep ^ otherset.tinybitrep;
+	return t;
+}
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::operator-(TinyBitSet<MaxElems, BoundsCheck> const &otherset) const noexcept {
+	TinyBitSet<MaxElems, BoundsCheck> t;
+	t.tinybitrep = this->tinybitrep & Traits::complement(otherset.tinybitrep);
+	return t;
+}
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::operator~() const noexcept {
+	// bits above MaxElems stay 0, as in invertSet()
+	TinyBitSet<MaxElems, BoundsCheck> t;
+	t.tinybitrep = Traits::complement(this->tinybitrep) & Traits::lowMask(MaxElems);
+	return t;
+}
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck>& TinyBitSet<MaxElems, BoundsCheck>::operator|=(TinyBitSet<MaxElems, BoundsCheck> const &otherset) noexcept {
+	this->tinybitrep = this->tinybitrep | otherset.tinybitrep;
+	return *this;
+}
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck>& TinyBitSet<MaxElems, BoundsCheck>::operator&=(TinyBitSet<MaxElems, BoundsCheck> const &otherset) noexcept {
+	this->tinybitrep = this->tinybitrep & otherset.tinybitrep;
+	return *this;
+}
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck>& TinyBitSet<MaxElems, BoundsCheck>::operator^=(TinyBitSet<MaxElems, BoundsCheck> const &otherset) noexcept {
+	this->tinybitrep = this->tinybitrep ^ otherset.tinybitrep;
+	return *this;
+}
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck>& TinyBitSet<MaxElems, BoundsCheck>::operator-=(TinyBitSet<MaxElems, BoundsCheck> const &otherset) noexcept {
+	this->tinybitrep = this->tinybitrep & Traits::complement(otherset.tinybitrep);
+	return *this;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::shiftUp(int k) const noexcept {
+	// clamped first, so that -k can't overflow for k = INT_MIN
+	if (k <= -MaxElems) {
+		return TinyBitSet<MaxElems, BoundsCheck>();
+	}
+	if (k < 0) {
+		return this->shiftDown(-k);
 	}
-	this->tinybitrep = this->tinybitrep & ~(1 << (i-1));
+	TinyBitSet<MaxElems, BoundsCheck> t;
+	t.tinybitrep = Traits::shiftUp(this->tinybitrep, k) & Traits::lowMask(MaxElems);
+	return t;
 }
 
-template <int MaxElems>
-bool TinyBitSet<MaxElems>::contains(int i) {
-	if ((i > this->maxElems) || (i < 1)) {
-		throw std::invalid_argument("TinyBitSet can only contain numbers between 1 and " + std::to_string(this->maxElems) + ", but " + std::to_string(i) + " was passed to contains().");
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::shiftDown(int k) const noexcept {
+	if (k <= -MaxElems) {
+		return TinyBitSet<MaxElems, BoundsCheck>();
+	}
+	if (k < 0) {
+		return this->shiftUp(-k);
 	}
-	return (this->tinybitrep & (1 << (i-1))) != 0;
+	TinyBitSet<MaxElems, BoundsCheck> t;
+	t.tinybitrep = Traits::shiftDown(this->tinybitrep, k);
+	return t;
+}
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::rotate(int k) const noexcept {
+	k %= MaxElems;
+	k = (k < 0) ? k + MaxElems : k;
+	// the top k elements wrap around to the bottom
+	TinyBitSet<MaxElems, BoundsCheck> t = this->shiftUp(k);
+	t.tinybitrep = t.tinybitrep | Traits::shiftDown(this->tinybitrep, MaxElems - k);
+	return t;
+}
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::compress(TinyBitSet<MaxElems, BoundsCheck> const &mask) const noexcept {
+	TinyBitSet<MaxElems, BoundsCheck> t;
+	t.tinybitrep = Traits::extract(this->tinybitrep, mask.tinybitrep);
+	return t;
 }
 
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> TinyBitSet<MaxElems, BoundsCheck>::expand(TinyBitSet<MaxElems, BoundsCheck> const &mask) const noexcept {
+	TinyBitSet<MaxElems, BoundsCheck> t;
+	t.tinybitrep = Traits::deposit(this->tinybitrep, mask.tinybitrep);
+	return t;
+}
 
 
-template <int MaxElems>
-void TinyBitSet<MaxElems>::fill() {
-	this->tinybitrep = (1 << this->maxElems) - 1;
+template <int MaxElems, typename BoundsCheck>
+constexpr void TinyBitSet<MaxElems, BoundsCheck>::insert(int i) {
+	BoundsCheck::check(i, MaxElems, "insert");
+	Traits::set(this->tinybitrep, i-1);
+
 }
 
-template <int MaxElems>
-void TinyBitSet<MaxElems>::removeall() {
-	this->tinybitrep = 0;
+template <int MaxElems, typename BoundsCheck>
+constexpr void TinyBitSet<MaxElems, BoundsCheck>::remove(int i) {
+	BoundsCheck::check(i, MaxElems, "remove");
+	Traits::reset(this->tinybitrep, i-1);
 }
 
+template <int MaxElems, typename BoundsCheck>
+constexpr bool TinyBitSet<MaxElems, BoundsCheck>::contains(int i) const {
+	BoundsCheck::check(i, MaxElems, "contains");
+	return Traits::test(this->tinybitrep, i-1);
+}
 
 
-template <int MaxElems>
-void TinyBitSet<MaxElems>::invertSet() {
-	// mask all the bits > maxElems to 0
-	this->tinybitrep = ~this->tinybitrep;
-	this->tinybitrep &= (1 << this->maxElems) - 1;
+
+template <int MaxElems, typename BoundsCheck>
+constexpr void TinyBitSet<MaxElems, BoundsCheck>::fill() {
+	this->tinybitrep = Traits::lowMask(MaxElems);
 }
 
+template <int MaxElems, typename BoundsCheck>
+constexpr void TinyBitSet<MaxElems, BoundsCheck>::removeall() {
+	this->tinybitrep = TinyBitRepType<MaxElems>();
+}
 
 
 
+template <int MaxElems, typename BoundsCheck>
+constexpr void TinyBitSet<MaxElems, BoundsCheck>::invertSet() {
+	// mask all the bits > MaxElems to 0
+	this->tinybitrep = Traits::complement(this->tinybitrep) & Traits::lowMask(MaxElems);
+}
 
 
-template <int MaxElems>
-int TinyBitSet<MaxElems>::popSmallest() {
+
+
+
+
+template <int MaxElems, typename BoundsCheck>
+constexpr int TinyBitSet<MaxElems, BoundsCheck>::popSmallest() {
 	/*
 	   returns 0 if empty, otherwise first integer element on right in bitstring
-	   aka shares the one bit with 1 << i, O(constant)
+	   found with one count-trailing-zeros per word
 	*/
-	int start = 0;
-	int finish = this->maxElems;
-	for (int i = start; i != finish; i++) {
-		if (this->tinybitrep & (1 << i)) {
-			remove(i+1);
-			return i+1;
-		}
+	if (Traits::isZero(this->tinybitrep)) {
+		return 0;
 	}
-	return 0;  
+	int pos = Traits::lowest(this->tinybitrep);
+	Traits::reset(this->tinybitrep, pos);
+	return pos+1;  
 }
 
 
-template <int MaxElems>
-int TinyBitSet<MaxElems>::popLargest() {
+template <int MaxElems, typename BoundsCheck>
+constexpr int TinyBitSet<MaxElems, BoundsCheck>::popLargest() {
 	/*
 	   returns 0 if empty, otherwise first integer element on left in bitstring
-	   aka shares the one bit with 1 << i, O(constant)
+	   found with one count-leading-zeros per word
 	*/
-	
-    int start = this->maxElems - 1;
-	int finish = -1;
-	for (int i = start; i != finish; i--) {
-		if (this->tinybitrep & (1 << i)) {
-			remove(i+1);
-			return i+1;
-		}
+	if (Traits::isZero(this->tinybitrep)) {
+		return 0;
 	}
-	return 0;  
+	int pos = Traits::highest(this->tinybitrep);
+	Traits::reset(this->tinybitrep, pos);
+	return pos+1;  
 }
 
 
+template <int MaxElems, typename BoundsCheck>
+constexpr int TinyBitSet<MaxElems, BoundsCheck>::select(int k) const {
+	/*
+	   returns the k-th smallest element (k = 1 is the smallest), or 0 if the set has fewer than k elements
+	*/
+	if ((k < 1) || (k > getSetSize())) {
+		return 0;
+	}
+	return Traits::select(this->tinybitrep, k-1) + 1;
+}
 
-template <int MaxElems>
-int TinyBitSet<MaxElems>::popInt(int i) {
+
+template <int MaxElems, typename BoundsCheck>
+constexpr int TinyBitSet<MaxElems, BoundsCheck>::rank(int x) const {
+	/*
+	   returns how many elements are <= x, any x is allowed
+	*/
+	if (x < 1) {
+		return 0;
+	}
+	return Traits::rank(this->tinybitrep, (x < MaxElems) ? x : MaxElems);
+}
+
+
+
+template <int MaxElems, typename BoundsCheck>
+constexpr int TinyBitSet<MaxElems, BoundsCheck>::popInt(int i) {
 	/*
 	   returns 0 if empty, otherwise returns the int (i) passed to it, removes that from set
+	   one bounds check, then test and clear without branching on membership
 	*/
+	BoundsCheck::check(i, MaxElems, "popInt");
+	bool had = Traits::test(this->tinybitrep, i-1);
+	Traits::reset(this->tinybitrep, i-1);
+	return had ? i : 0;  
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+constexpr int TinyBitSet<MaxElems, BoundsCheck>::nextAfter(int x) const {
+	/*
+	   returns the smallest element > x, or 0 if there is none, any x is allowed
+	*/
+	if (x >= MaxElems) {
+		return 0;
+	}
+	TinyBitRepType<MaxElems> above = this->tinybitrep & Traits::rangeMask((x > 0) ? x : 0, MaxElems);
+	return Traits::isZero(above) ? 0 : Traits::lowest(above) + 1;
+}
 
-	if (this->tinybitrep == 0) {
+
+template <int MaxElems, typename BoundsCheck>
+constexpr int TinyBitSet<MaxElems, BoundsCheck>::prevBefore(int x) const {
+	/*
+	   returns the largest element < x, or 0 if there is none, any x is allowed
+	*/
+	if (x <= 1) {
 		return 0;
 	}
+	TinyBitRepType<MaxElems> below = this->tinybitrep & Traits::lowMask((x <= MaxElems) ? x - 1 : MaxElems);
+	return Traits::isZero(below) ? 0 : Traits::highest(below) + 1;
+}
+
 
-	if (!contains(i)) {
+template <int MaxElems, typename BoundsCheck>
+constexpr int TinyBitSet<MaxElems, BoundsCheck>::countInRange(int lo, int hi) const {
+	/*
+	   returns how many elements lie in [lo, hi], the range is clipped to 1..MaxElems
+	*/
+	lo = (lo > 1) ? lo : 1;
+	hi = (hi < MaxElems) ? hi : MaxElems;
+	if (lo > hi) {
 		return 0;
 	}
+	return Traits::popcount(this->tinybitrep & Traits::rangeMask(lo-1, hi));
+}
 
-	remove(i);
-	return i;  
+
+template <int MaxElems, typename BoundsCheck>
+constexpr void TinyBitSet<MaxElems, BoundsCheck>::insertRange(int lo, int hi) {
+	/*
+	   inserts every integer in [lo, hi], does nothing if lo > hi
+	*/
+	if (lo > hi) {
+		return;
+	}
+	BoundsCheck::check(lo, MaxElems, "insertRange");
+	BoundsCheck::check(hi, MaxElems, "insertRange");
+	this->tinybitrep = this->tinybitrep | Traits::rangeMask(lo-1, hi);
 }
 
 
-template <int MaxElems>
-std::vector<int> TinyBitSet<MaxElems>::getIntegerElements() const {
-	std::vector<int> elems;
-	for (int i = 0; i < this->maxElems; i++) {
-		if (this->tinybitrep & (1 << i)) {
-			elems.push_back(i+1);
+template <int MaxElems, typename BoundsCheck>
+constexpr void TinyBitSet<MaxElems, BoundsCheck>::removeRange(int lo, int hi) {
+	/*
+	   removes every integer in [lo, hi], does nothing if lo > hi
+	*/
+	if (lo > hi) {
+		return;
+	}
+	BoundsCheck::check(lo, MaxElems, "removeRange");
+	BoundsCheck::check(hi, MaxElems, "removeRange");
+	this->tinybitrep = this->tinybitrep & Traits::complement(Traits::rangeMask(lo-1, hi));
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+constexpr bool TinyBitSet<MaxElems, BoundsCheck>::containsAllInRange(int lo, int hi) const {
+	/*
+	   true if every integer in [lo, hi] is in the set, an empty range (lo > hi) is always contained
+	*/
+	if (lo > hi) {
+		return true;
+	}
+	BoundsCheck::check(lo, MaxElems, "containsAllInRange");
+	BoundsCheck::check(hi, MaxElems, "containsAllInRange");
+	TinyBitRepType<MaxElems> mask = Traits::rangeMask(lo-1, hi);
+	return (this->tinybitrep & mask) == mask;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+constexpr typename TinyBitSet<MaxElems, BoundsCheck>::iterator TinyBitSet<MaxElems, BoundsCheck>::begin() const {
+	return iterator(&this->tinybitrep, 0);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+constexpr typename TinyBitSet<MaxElems, BoundsCheck>::iterator TinyBitSet<MaxElems, BoundsCheck>::end() const {
+	return iterator(&this->tinybitrep, Traits::nwords);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+template <typename Callback>
+constexpr void TinyBitSet<MaxElems, BoundsCheck>::forEach(Callback &&callback) const {
+	/*
+	   calls callback(int) on each element, smallest first
+	*/
+	for (int w = 0; w < Traits::nwords; w++) {
+		uint64_t bits = Traits::word(this->tinybitrep, w);
+		while (bits) {
+			callback(64 * w + __builtin_ctzll(bits) + 1);
+			bits &= bits - 1;
 		}
 	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<int> TinyBitSet<MaxElems, BoundsCheck>::getIntegerElements() const {
+	std::vector<int> elems;
+	elems.reserve(getSetSize());
+	forEach([&elems](int i) { elems.push_back(i); });
 	return elems;
 }
 
 
-template <int MaxElems>
-std::string TinyBitSet<MaxElems>::getBitString() const {
-	return std::bitset<MaxElems>(this->tinybitrep).to_string();  
+template <int MaxElems, typename BoundsCheck>
+std::string TinyBitSet<MaxElems, BoundsCheck>::getBitString() const {
+	return Traits::template toBitset<MaxElems>(this->tinybitrep).to_string();  
 }
 
 
-template <int MaxElems>
-TinyBitRepType<MaxElems> TinyBitSet<MaxElems>::getBitInt() const {
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitRepType<MaxElems> TinyBitSet<MaxElems, BoundsCheck>::getBitInt() const {
 	return this->tinybitrep;  
 }
 
@@ -311,23 +972,153 @@ TinyBitRepType<MaxElems> TinyBitSet<MaxElems>::getBitInt() const {
 
 
 
-template <int MaxElems>
-int TinyBitSet<MaxElems>::getMaxElements() const {
-	return this->maxElems;  
+template <int MaxElems, typename BoundsCheck>
+constexpr int TinyBitSet<MaxElems, BoundsCheck>::getMaxElements() const {
+	return MaxElems;  
 }
 
 
-template <int MaxElems>
-int TinyBitSet<MaxElems>::getSetSize() const {
-	return __builtin_popcount(this->tinybitrep);  
+template <int MaxElems, typename BoundsCheck>
+constexpr int TinyBitSet<MaxElems, BoundsCheck>::getSetSize() const {
+	return Traits::popcount(this->tinybitrep);  
 }
 
 
 
-template <int MaxElems>
-bool TinyBitSet<MaxElems>::isempty() const {
-	return this->tinybitrep == 0;  
+template <int MaxElems, typename BoundsCheck>
+constexpr bool TinyBitSet<MaxElems, BoundsCheck>::isempty() const {
+	return Traits::isZero(this->tinybitrep);  
 }
 
 
+template <int MaxElems, typename BoundsCheck>
+constexpr uint64_t TinyBitSet<MaxElems, BoundsCheck>::hash() const {
+	return Traits::hash(this->tinybitrep);  
+}
+
+
+
+
+/*
+n-ary union / intersection / symmetric difference, of a parameter pack or of n sets in memory.
+
+intersectAll stops as soon as the intersection is empty and unionAll as soon as the union holds all of
+1..MaxElems, since no further operand can change either. the span forms check once per naryBlock sets and
+combine them as a tree, 4 sets pairwise before the running result sees them, so most of the operations
+don't wait on each other (for wide sets each one is already a SIMD loop over the words). of no sets at all,
+the intersection is every element and the union and symmetric difference are empty.
+*/
+
+namespace tinybit {
+
+	// sets combined between early exit checks
+	constexpr size_t naryBlock = 8;
+
+	// acc = acc op s, in place so wide sets aren't passed by value
+	template <BitOp Op, typename Set>
+	constexpr void combineInto(Set &acc, Set const &s) {
+		if constexpr (Op == BitOp::Or) {
+			acc |= s;
+		} else if constexpr (Op == BitOp::And) {
+			acc &= s;
+		} else {
+			acc ^= s;
+		}
+	}
+
+	// sets[0 .. n) combined with Op into acc, n <= naryBlock. 4 sets at a time are combined pairwise
+	// before acc sees them, so the chain through acc is a quarter as long
+	template <BitOp Op, typename Set>
+	constexpr void reduceBlock(Set &acc, Set const *sets, size_t n) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			Set left = sets[i];
+			Set right = sets[i + 2];
+			combineInto<Op>(left, sets[i + 1]);
+			combineInto<Op>(right, sets[i + 3]);
+			combineInto<Op>(left, right);
+			combineInto<Op>(acc, left);
+		}
+		for (; i < n; i++) {
+			combineInto<Op>(acc, sets[i]);
+		}
+	}
+
+	// Op over all n sets, stopping once the result is stop if StopEarly
+	template <BitOp Op, bool StopEarly, typename Set>
+	constexpr Set reduceAll(Set const *sets, size_t n, Set const &identity, Set const &stop) {
+		Set acc = identity;
+		for (size_t i = 0; i < n; i += naryBlock) {
+			reduceBlock<Op>(acc, sets + i, (n - i < naryBlock) ? n - i : naryBlock);
+			if (StopEarly && (acc == stop)) {
+				break;
+			}
+		}
+		return acc;
+	}
+
+	template <typename Set, typename... Rest>
+	constexpr bool allSameSet = (std::is_same<Set, Rest>::value && ...);
+
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> unionAll(TinyBitSet<MaxElems, BoundsCheck> const *sets, size_t n) {
+	TinyBitSet<MaxElems, BoundsCheck> full;
+	full.fill();
+	return tinybit::reduceAll<tinybit::BitOp::Or, true>(sets, n, TinyBitSet<MaxElems, BoundsCheck>(), full);
+}
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> intersectAll(TinyBitSet<MaxElems, BoundsCheck> const *sets, size_t n) {
+	TinyBitSet<MaxElems, BoundsCheck> full;
+	full.fill();
+	return tinybit::reduceAll<tinybit::BitOp::And, true>(sets, n, full, TinyBitSet<MaxElems, BoundsCheck>());
+}
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSet<MaxElems, BoundsCheck> symmetricDifferenceAll(TinyBitSet<MaxElems, BoundsCheck> const *sets, size_t n) {
+	TinyBitSet<MaxElems, BoundsCheck> none;
+	return tinybit::reduceAll<tinybit::BitOp::Xor, false>(sets, n, none, none);
+}
+
+
+// unionAll(a, b, c, ...), every argument the same TinyBitSet type, left to right with the same early exits
+template <int MaxElems, typename BoundsCheck, typename... Rest>
+constexpr TinyBitSet<MaxElems, BoundsCheck> unionAll(TinyBitSet<MaxElems, BoundsCheck> const &first, Rest const &... rest) noexcept {
+	static_assert(tinybit::allSameSet<TinyBitSet<MaxElems, BoundsCheck>, Rest...>, "unionAll needs sets of one TinyBitSet type");
+	TinyBitSet<MaxElems, BoundsCheck> acc = first;
+	TinyBitSet<MaxElems, BoundsCheck> full;
+	full.fill();
+	(void)(((acc != full) && ((acc |= rest), true)) && ...);
+	return acc;
+}
+
+template <int MaxElems, typename BoundsCheck, typename... Rest>
+constexpr TinyBitSet<MaxElems, BoundsCheck> intersectAll(TinyBitSet<MaxElems, BoundsCheck> const &first, Rest const &... rest) noexcept {
+	static_assert(tinybit::allSameSet<TinyBitSet<MaxElems, BoundsCheck>, Rest...>, "intersectAll needs sets of one TinyBitSet type");
+	TinyBitSet<MaxElems, BoundsCheck> acc = first;
+	(void)((!acc.isempty() && ((acc &= rest), true)) && ...);
+	return acc;
+}
+
+template <int MaxElems, typename BoundsCheck, typename... Rest>
+constexpr TinyBitSet<MaxElems, BoundsCheck> symmetricDifferenceAll(TinyBitSet<MaxElems, BoundsCheck> const &first, Rest const &... rest) noexcept {
+	static_assert(tinybit::allSameSet<TinyBitSet<MaxElems, BoundsCheck>, Rest...>, "symmetricDifferenceAll needs sets of one TinyBitSet type");
+	TinyBitSet<MaxElems, BoundsCheck> acc = first;
+	(void)((acc ^= rest), ...);
+	return acc;
+}
+
+namespace std {
+	template <int MaxElems, typename BoundsCheck>
+	struct hash<TinyBitSet<MaxElems, BoundsCheck>> {
+		size_t operator()(TinyBitSet<MaxElems, BoundsCheck> const &set) const noexcept {
+			return static_cast<size_t>(set.hash());
+		}
+	};
+}
+
 
+#endif
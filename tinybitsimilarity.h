@@ -0,0 +1,322 @@
+/*
+top-k nearest neighbour search over collections of TinyBitSets, e.g. TinyBitSet<64> feature fingerprints.
+
+	topJaccard(sets, n, query, k)    the k sets with the highest |set & query| / |set | query|
+	topHamming(sets, n, query, k)    the k sets with the lowest |set ^ query|
+
+both scan the sets in blocks of 256: the dispatch kernel counts |set & query| and |set | query| for a whole
+block (8 sets per instruction with VPOPCNTDQ, 4 with the AVX2 nibble lookup), then each count is offered to a
+bounded heap of the k best so far, which rejects most of them with one comparison against its worst entry.
+
+TinyBitSimilarityIndex keeps a copy of the sets grouped by size, for popcount pruning: |set ^ query| is at least
+the difference of their sizes, and the Jaccard similarity at most the smaller size over the larger. a query
+visits the size groups in order of that bound, closest to the query's own size first, and stops at the first
+group that can't beat the heap's worst entry.
+
+with nthreads > 1 and enough sets, each thread searches its own share with its own heap and the heaps are merged.
+ties are broken towards the lower index, so the results don't depend on the thread count.
+the index of a TinyBitMatch is the set's position in the array that was searched (or that built the index).
+
+*/
+
+#ifndef TINYBITSIMILARITY_H
+#define TINYBITSIMILARITY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "tinybitset.h"
+
+
+struct TinyBitMatch {
+	size_t index;
+	int common;     // |set & query|
+	int combined;   // |set | query|
+
+	// two empty sets count as identical
+	double jaccard() const {
+		return (this->combined == 0) ? 1.0 : double(this->common) / double(this->combined);
+	}
+
+	int hamming() const {
+		return this->combined - this->common;
+	}
+};
+
+
+
+namespace tinybit {
+
+	// sets per call to the overlap kernel, small enough for the counts to stay in L1
+	constexpr size_t similarityBlock = 256;
+
+	// a scan scores a set in about 3ns (scripts/comparesimilarity.cpp): 16384 sets are ~50us, and each
+	// thread's k best are merged after
+	constexpr size_t similarityParallelMin = size_t(1) << 14;
+
+
+	// a closer to the query than b, ties to the lower index
+	struct JaccardCloser {
+		bool operator()(TinyBitMatch const &a, TinyBitMatch const &b) const {
+			int64_t ac = (a.combined == 0) ? 1 : a.common;
+			int64_t au = (a.combined == 0) ? 1 : a.combined;
+			int64_t bc = (b.combined == 0) ? 1 : b.common;
+			int64_t bu = (b.combined == 0) ? 1 : b.combined;
+			return (ac * bu != bc * au) ? (ac * bu > bc * au) : (a.index < b.index);
+		}
+
+		// could a set of setSize elements beat worst for a query of querySize
+		static bool mayBeat(int setSize, int querySize, TinyBitMatch const &worst) {
+			int lo = std::min(setSize, querySize);
+			int hi = std::max(setSize, querySize);
+			TinyBitMatch best = {0, lo, hi};
+			return !JaccardCloser()(worst, best);
+		}
+	};
+
+
+	struct HammingCloser {
+		bool operator()(TinyBitMatch const &a, TinyBitMatch const &b) const {
+			return (a.hamming() != b.hamming()) ? (a.hamming() < b.hamming()) : (a.index < b.index);
+		}
+
+		static bool mayBeat(int setSize, int querySize, TinyBitMatch const &worst) {
+			int gap = (setSize > querySize) ? setSize - querySize : querySize - setSize;
+			return gap <= worst.hamming();
+		}
+	};
+
+
+	// the k closest matches offered so far, as a heap with the worst of them on top
+	template <typename Closer>
+	class TopMatches {
+		public:
+			explicit TopMatches(size_t k) : k(k) {
+				this->heap.reserve(k);
+			}
+
+			bool full() const {
+				return this->heap.size() >= this->k;
+			}
+
+			TinyBitMatch const &worst() const {
+				return this->heap.front();
+			}
+
+			void offer(TinyBitMatch const &m) {
+				if (this->heap.size() < this->k) {
+					this->heap.push_back(m);
+					std::push_heap(this->heap.begin(), this->heap.end(), Closer());
+				} else if ((this->k > 0) && Closer()(m, this->heap.front())) {
+					std::pop_heap(this->heap.begin(), this->heap.end(), Closer());
+					this->heap.back() = m;
+					std::push_heap(this->heap.begin(), this->heap.end(), Closer());
+				}
+			}
+
+			void merge(TopMatches const &other) {
+				for (TinyBitMatch const &m : other.heap) {
+					offer(m);
+				}
+			}
+
+			// closest first
+			std::vector<TinyBitMatch> sorted() const {
+				std::vector<TinyBitMatch> out = this->heap;
+				std::sort_heap(out.begin(), out.end(), Closer());
+				return out;
+			}
+
+		private:
+			size_t k;
+			std::vector<TinyBitMatch> heap;
+	};
+
+
+	// offer sets begin .. end-1 to top, match index ids[i] (or i when ids is null)
+	template <typename RepType, typename Closer>
+	void scanMatches(TopMatches<Closer> &top, RepType const *sets, size_t begin, size_t end, RepType const &query, size_t const *ids) {
+		int common[similarityBlock];
+		int combined[similarityBlock];
+		for (size_t b = begin; b < end; b += similarityBlock) {
+			size_t len = std::min(similarityBlock, end - b);
+			kernels().overlapCounts(common, combined, sets + b, len, sizeof(RepType), &query);
+			for (size_t j = 0; j < len; j++) {
+				top.offer(TinyBitMatch{ids ? ids[b + j] : b + j, common[j], combined[j]});
+			}
+		}
+	}
+
+
+	template <typename Closer, typename RepType>
+	std::vector<TinyBitMatch> topMatches(RepType const *sets, size_t n, RepType const &query, size_t k, int nthreads) {
+		TopMatches<Closer> top(k);
+		if ((nthreads <= 1) || (n < similarityParallelMin)) {
+			scanMatches(top, sets, 0, n, query, static_cast<size_t const *>(nullptr));
+			return top.sorted();
+		}
+		std::mutex merge;
+		parallelRanges(nthreads, n, [&](size_t begin, size_t end) {
+			TopMatches<Closer> local(k);
+			scanMatches(local, sets, begin, end, query, static_cast<size_t const *>(nullptr));
+			std::lock_guard<std::mutex> lock(merge);
+			top.merge(local);
+		});
+		return top.sorted();
+	}
+
+}
+
+
+
+// the k sets closest to query by Jaccard similarity (highest first), fewer if n < k
+template <int MaxElems, typename BoundsCheck>
+std::vector<TinyBitMatch> topJaccard(TinyBitSet<MaxElems, BoundsCheck> const *sets, size_t n, TinyBitSet<MaxElems, BoundsCheck> const &query,
+									 size_t k, int nthreads = 1) {
+	using RepType = TinyBitRepType<MaxElems>;
+	static_assert(sizeof(TinyBitSet<MaxElems, BoundsCheck>) == sizeof(RepType), "topJaccard needs TinyBitSet to be exactly its words");
+	return tinybit::topMatches<tinybit::JaccardCloser>(reinterpret_cast<RepType const *>(sets), n, query.getBitInt(), k, nthreads);
+}
+
+
+// the k sets closest to query by Hamming distance (lowest first), fewer if n < k
+template <int MaxElems, typename BoundsCheck>
+std::vector<TinyBitMatch> topHamming(TinyBitSet<MaxElems, BoundsCheck> const *sets, size_t n, TinyBitSet<MaxElems, BoundsCheck> const &query,
+									 size_t k, int nthreads = 1) {
+	using RepType = TinyBitRepType<MaxElems>;
+	static_assert(sizeof(TinyBitSet<MaxElems, BoundsCheck>) == sizeof(RepType), "topHamming needs TinyBitSet to be exactly its words");
+	return tinybit::topMatches<tinybit::HammingCloser>(reinterpret_cast<RepType const *>(sets), n, query.getBitInt(), k, nthreads);
+}
+
+
+
+template <int MaxElems, typename BoundsCheck = TinyBitThrowCheck>
+class TinyBitSimilarityIndex {
+	public:
+		using value_type = TinyBitSet<MaxElems, BoundsCheck>;
+
+		// copies the n sets, match indexes refer to positions in sets
+		TinyBitSimilarityIndex(value_type const *sets, size_t n);
+
+		std::vector<TinyBitMatch> topJaccard(value_type const &query, size_t k, int nthreads = 1) const;
+		std::vector<TinyBitMatch> topHamming(value_type const &query, size_t k, int nthreads = 1) const;
+
+		size_t size() const {
+			return this->reps.size();
+		}
+
+	private:
+		using RepType = TinyBitRepType<MaxElems>;
+
+		template <typename Closer>
+		std::vector<TinyBitMatch> search(value_type const &query, size_t k, int nthreads) const;
+		template <typename Closer>
+		void searchShare(tinybit::TopMatches<Closer> &top, RepType const &query, int querySize, size_t share, size_t shares) const;
+
+		std::vector<RepType> reps;       // grouped by size, smallest first
+		std::vector<size_t> ids;         // position of reps[i] in the original sets
+		std::vector<size_t> groupStart;  // sets of size s are reps[groupStart[s] .. groupStart[s+1]-1]
+};
+
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitSimilarityIndex<MaxElems, BoundsCheck>::TinyBitSimilarityIndex(value_type const *sets, size_t n) : reps(n), ids(n), groupStart(MaxElems + 2, 0) {
+	/*
+	   counting sort by size, stable so each group keeps the original order
+	*/
+	for (size_t i = 0; i < n; i++) {
+		this->groupStart[sets[i].getSetSize() + 1]++;
+	}
+	for (int s = 0; s <= MaxElems; s++) {
+		this->groupStart[s + 1] += this->groupStart[s];
+	}
+	std::vector<size_t> next(this->groupStart.begin(), this->groupStart.end() - 1);
+	for (size_t i = 0; i < n; i++) {
+		size_t at = next[sets[i].getSetSize()]++;
+		this->reps[at] = sets[i].getBitInt();
+		this->ids[at] = i;
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+template <typename Closer>
+void TinyBitSimilarityIndex<MaxElems, BoundsCheck>::searchShare(tinybit::TopMatches<Closer> &top, RepType const &query, int querySize,
+																 size_t share, size_t shares) const {
+	/*
+	   walk outwards from the query's size, always taking the side whose bound is better,
+	   each group's bound only gets worse further out so the first one that can't beat the heap ends the search
+	*/
+	int below = querySize - 1;
+	int above = querySize;
+	while ((below >= 0) || (above <= MaxElems)) {
+		int s;
+		if (below < 0) {
+			s = above++;
+		} else if (above > MaxElems) {
+			s = below--;
+		} else {
+			// the closest a set of each size could be
+			TinyBitMatch belowBest = {0, below, querySize};
+			TinyBitMatch aboveBest = {0, querySize, above};
+			if (Closer()(belowBest, aboveBest)) {
+				s = below--;
+			} else {
+				s = above++;
+			}
+		}
+		if (top.full() && !Closer::mayBeat(s, querySize, top.worst())) {
+			return;
+		}
+		size_t begin = this->groupStart[s];
+		size_t len = this->groupStart[s + 1] - begin;
+		tinybit::scanMatches(top, this->reps.data(), begin + len * share / shares, begin + len * (share + 1) / shares, query, this->ids.data());
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+template <typename Closer>
+std::vector<TinyBitMatch> TinyBitSimilarityIndex<MaxElems, BoundsCheck>::search(value_type const &query, size_t k, int nthreads) const {
+	tinybit::TopMatches<Closer> top(k);
+	RepType q = query.getBitInt();
+	int querySize = query.getSetSize();
+	if (k == 0) {
+		return top.sorted();
+	}
+	if ((nthreads <= 1) || (size() < tinybit::similarityParallelMin)) {
+		searchShare(top, q, querySize, 0, 1);
+		return top.sorted();
+	}
+	// thread t takes the t-th slice of every size group, so each one still walks the groups best first
+	std::mutex merge;
+	size_t shares = size_t(nthreads);
+	tinybit::parallelRanges(nthreads, shares, [&](size_t begin, size_t end) {
+		for (size_t share = begin; share < end; share++) {
+			tinybit::TopMatches<Closer> local(k);
+			searchShare(local, q, querySize, share, shares);
+			std::lock_guard<std::mutex> lock(merge);
+			top.merge(local);
+		}
+	});
+	return top.sorted();
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<TinyBitMatch> TinyBitSimilarityIndex<MaxElems, BoundsCheck>::topJaccard(value_type const &query, size_t k, int nthreads) const {
+	return search<tinybit::JaccardCloser>(query, k, nthreads);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<TinyBitMatch> TinyBitSimilarityIndex<MaxElems, BoundsCheck>::topHamming(value_type const &query, size_t k, int nthreads) const {
+	return search<tinybit::HammingCloser>(query, k, nthreads);
+}
+
+
+#endif
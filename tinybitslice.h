@@ -0,0 +1,413 @@
+/*
+bit-sliced copy of an array of TinyBitSets, for evaluating predicates like "contains 3 and not 17" over
+millions of sets a word at a time: column k holds, for every set, whether it contains k, 64 sets per word.
+
+	TinyBitSlices<64> slices(sets.data(), sets.size());
+	TinyBitPredicate p = TinyBitPredicate::element(3) & ~TinyBitPredicate::element(17);
+	std::vector<uint64_t> mask = slices.select(p);      // bit r % 64 of mask[r / 64] set when sets[r] satisfies p
+
+converting either way is a bit matrix transpose. 64 sets of up to 64 elements are a 64 x 64 matrix; narrower
+sets (8, 16 or 32 bits) are packed so that one word carries 64 / width rows, and the same swap stages turn
+the width words of 64 rows into width columns. the stages run in the dispatch transposeBits kernel, 8 blocks
+side by side, so a stage is one AVX-512 or two AVX2 instructions per pair of rows. sets wider than 64 are
+transposed one word at a time.
+
+a predicate is built from element(k), allOf(set), anyOf(set), constants and & | ^ ~, and compiled to a short
+postfix program. select() runs the program over chunks of columnWordsPerChunk words with one plain loop per
+step (which the compiler vectorizes), reading columns in place and keeping only intermediate results in
+scratch. a & ~b becomes one and-not step.
+
+*/
+
+#ifndef TINYBITSLICE_H
+#define TINYBITSLICE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tinybitset.h"
+
+
+namespace tinybit {
+
+	// words per column a predicate step handles at a time, so a handful of intermediate results stay in L1
+	constexpr size_t columnWordsPerChunk = 256;
+
+	// 64 set blocks per transposeBits call, 8 groups of 8
+	constexpr size_t sliceBlocksPerCall = 64;
+
+	// blocks of 64 sets each select thread gets at least. a predicate step takes 2.5 - 8ns a block
+	// (scripts/compareslice.cpp): 4096 blocks are 10 - 35us
+	constexpr size_t selectParallelMin = size_t(1) << 12;
+
+}
+
+
+
+class TinyBitPredicate {
+	public:
+		enum class Op : int { Element, Const, Not, And, Or, Xor, AndNot };
+
+		struct Step {
+			Op op;
+			int arg;   // the element for Element, 0 / 1 for Const
+		};
+
+		// true for every set, or for none
+		explicit TinyBitPredicate(bool value) : steps{Step{Op::Const, value ? 1 : 0}} {}
+
+		// sets containing k, k >= 1
+		static TinyBitPredicate element(int k);
+		// sets containing every element of s (true for s empty), or at least one (false for s empty)
+		template <int MaxElems, typename BoundsCheck>
+		static TinyBitPredicate allOf(TinyBitSet<MaxElems, BoundsCheck> const &s);
+		template <int MaxElems, typename BoundsCheck>
+		static TinyBitPredicate anyOf(TinyBitSet<MaxElems, BoundsCheck> const &s);
+
+		friend TinyBitPredicate operator~(TinyBitPredicate const &a);
+		friend TinyBitPredicate operator&(TinyBitPredicate const &a, TinyBitPredicate const &b);
+		friend TinyBitPredicate operator|(TinyBitPredicate const &a, TinyBitPredicate const &b);
+		friend TinyBitPredicate operator^(TinyBitPredicate const &a, TinyBitPredicate const &b);
+
+		// the postfix program and the largest element it reads
+		std::vector<Step> const &program() const { return this->steps; }
+		int maxElement() const;
+		// intermediate results the program needs at once
+		int depth() const;
+
+	private:
+		std::vector<Step> steps;
+
+		TinyBitPredicate() {}
+		static TinyBitPredicate combine(TinyBitPredicate const &a, TinyBitPredicate const &b, Op op);
+};
+
+
+
+inline TinyBitPredicate TinyBitPredicate::element(int k) {
+	if (k < 1) {
+		throw std::invalid_argument("TinyBitPredicate::element: elements start at 1, got " + std::to_string(k));
+	}
+	TinyBitPredicate p;
+	p.steps.push_back(Step{Op::Element, k});
+	return p;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitPredicate TinyBitPredicate::allOf(TinyBitSet<MaxElems, BoundsCheck> const &s) {
+	TinyBitPredicate p(true);
+	bool first = true;
+	for (int k : s) {
+		p = first ? element(k) : (p & element(k));
+		first = false;
+	}
+	return p;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+TinyBitPredicate TinyBitPredicate::anyOf(TinyBitSet<MaxElems, BoundsCheck> const &s) {
+	TinyBitPredicate p(false);
+	bool first = true;
+	for (int k : s) {
+		p = first ? element(k) : (p | element(k));
+		first = false;
+	}
+	return p;
+}
+
+
+inline TinyBitPredicate TinyBitPredicate::combine(TinyBitPredicate const &a, TinyBitPredicate const &b, Op op) {
+	TinyBitPredicate p;
+	p.steps.reserve(a.steps.size() + b.steps.size() + 1);
+	p.steps.insert(p.steps.end(), a.steps.begin(), a.steps.end());
+	p.steps.insert(p.steps.end(), b.steps.begin(), b.steps.end());
+	// a & ~b: the not folds into the and
+	if ((op == Op::And) && (p.steps.back().op == Op::Not)) {
+		p.steps.back() = Step{Op::AndNot, 0};
+	} else {
+		p.steps.push_back(Step{op, 0});
+	}
+	return p;
+}
+
+
+inline TinyBitPredicate operator~(TinyBitPredicate const &a) {
+	TinyBitPredicate p = a;
+	if (p.steps.back().op == TinyBitPredicate::Op::Not) {
+		p.steps.pop_back();
+	} else {
+		p.steps.push_back(TinyBitPredicate::Step{TinyBitPredicate::Op::Not, 0});
+	}
+	return p;
+}
+
+inline TinyBitPredicate operator&(TinyBitPredicate const &a, TinyBitPredicate const &b) {
+	return TinyBitPredicate::combine(a, b, TinyBitPredicate::Op::And);
+}
+
+inline TinyBitPredicate operator|(TinyBitPredicate const &a, TinyBitPredicate const &b) {
+	return TinyBitPredicate::combine(a, b, TinyBitPredicate::Op::Or);
+}
+
+inline TinyBitPredicate operator^(TinyBitPredicate const &a, TinyBitPredicate const &b) {
+	return TinyBitPredicate::combine(a, b, TinyBitPredicate::Op::Xor);
+}
+
+
+inline int TinyBitPredicate::maxElement() const {
+	int most = 0;
+	for (Step const &step : this->steps) {
+		if (step.op == Op::Element) {
+			most = std::max(most, step.arg);
+		}
+	}
+	return most;
+}
+
+
+inline int TinyBitPredicate::depth() const {
+	int height = 0;
+	int most = 0;
+	for (Step const &step : this->steps) {
+		if ((step.op == Op::Element) || (step.op == Op::Const)) {
+			height++;
+		} else if (step.op != Op::Not) {
+			height--;
+		}
+		most = std::max(most, height);
+	}
+	return most;
+}
+
+
+
+template <int MaxElems, typename BoundsCheck = TinyBitThrowCheck>
+class TinyBitSlices {
+	public:
+		using value_type = TinyBitSet<MaxElems, BoundsCheck>;
+		using RepType = TinyBitRepType<MaxElems>;
+
+		TinyBitSlices() {}
+		TinyBitSlices(value_type const *sets, size_t n) { this->assign(sets, n); }
+
+		// replace the contents with the sliced copy of n sets
+		void assign(value_type const *sets, size_t n);
+		// write the n sets back out, the inverse of assign
+		void unslice(value_type *out) const;
+		std::vector<value_type> toSets() const;
+
+		// number of sets, and words per column (64 sets each)
+		size_t size() const { return this->nsets; }
+		size_t blocks() const { return this->nblocks; }
+
+		// bit r % 64 of column(k)[r / 64] is set when set r contains k
+		uint64_t const *column(int k) const;
+
+		// the selection mask of the sets satisfying p, blocks() words, bits past size() clear
+		void select(uint64_t *mask, TinyBitPredicate const &p, int nthreads = 1) const;
+		std::vector<uint64_t> select(TinyBitPredicate const &p, int nthreads = 1) const;
+		// how many sets satisfy p
+		size_t count(TinyBitPredicate const &p, int nthreads = 1) const;
+
+	private:
+		// bits of a set transposed at a time, and the transposes per set
+		static constexpr int width = (sizeof(RepType) < 8) ? int(8 * sizeof(RepType)) : 64;
+		static constexpr size_t setWords = (sizeof(RepType) < 8) ? 1 : sizeof(RepType) / 8;
+
+		std::vector<uint64_t> columns;   // column k at [(k - 1) * nblocks]
+		size_t nsets = 0;
+		size_t nblocks = 0;
+
+		void selectRange(uint64_t *mask, TinyBitPredicate const &p, size_t begin, size_t end) const;
+};
+
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitSlices<MaxElems, BoundsCheck>::assign(value_type const *sets, size_t n) {
+	static_assert(sizeof(value_type) == sizeof(RepType), "TinyBitSlices needs TinyBitSet to be exactly its words");
+	this->nsets = n;
+	this->nblocks = (n + 63) / 64;
+	this->columns.assign(size_t(MaxElems) * this->nblocks, 0);
+
+	unsigned char const *bytes = reinterpret_cast<unsigned char const *>(sets);
+	constexpr size_t rowBytes = (sizeof(RepType) < 8) ? sizeof(RepType) : 8;
+	std::vector<uint64_t> scratch(tinybit::sliceBlocksPerCall * width);
+	for (size_t b0 = 0; b0 < this->nblocks; b0 += tinybit::sliceBlocksPerCall) {
+		size_t nb = std::min(tinybit::sliceBlocksPerCall, this->nblocks - b0);
+		size_t groups = (nb + 7) / 8;
+		for (size_t w = 0; w < setWords; w++) {
+			// row r of block b goes to lane r / width of word r % width, blocks of a group interleaved
+			std::fill(scratch.begin(), scratch.begin() + groups * 8 * width, 0);
+			for (size_t b = 0; b < nb; b++) {
+				uint64_t *group = scratch.data() + (b / 8) * 8 * width + (b % 8);
+				size_t first = (b0 + b) * 64;
+				size_t rows = std::min<size_t>(64, n - first);
+				for (size_t r = 0; r < rows; r++) {
+					uint64_t row = 0;
+					std::memcpy(&row, bytes + (first + r) * sizeof(RepType) + w * 8, rowBytes);
+					group[8 * (r % width)] |= row << ((r / width) * width);
+				}
+			}
+			tinybit::kernels().transposeBits(scratch.data(), groups, width);
+			for (size_t b = 0; b < nb; b++) {
+				uint64_t const *group = scratch.data() + (b / 8) * 8 * width + (b % 8);
+				for (int c = 0; (c < width) && (int(w) * 64 + c < MaxElems); c++) {
+					this->columns[(w * 64 + c) * this->nblocks + b0 + b] = group[8 * c];
+				}
+			}
+		}
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitSlices<MaxElems, BoundsCheck>::unslice(value_type *out) const {
+	unsigned char *bytes = reinterpret_cast<unsigned char *>(out);
+	constexpr size_t rowBytes = (sizeof(RepType) < 8) ? sizeof(RepType) : 8;
+	constexpr uint64_t rowMask = (width == 64) ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+	std::vector<uint64_t> scratch(tinybit::sliceBlocksPerCall * width);
+	for (size_t b0 = 0; b0 < this->nblocks; b0 += tinybit::sliceBlocksPerCall) {
+		size_t nb = std::min(tinybit::sliceBlocksPerCall, this->nblocks - b0);
+		size_t groups = (nb + 7) / 8;
+		for (size_t w = 0; w < setWords; w++) {
+			// the transpose is its own inverse: columns in, rows packed as assign packs them out
+			std::fill(scratch.begin(), scratch.begin() + groups * 8 * width, 0);
+			for (size_t b = 0; b < nb; b++) {
+				uint64_t *group = scratch.data() + (b / 8) * 8 * width + (b % 8);
+				for (int c = 0; (c < width) && (int(w) * 64 + c < MaxElems); c++) {
+					group[8 * c] = this->columns[(w * 64 + c) * this->nblocks + b0 + b];
+				}
+			}
+			tinybit::kernels().transposeBits(scratch.data(), groups, width);
+			for (size_t b = 0; b < nb; b++) {
+				uint64_t const *group = scratch.data() + (b / 8) * 8 * width + (b % 8);
+				size_t first = (b0 + b) * 64;
+				size_t rows = std::min<size_t>(64, this->nsets - first);
+				for (size_t r = 0; r < rows; r++) {
+					uint64_t row = (group[8 * (r % width)] >> ((r / width) * width)) & rowMask;
+					std::memcpy(bytes + (first + r) * sizeof(RepType) + w * 8, &row, rowBytes);
+				}
+			}
+		}
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<TinyBitSet<MaxElems, BoundsCheck>> TinyBitSlices<MaxElems, BoundsCheck>::toSets() const {
+	std::vector<value_type> out(this->nsets);
+	this->unslice(out.data());
+	return out;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+uint64_t const *TinyBitSlices<MaxElems, BoundsCheck>::column(int k) const {
+	if ((k < 1) || (k > MaxElems)) {
+		throw std::invalid_argument("TinyBitSlices::column: element " + std::to_string(k) + " is outside 1 .. "
+									+ std::to_string(MaxElems));
+	}
+	return this->columns.data() + size_t(k - 1) * this->nblocks;
+}
+
+
+// mask[begin .. end) for the words begin .. end of every column, a chunk at a time
+template <int MaxElems, typename BoundsCheck>
+void TinyBitSlices<MaxElems, BoundsCheck>::selectRange(uint64_t *mask, TinyBitPredicate const &p, size_t begin, size_t end) const {
+	using Op = TinyBitPredicate::Op;
+	constexpr size_t chunk = tinybit::columnWordsPerChunk;
+	std::vector<TinyBitPredicate::Step> const &steps = p.program();
+	int depth = p.depth();
+	// a stack entry points at a column in place, or at its own scratch
+	std::vector<uint64_t> scratch(size_t(depth) * chunk);
+	std::vector<uint64_t const *> stack(depth);
+	for (size_t w0 = begin; w0 < end; w0 += chunk) {
+		size_t len = std::min(chunk, end - w0);
+		int top = 0;
+		for (TinyBitPredicate::Step const &step : steps) {
+			uint64_t *own = scratch.data() + size_t(top) * chunk;
+			if (step.op == Op::Element) {
+				stack[top++] = this->columns.data() + size_t(step.arg - 1) * this->nblocks + w0;
+				continue;
+			}
+			if (step.op == Op::Const) {
+				std::fill(own, own + len, (step.arg != 0) ? ~uint64_t(0) : 0);
+				stack[top++] = own;
+				continue;
+			}
+			if (step.op == Op::Not) {
+				own -= chunk;
+				uint64_t const *a = stack[top - 1];
+				for (size_t i = 0; i < len; i++) {
+					own[i] = ~a[i];
+				}
+				stack[top - 1] = own;
+				continue;
+			}
+			own -= 2 * chunk;
+			uint64_t const *a = stack[top - 2];
+			uint64_t const *b = stack[top - 1];
+			switch (step.op) {
+				case Op::And:
+					for (size_t i = 0; i < len; i++) { own[i] = a[i] & b[i]; }
+					break;
+				case Op::Or:
+					for (size_t i = 0; i < len; i++) { own[i] = a[i] | b[i]; }
+					break;
+				case Op::Xor:
+					for (size_t i = 0; i < len; i++) { own[i] = a[i] ^ b[i]; }
+					break;
+				default:
+					for (size_t i = 0; i < len; i++) { own[i] = a[i] & ~b[i]; }
+					break;
+			}
+			stack[top - 2] = own;
+			top--;
+		}
+		std::memcpy(mask + w0, stack[0], len * sizeof(uint64_t));
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+void TinyBitSlices<MaxElems, BoundsCheck>::select(uint64_t *mask, TinyBitPredicate const &p, int nthreads) const {
+	if (p.maxElement() > MaxElems) {
+		throw std::invalid_argument("TinyBitSlices::select: the predicate reads element " + std::to_string(p.maxElement())
+									+ ", the sets hold 1 .. " + std::to_string(MaxElems));
+	}
+	size_t most = this->nblocks / tinybit::selectParallelMin;
+	if ((nthreads > 1) && (size_t(nthreads) > most)) {
+		nthreads = (most > 1) ? int(most) : 1;
+	}
+	tinybit::parallelRanges(nthreads, this->nblocks, [&](size_t begin, size_t end) { this->selectRange(mask, p, begin, end); });
+	// a not or a true constant sets the rows past the last set
+	if (this->nsets % 64 != 0) {
+		mask[this->nblocks - 1] &= (uint64_t(1) << (this->nsets % 64)) - 1;
+	}
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+std::vector<uint64_t> TinyBitSlices<MaxElems, BoundsCheck>::select(TinyBitPredicate const &p, int nthreads) const {
+	std::vector<uint64_t> mask(this->nblocks);
+	this->select(mask.data(), p, nthreads);
+	return mask;
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+size_t TinyBitSlices<MaxElems, BoundsCheck>::count(TinyBitPredicate const &p, int nthreads) const {
+	std::vector<uint64_t> mask = this->select(p, nthreads);
+	return size_t(tinybit::kernels().popcountWords(mask.data(), mask.size()));
+}
+
+
+#endif
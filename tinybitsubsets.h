@@ -0,0 +1,249 @@
+/*
+allocation-free subset enumeration over TinyBitSets of up to 64 elements,
+each generator is a range usable with range-for, yielding TinyBitSet values:
+
+	submasks(s)         every subset of s, in descending order of bit pattern (s first, empty set last)
+	supersets(s)        every superset of s within 1..MaxElems, ascending (s first, fill() last)
+	combinations<N>(k)  every k element subset of 1..N, in colex order (Gosper's hack)
+	splits(s)           every ordered pair (a, b) with a | b == s and a & b empty
+
+each step is the usual one or two line bit trick on the raw word, e.g. submasks is (x - 1) & s,
+so a loop over one of these compiles down to the hand written version.
+
+*/
+
+#ifndef TINYBITSUBSETS_H
+#define TINYBITSUBSETS_H
+
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+#include "tinybitset.h"
+
+
+// shared iterator shell, Step supplies first/next/last on the raw 64 bit word
+template <int MaxElems, typename BoundsCheck, typename Step>
+class TinyBitSubsetIterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = TinyBitSet<MaxElems, BoundsCheck>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = value_type const *;
+		using reference = value_type;
+
+		constexpr TinyBitSubsetIterator(Step step, uint64_t cur, bool done) : step(step), cur(cur), done(done) {}
+
+		constexpr TinyBitSet<MaxElems, BoundsCheck> operator*() const {
+			return TinyBitSet<MaxElems, BoundsCheck>(static_cast<TinyBitRepType<MaxElems>>(this->cur));
+		}
+
+		constexpr TinyBitSubsetIterator& operator++() {
+			if (this->step.isLast(this->cur)) {
+				this->done = true;
+			} else {
+				this->cur = this->step.next(this->cur);
+			}
+			return *this;
+		}
+
+		// only ever compared against end()
+		constexpr bool operator==(TinyBitSubsetIterator const &other) const {
+			return this->done == other.done;
+		}
+
+		constexpr bool operator!=(TinyBitSubsetIterator const &other) const {
+			return this->done != other.done;
+		}
+
+	private:
+		Step step;
+		uint64_t cur;
+		bool done;
+};
+
+
+template <int MaxElems, typename BoundsCheck, typename Step>
+class TinyBitSubsetRange {
+	static_assert(MaxElems <= 64, "subset enumeration works on single word TinyBitSets (MaxElems <= 64)");
+
+	public:
+		using iterator = TinyBitSubsetIterator<MaxElems, BoundsCheck, Step>;
+
+		constexpr TinyBitSubsetRange(Step step, uint64_t first, bool empty) : step(step), first(first), empty(empty) {}
+
+		constexpr iterator begin() const {
+			return iterator(this->step, this->first, this->empty);
+		}
+
+		constexpr iterator end() const {
+			return iterator(this->step, 0, true);
+		}
+
+	private:
+		Step step;
+		uint64_t first;
+		bool empty;
+};
+
+
+namespace tinybit {
+
+	struct SubmaskStep {
+		uint64_t mask;
+
+		constexpr bool isLast(uint64_t cur) const {
+			return cur == 0;
+		}
+
+		constexpr uint64_t next(uint64_t cur) const {
+			return (cur - 1) & this->mask;
+		}
+	};
+
+
+	struct SupersetStep {
+		uint64_t mask;
+		uint64_t full;
+
+		constexpr bool isLast(uint64_t cur) const {
+			return cur == this->full;
+		}
+
+		constexpr uint64_t next(uint64_t cur) const {
+			return (cur + 1) | this->mask;
+		}
+	};
+
+
+	struct CombinationStep {
+		uint64_t last;  // the k highest bits of the universe
+
+		constexpr bool isLast(uint64_t cur) const {
+			return cur == this->last;
+		}
+
+		// Gosper's hack, with the divide by the lowest bit done as a shift
+		constexpr uint64_t next(uint64_t cur) const {
+			uint64_t lowest = cur & (~cur + 1);
+			uint64_t ripple = cur + lowest;
+			return (((ripple ^ cur) >> 2) >> __builtin_ctzll(lowest)) | ripple;
+		}
+	};
+
+	constexpr uint64_t lowOnes(int nbits) {
+		return (nbits >= 64) ? ~uint64_t(0) : (uint64_t(1) << nbits) - 1;
+	}
+
+}
+
+
+
+// split iterator wraps submasks and pairs each a with s ^ a
+template <int MaxElems, typename BoundsCheck>
+class TinyBitSplitIterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = std::pair<TinyBitSet<MaxElems, BoundsCheck>, TinyBitSet<MaxElems, BoundsCheck>>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = value_type const *;
+		using reference = value_type;
+
+		constexpr TinyBitSplitIterator(uint64_t mask, uint64_t cur, bool done) : mask(mask), cur(cur), done(done) {}
+
+		constexpr value_type operator*() const {
+			return value_type(TinyBitSet<MaxElems, BoundsCheck>(static_cast<TinyBitRepType<MaxElems>>(this->cur)),
+							  TinyBitSet<MaxElems, BoundsCheck>(static_cast<TinyBitRepType<MaxElems>>(this->cur ^ this->mask)));
+		}
+
+		constexpr TinyBitSplitIterator& operator++() {
+			if (this->cur == 0) {
+				this->done = true;
+			} else {
+				this->cur = (this->cur - 1) & this->mask;
+			}
+			return *this;
+		}
+
+		constexpr bool operator==(TinyBitSplitIterator const &other) const {
+			return this->done == other.done;
+		}
+
+		constexpr bool operator!=(TinyBitSplitIterator const &other) const {
+			return this->done != other.done;
+		}
+
+	private:
+		uint64_t mask;
+		uint64_t cur;
+		bool done;
+};
+
+
+template <int MaxElems, typename BoundsCheck>
+class TinyBitSplitRange {
+	static_assert(MaxElems <= 64, "subset enumeration works on single word TinyBitSets (MaxElems <= 64)");
+
+	public:
+		using iterator = TinyBitSplitIterator<MaxElems, BoundsCheck>;
+
+		constexpr explicit TinyBitSplitRange(uint64_t mask) : mask(mask) {}
+
+		constexpr iterator begin() const {
+			return iterator(this->mask, this->mask, false);
+		}
+
+		constexpr iterator end() const {
+			return iterator(this->mask, 0, true);
+		}
+
+	private:
+		uint64_t mask;
+};
+
+
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSubsetRange<MaxElems, BoundsCheck, tinybit::SubmaskStep> submasks(TinyBitSet<MaxElems, BoundsCheck> const &set) {
+	/*
+	   all 2^|set| subsets of set, set itself first and the empty set last
+	*/
+	uint64_t mask = static_cast<uint64_t>(set.getBitInt());
+	return TinyBitSubsetRange<MaxElems, BoundsCheck, tinybit::SubmaskStep>(tinybit::SubmaskStep{mask}, mask, false);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSubsetRange<MaxElems, BoundsCheck, tinybit::SupersetStep> supersets(TinyBitSet<MaxElems, BoundsCheck> const &set) {
+	/*
+	   all 2^(MaxElems - |set|) supersets of set within 1..MaxElems, set itself first and the full set last
+	*/
+	uint64_t mask = static_cast<uint64_t>(set.getBitInt());
+	return TinyBitSubsetRange<MaxElems, BoundsCheck, tinybit::SupersetStep>(
+		tinybit::SupersetStep{mask, tinybit::lowOnes(MaxElems)}, mask, false);
+}
+
+
+template <int MaxElems, typename BoundsCheck = TinyBitThrowCheck>
+constexpr TinyBitSubsetRange<MaxElems, BoundsCheck, tinybit::CombinationStep> combinations(int k) {
+	/*
+	   all k element subsets of 1..MaxElems in colex order, {1..k} first and {MaxElems-k+1..MaxElems} last,
+	   empty if k < 0 or k > MaxElems
+	*/
+	bool empty = (k < 0) || (k > MaxElems);
+	uint64_t last = empty ? 0 : tinybit::lowOnes(MaxElems) & ~tinybit::lowOnes(MaxElems - k);
+	return TinyBitSubsetRange<MaxElems, BoundsCheck, tinybit::CombinationStep>(
+		tinybit::CombinationStep{last}, empty ? 0 : tinybit::lowOnes(k), empty);
+}
+
+
+template <int MaxElems, typename BoundsCheck>
+constexpr TinyBitSplitRange<MaxElems, BoundsCheck> splits(TinyBitSet<MaxElems, BoundsCheck> const &set) {
+	/*
+	   all 2^|set| ordered pairs (a, b) of disjoint sets with a | b == set, starting at (set, {}) and ending at ({}, set)
+	*/
+	return TinyBitSplitRange<MaxElems, BoundsCheck>(static_cast<uint64_t>(set.getBitInt()));
+}
+
+
+#endif
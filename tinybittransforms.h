@@ -0,0 +1,262 @@
+/*
+sum-over-subsets transforms for subset dynamic programs, over tables with one value per subset of 1..MaxElems
+(2^MaxElems entries, indexed by TinyBitSet or by getBitInt()).
+
+	subsetSumTransform(f)     f[S] <- sum of f[A] over A subset of S      (zeta)
+	subsetSumInverse(f)       undoes subsetSumTransform                  (mobius)
+	supersetSumTransform(f)   f[S] <- sum of f[A] over A superset of S
+	supersetSumInverse(f)     undoes supersetSumTransform
+	orConvolution(a, b)       c[S] = sum of a[A] * b[B] over A | B == S
+	andConvolution(a, b)      c[S] = sum of a[A] * b[B] over A & B == S
+
+each transform is n passes, pass i pairs every x without bit i with x | bit i. those pairs form contiguous
+runs of 2^i values, so each pass is an add (or subtract) of one run into another. for arithmetic types the runs
+go 32 bytes at a time as gcc vectors, and the passes are compiled for AVX2 and AVX-512 (64 bytes at a time)
+too and picked by the dispatch path, the way array expressions are, so a baseline x86-64 build still gets the
+wide adds on a cpu that has them. other types use a plain loop.
+
+the first passes (bits below tinybit::sosBlockBits) are done block by block, so each 2^sosBlockBits
+slice stays in L1 while all of its low bits are applied, only the higher bits stream over the whole table.
+with nthreads > 1 and a large enough table the blocks, and then the pairs of each high pass, are split
+across threads.
+
+*/
+
+#ifndef TINYBITTRANSFORMS_H
+#define TINYBITTRANSFORMS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "tinybitset.h"
+
+
+namespace tinybit {
+
+	// 4096 entries per block, 16-32KB for 4-8 byte values
+	constexpr int sosBlockBits = 12;
+
+	// a pass costs about 0.5ns an entry, so at 65536 entries each of the log2(size) - 11 thread splits of a
+	// transform (the blocks, then every high bit) has ~30us of work
+	constexpr size_t sosParallelMin = size_t(1) << 16;
+
+
+	// T as a gcc vector of Bytes bytes, for the arithmetic types that have one (lanes == 1 for the rest)
+	template <typename T, int Bytes, bool = std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && (sizeof(T) <= 8)>
+	struct SosVector {
+		static constexpr size_t lanes = 1;
+	};
+
+	template <typename T, int Bytes>
+	struct SosVector<T, Bytes, true> {
+		static constexpr size_t lanes = Bytes / sizeof(T);
+		typedef T type __attribute__((vector_size(Bytes)));
+	};
+
+
+	// dst[j] -= src[j] (Sub) or dst[j] += src[j] for j < n, Bytes at a time where T has a vector
+	template <typename T, int Bytes, bool Sub>
+	TINYBIT_ALWAYS_INLINE void sosRun(T *__restrict dst, T const *__restrict src, size_t n) {
+		size_t j = 0;
+		if constexpr (SosVector<T, Bytes>::lanes > 1) {
+			using V = typename SosVector<T, Bytes>::type;
+			for (; j + SosVector<T, Bytes>::lanes <= n; j += SosVector<T, Bytes>::lanes) {
+				V a;
+				V b;
+				std::memcpy(&a, dst + j, sizeof(V));
+				std::memcpy(&b, src + j, sizeof(V));
+				if constexpr (Sub) {
+					a -= b;
+				} else {
+					a += b;
+				}
+				std::memcpy(dst + j, &a, sizeof(V));
+			}
+		}
+		for (; j < n; j++) {
+			if constexpr (Sub) {
+				dst[j] -= src[j];
+			} else {
+				dst[j] += src[j];
+			}
+		}
+	}
+
+
+	// apply bit `bit` of one pass to pairs pbegin .. pend-1, pair p is x = p with a 0 bit inserted at `bit`
+	template <int Bytes, typename T>
+	TINYBIT_ALWAYS_INLINE void sosPairsBody(T *f, int bit, size_t pbegin, size_t pend, bool superset, bool inverse) {
+		size_t h = size_t(1) << bit;
+		size_t p = pbegin;
+		while (p < pend) {
+			size_t j = p & (h - 1);
+			size_t run = (h - j < pend - p) ? h - j : pend - p;
+			T *lo = f + (((p >> bit) << (bit + 1)) | j);
+			T *hi = lo + h;
+			T *dst = superset ? lo : hi;
+			T const *src = superset ? hi : lo;
+			if (inverse) {
+				sosRun<T, Bytes, true>(dst, src, run);
+			} else {
+				sosRun<T, Bytes, false>(dst, src, run);
+			}
+			p += run;
+		}
+	}
+
+#if defined(TINYBIT_DISPATCH)
+	template <typename T>
+	TINYBIT_TARGET("avx2") void sosPairsAVX2(T *f, int bit, size_t pbegin, size_t pend, bool superset, bool inverse) {
+		sosPairsBody<32>(f, bit, pbegin, pend, superset, inverse);
+	}
+
+	template <typename T>
+	TINYBIT_TARGET("avx512f") void sosPairsAVX512(T *f, int bit, size_t pbegin, size_t pend, bool superset, bool inverse) {
+		sosPairsBody<64>(f, bit, pbegin, pend, superset, inverse);
+	}
+#endif
+
+	template <typename T>
+	void sosPairs(T *f, int bit, size_t pbegin, size_t pend, bool superset, bool inverse) {
+#if defined(TINYBIT_DISPATCH)
+		TinyBitPath path = kernels().path;
+		if (path == TinyBitPath::AVX512) {
+			sosPairsAVX512(f, bit, pbegin, pend, superset, inverse);
+			return;
+		}
+		if (path == TinyBitPath::AVX2) {
+			sosPairsAVX2(f, bit, pbegin, pend, superset, inverse);
+			return;
+		}
+#endif
+		sosPairsBody<32>(f, bit, pbegin, pend, superset, inverse);
+	}
+
+
+	template <typename T>
+	void sosTransform(T *f, int nbits, bool superset, bool inverse, int nthreads) {
+		size_t size = size_t(1) << nbits;
+		if (size < sosParallelMin) {
+			nthreads = 1;
+		}
+
+		// low bits, one L1 sized block at a time
+		int lowbits = (nbits < sosBlockBits) ? nbits : sosBlockBits;
+		size_t blocksize = size_t(1) << lowbits;
+		parallelRanges(nthreads, size / blocksize, [=](size_t bbegin, size_t bend) {
+			for (size_t b = bbegin; b < bend; b++) {
+				for (int bit = 0; bit < lowbits; bit++) {
+					sosPairs(f + b * blocksize, bit, 0, blocksize / 2, superset, inverse);
+				}
+			}
+		});
+
+		// high bits, one streaming pass each
+		for (int bit = lowbits; bit < nbits; bit++) {
+			parallelRanges(nthreads, size / 2, [=](size_t pbegin, size_t pend) {
+				sosPairs(f, bit, pbegin, pend, superset, inverse);
+			});
+		}
+	}
+
+}
+
+
+
+// one T per subset of 1..MaxElems, indexed by TinyBitSet or by the raw bit pattern
+template <int MaxElems, typename T>
+class TinySubsetTable {
+	static_assert(MaxElems <= 30, "TinySubsetTable holds 2^MaxElems values, MaxElems must be <= 30");
+
+	public:
+		TinySubsetTable() : values(size_t(1) << MaxElems, T()) {}
+		explicit TinySubsetTable(T const &init) : values(size_t(1) << MaxElems, init) {}
+
+		template <typename BoundsCheck>
+		T& operator[](TinyBitSet<MaxElems, BoundsCheck> const &set) {
+			return this->values[static_cast<size_t>(set.getBitInt())];
+		}
+
+		template <typename BoundsCheck>
+		T const& operator[](TinyBitSet<MaxElems, BoundsCheck> const &set) const {
+			return this->values[static_cast<size_t>(set.getBitInt())];
+		}
+
+		T& operator[](size_t bits) {
+			return this->values[bits];
+		}
+
+		T const& operator[](size_t bits) const {
+			return this->values[bits];
+		}
+
+		T *data() {
+			return this->values.data();
+		}
+
+		T const *data() const {
+			return this->values.data();
+		}
+
+		size_t size() const {
+			return this->values.size();
+		}
+
+	private:
+		std::vector<T> values;
+};
+
+
+
+template <int MaxElems, typename T>
+void subsetSumTransform(TinySubsetTable<MaxElems, T> &f, int nthreads = 1) {
+	tinybit::sosTransform(f.data(), MaxElems, false, false, nthreads);
+}
+
+template <int MaxElems, typename T>
+void subsetSumInverse(TinySubsetTable<MaxElems, T> &f, int nthreads = 1) {
+	tinybit::sosTransform(f.data(), MaxElems, false, true, nthreads);
+}
+
+template <int MaxElems, typename T>
+void supersetSumTransform(TinySubsetTable<MaxElems, T> &f, int nthreads = 1) {
+	tinybit::sosTransform(f.data(), MaxElems, true, false, nthreads);
+}
+
+template <int MaxElems, typename T>
+void supersetSumInverse(TinySubsetTable<MaxElems, T> &f, int nthreads = 1) {
+	tinybit::sosTransform(f.data(), MaxElems, true, true, nthreads);
+}
+
+
+template <int MaxElems, typename T>
+TinySubsetTable<MaxElems, T> orConvolution(TinySubsetTable<MaxElems, T> a, TinySubsetTable<MaxElems, T> b, int nthreads = 1) {
+	/*
+	   zeta both sides, multiply pointwise, mobius back
+	*/
+	subsetSumTransform(a, nthreads);
+	subsetSumTransform(b, nthreads);
+	for (size_t i = 0; i < a.size(); i++) {
+		a[i] *= b[i];
+	}
+	subsetSumInverse(a, nthreads);
+	return a;
+}
+
+
+template <int MaxElems, typename T>
+TinySubsetTable<MaxElems, T> andConvolution(TinySubsetTable<MaxElems, T> a, TinySubsetTable<MaxElems, T> b, int nthreads = 1) {
+	supersetSumTransform(a, nthreads);
+	supersetSumTransform(b, nthreads);
+	for (size_t i = 0; i < a.size(); i++) {
+		a[i] *= b[i];
+	}
+	supersetSumInverse(a, nthreads);
+	return a;
+}
+
+
+#endif
@@ -0,0 +1,270 @@
+/*
+multi-word bit representation used by TinyBitSet when MaxElems > 64.
+
+word k holds the integers 64k+1 .. 64k+64, so integer n -> bit (n-1) % 64 of word (n-1) / 64,
+the same layout std::bitset and the single word TinyBitSets use.
+
+the set-wise operations and the popcount behind getSetSize() are written as loops over the words,
+using AVX2 (4 words at a time) or SSE2 (2 words at a time) when the compiler is targeting them,
+and a plain scalar loop everywhere else. a build without popcnt / BMI2 still gets them at run time
+through tinybitdispatch.h where the cpu has them. inside a constant expression only the scalar loop runs,
+so wide TinyBitSets can be built constexpr too.
+
+*/
+
+#ifndef TINYBITWORDS_H
+#define TINYBITWORDS_H
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "tinybitdispatch.h"
+
+
+// true while being evaluated as a constant expression, where the intrinsics can't run
+#if defined(__cpp_lib_is_constant_evaluated)
+#define TINYBIT_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__GNUC__) && (__GNUC__ >= 9 || defined(__clang__))
+#define TINYBIT_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define TINYBIT_CONSTANT_EVALUATED() false
+#endif
+
+
+namespace tinybit {
+
+	// widest vector the word count divides into, so sizeof(TinyBitWords<N>) stays 8 * N
+	constexpr int wordAlignment(int nwords) {
+		return (nwords % 4 == 0) ? 32 : (nwords % 2 == 0) ? 16 : 8;
+	}
+
+
+	constexpr void orWords(uint64_t *out, uint64_t const *a, uint64_t const *b, int n) {
+		int i = 0;
+		if (!TINYBIT_CONSTANT_EVALUATED()) {
+#if defined(__AVX2__)
+			for (; i + 4 <= n; i += 4) {
+				__m256i va = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+				__m256i vb = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_or_si256(va, vb));
+			}
+#endif
+#if defined(__SSE2__)
+			for (; i + 2 <= n; i += 2) {
+				__m128i va = _mm_loadu_si128(reinterpret_cast<__m128i const *>(a + i));
+				__m128i vb = _mm_loadu_si128(reinterpret_cast<__m128i const *>(b + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_or_si128(va, vb));
+			}
+#endif
+		}
+		for (; i < n; i++) {
+			out[i] = a[i] | b[i];
+		}
+	}
+
+
+	constexpr void andWords(uint64_t *out, uint64_t const *a, uint64_t const *b, int n) {
+		int i = 0;
+		if (!TINYBIT_CONSTANT_EVALUATED()) {
+#if defined(__AVX2__)
+			for (; i + 4 <= n; i += 4) {
+				__m256i va = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+				__m256i vb = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_and_si256(va, vb));
+			}
+#endif
+#if defined(__SSE2__)
+			for (; i + 2 <= n; i += 2) {
+				__m128i va = _mm_loadu_si128(reinterpret_cast<__m128i const *>(a + i));
+				__m128i vb = _mm_loadu_si128(reinterpret_cast<__m128i const *>(b + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_and_si128(va, vb));
+			}
+#endif
+		}
+		for (; i < n; i++) {
+			out[i] = a[i] & b[i];
+		}
+	}
+
+
+	constexpr void xorWords(uint64_t *out, uint64_t const *a, uint64_t const *b, int n) {
+		int i = 0;
+		if (!TINYBIT_CONSTANT_EVALUATED()) {
+#if defined(__AVX2__)
+			for (; i + 4 <= n; i += 4) {
+				__m256i va = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+				__m256i vb = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_xor_si256(va, vb));
+			}
+#endif
+#if defined(__SSE2__)
+			for (; i + 2 <= n; i += 2) {
+				__m128i va = _mm_loadu_si128(reinterpret_cast<__m128i const *>(a + i));
+				__m128i vb = _mm_loadu_si128(reinterpret_cast<__m128i const *>(b + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_xor_si128(va, vb));
+			}
+#endif
+		}
+		for (; i < n; i++) {
+			out[i] = a[i] ^ b[i];
+		}
+	}
+
+
+	constexpr void notWords(uint64_t *out, uint64_t const *a, int n) {
+		for (int i = 0; i < n; i++) {
+			out[i] = ~a[i];
+		}
+	}
+
+
+	constexpr int popcountWords(uint64_t const *a, int n) {
+		int i = 0;
+		int total = 0;
+#if defined(__AVX2__)
+		if (!TINYBIT_CONSTANT_EVALUATED()) {
+			__m256i acc = _mm256_setzero_si256();
+			for (; i + 4 <= n; i += 4) {
+				acc = _mm256_add_epi64(acc, popcount256(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i))));
+			}
+			total += static_cast<int>(_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1)
+									+ _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+		}
+#elif defined(TINYBIT_DISPATCH) && !defined(__POPCNT__)
+		// built without popcnt, let the cpu dispatch find it
+		if (!TINYBIT_CONSTANT_EVALUATED()) {
+			return static_cast<int>(kernels().popcountWords(a, size_t(n)));
+		}
+#endif
+		for (; i < n; i++) {
+			total += __builtin_popcountll(a[i]);
+		}
+		return total;
+	}
+
+
+	// 0 based position of the k-th (0 based) set bit of x, x must have more than k bits set.
+	// one pdep with BMI2 (at compile time, or found by the cpu dispatch), otherwise drop the k lowest bits first
+	constexpr int selectWord(uint64_t x, int k) {
+#if defined(__BMI2__)
+		if (!TINYBIT_CONSTANT_EVALUATED()) {
+			return __builtin_ctzll(_pdep_u64(uint64_t(1) << k, x));
+		}
+#elif defined(TINYBIT_DISPATCH)
+		if (!TINYBIT_CONSTANT_EVALUATED() && kernels().fastPdep) {
+			return __builtin_ctzll(kernels().pdep(uint64_t(1) << k, x));
+		}
+#endif
+		for (int j = 0; j < k; j++) {
+			x &= x - 1;
+		}
+		return __builtin_ctzll(x);
+	}
+
+
+	// the bits of src under mask packed into the low bits (pext), and the low bits of src spread over mask (pdep).
+	// BMI2 when the build or the cpu dispatch has a fast one, one step per bit of mask otherwise
+	constexpr uint64_t pextWord(uint64_t src, uint64_t mask) {
+#if defined(__BMI2__)
+		if (!TINYBIT_CONSTANT_EVALUATED()) {
+			return _pext_u64(src, mask);
+		}
+#elif defined(TINYBIT_DISPATCH)
+		if (!TINYBIT_CONSTANT_EVALUATED() && kernels().fastPdep) {
+			return kernels().pext(src, mask);
+		}
+#endif
+		return pextSoftware(src, mask);
+	}
+
+	constexpr uint64_t pdepWord(uint64_t src, uint64_t mask) {
+#if defined(__BMI2__)
+		if (!TINYBIT_CONSTANT_EVALUATED()) {
+			return _pdep_u64(src, mask);
+		}
+#elif defined(TINYBIT_DISPATCH)
+		if (!TINYBIT_CONSTANT_EVALUATED() && kernels().fastPdep) {
+			return kernels().pdep(src, mask);
+		}
+#endif
+		return pdepSoftware(src, mask);
+	}
+
+
+	// murmur3's 64 bit finalizer, every input bit reaches every output bit, so the
+	// low entropy patterns of small sets (a few low bits set) still hash well
+	constexpr uint64_t mix64(uint64_t x) {
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdULL;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ULL;
+		x ^= x >> 33;
+		return x;
+	}
+
+
+	constexpr bool equalWords(uint64_t const *a, uint64_t const *b, int n) {
+		uint64_t diff = 0;
+		for (int i = 0; i < n; i++) {
+			diff |= a[i] ^ b[i];
+		}
+		return diff == 0;
+	}
+
+}
+
+
+
+template <int NWords>
+struct alignas(tinybit::wordAlignment(NWords)) TinyBitWords {
+	uint64_t words[NWords];
+
+	constexpr TinyBitWords<NWords> operator|(TinyBitWords<NWords> const &other) const {
+		TinyBitWords<NWords> out = TinyBitWords<NWords>();
+		tinybit::orWords(out.words, this->words, other.words, NWords);
+		return out;
+	}
+
+	constexpr TinyBitWords<NWords> operator&(TinyBitWords<NWords> const &other) const {
+		TinyBitWords<NWords> out = TinyBitWords<NWords>();
+		tinybit::andWords(out.words, this->words, other.words, NWords);
+		return out;
+	}
+
+	constexpr TinyBitWords<NWords> operator^(TinyBitWords<NWords> const &other) const {
+		TinyBitWords<NWords> out = TinyBitWords<NWords>();
+		tinybit::xorWords(out.words, this->words, other.words, NWords);
+		return out;
+	}
+
+	constexpr TinyBitWords<NWords> operator~() const {
+		TinyBitWords<NWords> out = TinyBitWords<NWords>();
+		tinybit::notWords(out.words, this->words, NWords);
+		return out;
+	}
+
+	constexpr TinyBitWords<NWords>& operator|=(TinyBitWords<NWords> const &other) {
+		tinybit::orWords(this->words, this->words, other.words, NWords);
+		return *this;
+	}
+
+	constexpr TinyBitWords<NWords>& operator&=(TinyBitWords<NWords> const &other) {
+		tinybit::andWords(this->words, this->words, other.words, NWords);
+		return *this;
+	}
+
+	constexpr bool operator==(TinyBitWords<NWords> const &other) const {
+		return tinybit::equalWords(this->words, other.words, NWords);
+	}
+
+	constexpr bool operator!=(TinyBitWords<NWords> const &other) const {
+		return !tinybit::equalWords(this->words, other.words, NWords);
+	}
+};
+
+
+#endif